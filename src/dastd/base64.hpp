@@ -130,6 +130,41 @@ inline void base64_encode(std::istream& in, std::ostream& out)
 	}
 }
 
+/// @brief Return the number of characters produced encoding base-64 `length` bytes
+inline constexpr size_t base64_encoded_length(size_t length) {return (length+2)/3*4;}
+
+/// @brief Encodes base-64 a block of binary data in a buffer
+/// using the rfc4648 section 4 standard character set.
+///
+/// @param data Binary data
+/// @param length Length of the binary data
+/// @param out Target buffer of at least `base64_encoded_length(length)` characters
+/// @return Returns the number of characters written
+inline size_t base64_encode(const void* data, size_t length, char* out)
+{
+	const uint8_t* in = (const uint8_t*)data;
+	char* p = out;
+	size_t i = 0;
+	for (; i+3<=length; i+=3) {
+		uint32_t word = (((uint32_t)in[i]) << 16) | (((uint32_t)in[i+1]) << 8) | ((uint32_t)in[i+2]);
+		p[0] = base64_enc_chars[(word >> 18) & 0x3F];
+		p[1] = base64_enc_chars[(word >> 12) & 0x3F];
+		p[2] = base64_enc_chars[(word >> 6) & 0x3F];
+		p[3] = base64_enc_chars[word & 0x3F];
+		p += 4;
+	}
+	if (i < length) {
+		uint32_t word = ((uint32_t)in[i]) << 16;
+		if (i+1 < length) word |= ((uint32_t)in[i+1]) << 8;
+		p[0] = base64_enc_chars[(word >> 18) & 0x3F];
+		p[1] = base64_enc_chars[(word >> 12) & 0x3F];
+		p[2] = (i+1 < length ? base64_enc_chars[(word >> 6) & 0x3F] : '=');
+		p[3] = '=';
+		p += 4;
+	}
+	return (size_t)(p - out);
+}
+
 /// @brief Given a binary input stream "in", decodes base-64 in the output stream
 /// using the rfc4648 section 4 standard character set.
 ///
@@ -0,0 +1,142 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "defs.hpp"
+#include "exception.hpp"
+
+#ifdef DASTD_UNIX
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace dastd {
+
+/// @brief Exception thrown by the POSIX file-descriptor based classes
+DASTD_DEF_EXCEPTION(exception_fd)
+
+/// @brief Default size of the buffers used by `source_fd` and `sink_fd`
+constexpr size_t FD_IO_DEFAULT_BUFFER_SIZE = 1024*1024;
+
+/// @brief Alignment of the buffers used by `source_fd` and `sink_fd`
+constexpr size_t FD_IO_BUFFER_ALIGNMENT = 4096;
+
+/// @brief Page-aligned memory buffer used for file-descriptor I/O
+class fd_io_buffer {
+	private:
+		/// @brief Allocated memory
+		char* m_data = nullptr;
+
+		/// @brief Allocated size
+		size_t m_size = 0;
+
+	public:
+		/// @brief Constructor
+		/// @param size Size of the buffer; it is rounded up to `FD_IO_BUFFER_ALIGNMENT`
+		/// @throw Throws `std::bad_alloc` if the memory can not be allocated
+		fd_io_buffer(size_t size);
+
+		/// @brief Destructor
+		~fd_io_buffer() {free(m_data);}
+
+		/// @brief Copy not allowed
+		fd_io_buffer(const fd_io_buffer&) = delete;
+
+		/// @brief Copy not allowed
+		fd_io_buffer& operator=(const fd_io_buffer&) = delete;
+
+		/// @brief Pointer to the buffer
+		char* data() const {return m_data;}
+
+		/// @brief Size of the buffer
+		size_t size() const {return m_size;}
+};
+
+/// @brief Open a file for reading
+/// @param filename Name of the file
+/// @return Returns the file descriptor
+/// @throw Throws `exception_fd` in case of failure
+inline int fd_open_read(const std::string& filename)
+{
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) DASTD_THROW(exception_fd, "Unable to open file '" << filename << "' for reading; errno=" << errno);
+	return fd;
+}
+
+/// @brief Create (or truncate) a file for writing
+/// @param filename Name of the file
+/// @return Returns the file descriptor
+/// @throw Throws `exception_fd` in case of failure
+inline int fd_open_write(const std::string& filename)
+{
+	int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) DASTD_THROW(exception_fd, "Unable to open file '" << filename << "' for writing; errno=" << errno);
+	return fd;
+}
+
+/// @brief Read from a file descriptor retrying on interruption
+/// @param fd     File descriptor
+/// @param data   Target buffer
+/// @param length Max number of bytes to be read
+/// @return Returns the number of bytes read; zero means end of file
+/// @throw Throws `exception_fd` in case of failure
+inline size_t fd_read(int fd, void* data, size_t length)
+{
+	for(;;) {
+		ssize_t ret = ::read(fd, data, length);
+		if (ret >= 0) return (size_t)ret;
+		if (errno != EINTR) DASTD_THROW(exception_fd, "Failed reading " << length << " bytes from file descriptor " << fd << "; errno=" << errno);
+	}
+}
+
+/// @brief Write the whole data to a file descriptor
+/// @param fd     File descriptor
+/// @param data   Data to be written
+/// @param length Number of bytes to be written
+/// @throw Throws `exception_fd` in case of failure
+inline void fd_write_all(int fd, const void* data, size_t length)
+{
+	const char* ptr = (const char*)data;
+	while (length > 0) {
+		ssize_t ret = ::write(fd, ptr, length);
+		if (ret < 0) {
+			if (errno == EINTR) continue;
+			DASTD_THROW(exception_fd, "Failed writing " << length << " bytes to file descriptor " << fd << "; errno=" << errno);
+		}
+		ptr += ret;
+		length -= (size_t)ret;
+	}
+}
+
+/// @brief Inform the kernel that the file will be accessed sequentially
+///
+/// It is only a hint: it is silently ignored where not supported
+/// (for example on pipes or on systems without `posix_fadvise`).
+inline void fd_advise_sequential(int fd)
+{
+	#ifdef POSIX_FADV_SEQUENTIAL
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	#else
+	DASTD_NOWARN_UNUSED(fd);
+	#endif
+}
+
+//------------------------------------------------------------------------------
+// (brief) Constructor
+// (param) size Size of the buffer; it is rounded up to `FD_IO_BUFFER_ALIGNMENT`
+//------------------------------------------------------------------------------
+inline fd_io_buffer::fd_io_buffer(size_t size)
+{
+	if (size == 0) size = 1;
+	m_size = (size + FD_IO_BUFFER_ALIGNMENT - 1) & ~(FD_IO_BUFFER_ALIGNMENT - 1);
+	void* ptr;
+	if (::posix_memalign(&ptr, FD_IO_BUFFER_ALIGNMENT, m_size) != 0) throw std::bad_alloc();
+	m_data = (char*)ptr;
+}
+
+} // namespace dastd
+
+#endif // DASTD_UNIX
@@ -36,8 +36,10 @@
 #pragma once
 #include "defs.hpp"
 #include <cassert>
+#include <charconv>
 #include <cmath>
 #include <cstdio>
+#include <ostream>
 #include <type_traits>
 
 namespace dastd {
@@ -203,4 +205,34 @@ inline uint32_t pack_f32(float x) { return pack_float(x); }
 inline uint64_t pack_f64(double x) { return pack_float(x); }
 inline float unpack_f32(uint32_t x) { return unpack_float(x); }
 inline double unpack_f64(uint64_t x) { return unpack_float(x); }
+
+/// @brief Maximum number of characters written by `write_double`
+inline constexpr size_t WRITE_DOUBLE_MAX_LENGTH = 32;
+
+/// @brief Write a double with the shortest text that reads back as the same value
+///
+/// The text does not depend on the locale: for example `0.1`, `100`, `1e+300`
+/// or `-2.5e-07`. Infinites and NaN are written as `inf`, `-inf` and `nan`.
+///
+/// @param buffer Buffer of at least `WRITE_DOUBLE_MAX_LENGTH` characters
+/// @param value  Value to be written
+/// @return Returns the number of characters written (with no zero terminator)
+inline size_t write_double(char* buffer, double value)
+{
+	std::to_chars_result res = std::to_chars(buffer, buffer+WRITE_DOUBLE_MAX_LENGTH, value);
+	assert(res.ec == std::errc());
+	return (size_t)(res.ptr - buffer);
+}
+
+/// @brief Write a double on a stream with the shortest text that reads back as the same value
+///
+/// See `write_double(char*, double)`.
+///
+/// @param o     Target stream
+/// @param value Value to be written
+inline void write_double(std::ostream& o, double value)
+{
+	char buffer[WRITE_DOUBLE_MAX_LENGTH];
+	o.write(buffer, (std::streamsize)write_double(buffer, value));
+}
 } // namespace dastd
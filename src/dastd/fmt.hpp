@@ -13,27 +13,151 @@
 #include "defs.hpp"
 #include "fmt32.hpp"
 #include "string_tools.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstring>
 #include <ostream>
 #include <sstream>
+#include <string_view>
 namespace dastd {
 
 class char32string;
 class flooder_ch32;
 
 
+/// @brief Digits used by the integer formatters, up to base 36
+inline constexpr char fmt_digits_uc[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/// @brief Lower case digits used by the integer formatters, up to base 36
+inline constexpr char fmt_digits_lc[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+/// @brief Pairs of decimal digits from "00" to "99"
+inline constexpr char fmt_digit_pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/// @brief Maximum number of characters written by `fmt_integral`: the binary digits and the sign
+template<class NUMTYPE>
+inline constexpr size_t FMT_INTEGRAL_MAX_LENGTH = sizeof(NUMTYPE)*8+1;
+
+/// @brief Return the number of decimal digits of an unsigned number
+template<std::unsigned_integral UTYPE>
+inline size_t fmt_count_decimal_digits(UTYPE value)
+{
+	size_t count = 1;
+	for(;;) {
+		if (value < 10) return count;
+		if (value < 100) return count+1;
+		if (value < 1000) return count+2;
+		if (value < 10000) return count+3;
+		value /= 10000;
+		count += 4;
+	}
+}
+
+/// @brief Write an unsigned number in base 10, two digits at a time
+/// @param buffer Target buffer; it is not NUL-terminated
+/// @param value Value to be written
+/// @return Returns the number of characters written
+template<std::unsigned_integral UTYPE>
+inline size_t fmt_decimal(char* buffer, UTYPE value)
+{
+	size_t len = fmt_count_decimal_digits(value);
+	char* p = buffer + len;
+	while (value >= 100) {
+		size_t pair = (size_t)(value % 100) * 2;
+		value /= 100;
+		p -= 2;
+		p[0] = fmt_digit_pairs[pair];
+		p[1] = fmt_digit_pairs[pair+1];
+	}
+	if (value >= 10) {
+		p -= 2;
+		p[0] = fmt_digit_pairs[value*2];
+		p[1] = fmt_digit_pairs[value*2+1];
+	}
+	else {
+		p[-1] = (char)('0' + value);
+	}
+	return len;
+}
+
+/// @brief Write an unsigned number in any base from 2 to 36
+///
+/// Base 10 uses `fmt_decimal`; bases 2, 4, 8, 16 and 32 extract the digits with shifts and masks.
+///
+/// @param buffer Target buffer; it is not NUL-terminated
+/// @param value Value to be written
+/// @param base Formatting base
+/// @param digits Set of digits, `fmt_digits_uc` or `fmt_digits_lc`
+/// @return Returns the number of characters written
+template<std::unsigned_integral UTYPE>
+inline size_t fmt_unsigned(char* buffer, UTYPE value, unsigned base, const char* digits=fmt_digits_uc)
+{
+	assert((base >= 2) && (base <= 36));
+	if (base == 10) return fmt_decimal(buffer, value);
+
+	if (std::has_single_bit(base)) {
+		int shift = std::countr_zero(base);
+		size_t len = ((size_t)std::max(1, (int)std::bit_width(value)) + (size_t)shift - 1) / (size_t)shift;
+		char* p = buffer + len;
+		do {
+			*--p = digits[value & (base-1)];
+			value >>= shift;
+		} while (value != 0);
+		return len;
+	}
+
+	// Other bases: digits generated backwards
+	char temp[sizeof(UTYPE)*8];
+	char* end = temp + sizeof(temp);
+	char* p = end;
+	do {
+		*--p = digits[value % base];
+		value /= base;
+	} while (value != 0);
+	memcpy(buffer, p, (size_t)(end - p));
+	return (size_t)(end - p);
+}
+
+/// @brief Write an integral number in any base from 2 to 36
+///
+/// Negative numbers are written with the sign in front.
+///
+/// @param buffer Target buffer of at least `FMT_INTEGRAL_MAX_LENGTH<NUMTYPE>` characters; it is not NUL-terminated
+/// @param value Value to be written
+/// @param base Formatting base; valid values range from 2 to 36
+/// @param lower_case Set to 'true' to have the letters 'a...z' written in lower case
+/// @return Returns the number of characters written
+template<std::integral NUMTYPE>
+inline size_t fmt_integral(char* buffer, NUMTYPE value, unsigned base=10, bool lower_case=false)
+{
+	using UTYPE = std::make_unsigned_t<NUMTYPE>;
+	const char* digits = (lower_case ? fmt_digits_lc : fmt_digits_uc);
+	if constexpr (std::is_signed_v<NUMTYPE>) {
+		if (value < 0) {
+			buffer[0] = '-';
+			return 1 + fmt_unsigned(buffer+1, (UTYPE)((UTYPE)0 - (UTYPE)value), base, digits);
+		}
+	}
+	return fmt_unsigned(buffer, (UTYPE)value, base, digits);
+}
+
 /// @brief Helper class that allows formatting a number while printing on a stream
 ///
 /// The `fmt` helper class can be embedded in a stream << sequence:
 ///
 ///     o << "Value 0x" << fmt(number, 16, 4) << std::endl;
 ///
+/// The number can be also written in a buffer with `write`.
 template<class NUMTYPE>
 class fmt {
 	static_assert(std::is_integral<NUMTYPE>::value, "Integral required");
 	static constexpr size_t buf_size = 66;
-	inline static const char* conv_set_uc = "0123456789ABCDEFGHIJKLMNOPQRSTUVXYZ";
-	inline static const char* conv_set_lc = "0123456789abcdefghijklmnopqrstuvxyz";
 	public:
+		/// @brief Maximum number of characters written by `write`
+		static constexpr size_t MAX_LENGTH = buf_size;
+
 		/// @brief Constructor
 		///
 		/// @param value Value to be formatted
@@ -42,19 +166,27 @@ class fmt {
 		/// @param lower_case Set to 'true' to have the letters 'a...z' written in lower case
 		///     instead of the default upper case.
 		fmt(NUMTYPE value, std::make_unsigned_t<NUMTYPE> base=10, int zero_pad=0, bool lower_case=false):
-			m_value(value), m_base(base), m_zero_pad(zero_pad), m_conv_set(lower_case ? conv_set_lc : conv_set_uc)
+			m_value(value), m_base(base), m_zero_pad(zero_pad), m_conv_set(lower_case ? fmt_digits_lc : fmt_digits_uc)
 			{
 				assert((base >= 2) && (base < 36));
 				assert((zero_pad < 0) ? ((size_t)(-zero_pad)) < buf_size : ((size_t)(zero_pad)) < buf_size);
 			}
 
+		/// @brief Write the formatted value in a buffer
+		///
+		/// @param buffer Target buffer of at least `MAX_LENGTH` characters; it is not NUL-terminated
+		/// @return Returns the number of characters written
+		size_t write(char* buffer) const;
+
 		/// @brief Print the formatted value on a ostream
 		///
+		/// The stream width, fill and adjustment are honoured.
+		///
 		/// @param o Target stream
-		void print(std::ostream& o) const;
+		void print(std::ostream& o) const {char buf[buf_size]; o << std::string_view(buf, write(buf));}
 
 		/// @brief Return in string form
-		std::string str() const {std::ostringstream s; print(s); return s.str();}
+		std::string str() const {char buf[buf_size]; return std::string(buf, write(buf));}
 
 	private:
 		NUMTYPE m_value;
@@ -63,72 +195,50 @@ class fmt {
 		const char* m_conv_set;
 };
 
-/// Print the formatted value on a ostream
+/// Write the formatted value in a buffer
 template<class NUMTYPE>
-void fmt<NUMTYPE>::print(std::ostream& o) const
+size_t fmt<NUMTYPE>::write(char* buffer) const
 {
-	char buf[buf_size];
-	char* buf_start = buf;
-
-	// Always unsigned number
-	std::make_unsigned_t<NUMTYPE> num;
+	using UTYPE = std::make_unsigned_t<NUMTYPE>;
+	char* p = buffer;
 
 	// Calculate the zero_pad information
-	unsigned zero_pad;
+	size_t zero_pad = (size_t)(m_zero_pad < 0 ? -m_zero_pad : m_zero_pad);
 	char pad = (m_zero_pad < 0 ? ' ' : '0');
-	zero_pad = (m_zero_pad < 0 ? -m_zero_pad : m_zero_pad);
 
-	// True if the number is negative. If this flag is set, the
-	// number will be printed with a "-" in front.
+	// Negative numbers are printed with a "-" in front, followed by the padding
+	UTYPE num = (UTYPE)m_value;
 	if constexpr (std::is_signed<NUMTYPE>::value) {
 		if (m_value < 0) {
-			num = -m_value;
-			buf_start[0] = '-';
-			buf_start++;
+			num = (UTYPE)((UTYPE)0 - num);
+			*p++ = '-';
 			if (zero_pad > 0) zero_pad--;
 		}
-		else {num = m_value;}
-	}
-	else {num = m_value;}
-
-	if (num == 0) {
-		if (zero_pad > 0) {
-			memset(buf_start, pad, zero_pad);
-			buf_start[zero_pad] = '\0';
-			buf_start[zero_pad-1] = '0';
-		}
-		else {
-			buf_start[0] = '0';
-			buf_start[1] = '\0';
-		}
-		o << buf;
-		return;
-	}
-
-	char* p = buf_start;
-	while (num > 0) {
-		(*p) = m_conv_set[num % m_base];
-		num /= m_base;
-		p++;
 	}
 
-	while ((int)(p-buf_start) < (int)zero_pad) {
-		(*p) = pad;
-		p++;
+	size_t len = fmt_unsigned(p, num, (unsigned)m_base, m_conv_set);
+	if (len < zero_pad) {
+		memmove(p + (zero_pad - len), p, len);
+		memset(p, pad, zero_pad - len);
+		len = zero_pad;
 	}
-
-	(*p) = '\0';
-	reverse_string(buf_start);
-	o << buf;
+	return (size_t)(p - buffer) + len;
 }
 
 // Stream on a std::ostream
 template<class NUMTYPE>
 std::ostream& operator<<(std::ostream& o, const fmt<NUMTYPE>& n) {n.print(o); return o;}
 
-// Stream on a sink_ch32
+// Stream on a sink_ch32; the text is plain ASCII, so no UTF-8 decoding is needed
 template<class NUMTYPE>
-sink_ch32& operator<<(sink_ch32& sink, const fmt<NUMTYPE>& s) {fmt32utf8<const fmt<NUMTYPE>&> fm(s); fm.write_to_sink(sink); return sink;}
+sink_ch32& operator<<(sink_ch32& sink, const fmt<NUMTYPE>& s) {
+	char buf[fmt<NUMTYPE>::MAX_LENGTH];
+	char32_t buf32[fmt<NUMTYPE>::MAX_LENGTH];
+	size_t len = s.write(buf);
+	for (size_t i=0; i<len; i++) buf32[i] = (char32_t)(uint8_t)buf[i];
+	sink.sink_write(buf32, len);
+	return sink;
+}
 
 
 } // namespace dastd
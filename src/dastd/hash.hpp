@@ -57,6 +57,8 @@ class hash {
 		template<class CHARTYPE>
 		hash& add(const CHARTYPE* chars, size_t length) {
 			static_assert(std::is_integral<CHARTYPE>::value, "Integral required");
+			// Single byte characters are hashed as a block
+			if constexpr (sizeof(CHARTYPE) == 1) return add_binary(chars, length);
 			size_t i; for(i=0; i<length; i++) add(chars[i]); return *this;
 		}
 
@@ -6,9 +6,32 @@
 #pragma once
 #include "hash.hpp"
 #include "fmt.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
 #include <string>
 
+#if defined __x86_64__ && defined __GNUC__
+	#define DASTD_CRC32_X86
+	#include <immintrin.h>
+#endif
+
 namespace dastd {
+
+/// @brief Implementation used to calculate the CRC-32
+enum class hash_crc32_impl {
+	/// @brief Best implementation available on this CPU
+	AUTO,
+
+	/// @brief One byte at a time with `crc32_table`
+	BYTEWISE,
+
+	/// @brief Eight bytes at a time with `crc32_slicing_table`
+	SLICING_BY_8,
+
+	/// @brief Carry-less multiplication (PCLMULQDQ) folding 64 bytes at a time; x86-64 only
+	PCLMUL,
+};
 /// @brief CRC-32 hash calculator
 ///
 /// Implementation of the CRC-32 that uses the polynom also used by ISO 3309 (HDLC), ANSI X3.66 (ADCCP),
@@ -25,6 +48,24 @@ class hash_crc32: public hash {
 		// Internal crc-32 sum
 		uint32_t m_crc32 = CRC32BASE;
 
+		/// @brief Implementation in use
+		hash_crc32_impl m_impl;
+
+		/// @brief Update the internal sum one byte at a time
+		static uint32_t update_bytewise(uint32_t crc, const uint8_t* data, size_t length);
+
+		/// @brief Update the internal sum eight bytes at a time
+		static uint32_t update_slicing_by_8(uint32_t crc, const uint8_t* data, size_t length);
+
+		#ifdef DASTD_CRC32_X86
+		/// @brief Update the internal sum with carry-less multiplications
+		/// @param crc Internal sum
+		/// @param data Data; at least 64 bytes
+		/// @param length Length of the data; at least 64 and a multiple of 16
+		/// @return Returns the updated internal sum
+		static uint32_t update_pclmul(uint32_t crc, const uint8_t* data, size_t length);
+		#endif
+
 	protected:
 		/// @brief Virtual method that adds the indicated bytes to the current hash sum using CRC-32
 		///
@@ -35,6 +76,16 @@ class hash_crc32: public hash {
 		virtual hash& add_binary(const void* bytes, size_t length) override;
 
 	public:
+		/// @brief Constructor
+		/// @param impl Implementation to be used; if not supported by the CPU, `SLICING_BY_8` is used
+		hash_crc32(hash_crc32_impl impl=hash_crc32_impl::AUTO);
+
+		/// @brief Return the best implementation available on this CPU
+		static hash_crc32_impl best_impl();
+
+		/// @brief Implementation in use
+		hash_crc32_impl get_impl() const {return m_impl;}
+
 		/// @brief reset the hash calculator to its initial state.
 		virtual void clear() override {m_crc32 = CRC32BASE;}
 
@@ -122,6 +173,156 @@ inline constexpr uint32_t crc32_table [256] = {
 	0x2d02ef8dUL
 };
 
+/// @brief Tables for the slicing-by-8 CRC-32
+///
+/// `crc32_slicing_table[N][b]` is the CRC-32 contribution of the byte `b` followed by N zero bytes;
+/// `crc32_slicing_table[0]` is `crc32_table`.
+inline constexpr std::array<std::array<uint32_t,256>,8> crc32_slicing_table = [] {
+	std::array<std::array<uint32_t,256>,8> table{};
+	for (size_t i=0; i<256; i++) table[0][i] = crc32_table[i];
+	for (size_t n=1; n<8; n++) {
+		for (size_t i=0; i<256; i++) table[n][i] = (table[n-1][i] >> 8) ^ crc32_table[table[n-1][i] & 0xff];
+	}
+	return table;
+}();
+
+//------------------------------------------------------------------------------
+// (brief) Constructor
+// (param) impl Implementation to be used
+//------------------------------------------------------------------------------
+inline hash_crc32::hash_crc32(hash_crc32_impl impl)
+{
+	if (impl == hash_crc32_impl::AUTO) impl = best_impl();
+	m_impl = impl;
+	#ifdef DASTD_CRC32_X86
+	if ((impl == hash_crc32_impl::PCLMUL) && !(__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))) m_impl = hash_crc32_impl::SLICING_BY_8;
+	#else
+	if (impl == hash_crc32_impl::PCLMUL) m_impl = hash_crc32_impl::SLICING_BY_8;
+	#endif
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return the best implementation available on this CPU
+//------------------------------------------------------------------------------
+inline hash_crc32_impl hash_crc32::best_impl()
+{
+	#ifdef DASTD_CRC32_X86
+	static const hash_crc32_impl best = ((__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) ? hash_crc32_impl::PCLMUL : hash_crc32_impl::SLICING_BY_8);
+	return best;
+	#else
+	return hash_crc32_impl::SLICING_BY_8;
+	#endif
+}
+
+//------------------------------------------------------------------------------
+// (brief) Update the internal sum one byte at a time
+//------------------------------------------------------------------------------
+inline uint32_t hash_crc32::update_bytewise(uint32_t crc, const uint8_t* data, size_t length)
+{
+	size_t i;
+	for (i=0; i<length; i++) {
+		uint32_t ch = data[i];
+		crc = crc32_table[(crc ^ ch) & 0xff] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Update the internal sum eight bytes at a time
+//------------------------------------------------------------------------------
+inline uint32_t hash_crc32::update_slicing_by_8(uint32_t crc, const uint8_t* data, size_t length)
+{
+	if constexpr (std::endian::native == std::endian::little) {
+		const auto& t = crc32_slicing_table;
+		for (; length>=8; data+=8, length-=8) {
+			uint32_t low, high;
+			memcpy(&low, data, 4);
+			memcpy(&high, data+4, 4);
+			low ^= crc;
+			crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+				t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+		}
+	}
+	return update_bytewise(crc, data, length);
+}
+
+#ifdef DASTD_CRC32_X86
+//------------------------------------------------------------------------------
+// (brief) Update the internal sum with carry-less multiplications
+//
+// Four 128-bit accumulators are folded over 64 bytes per iteration, then
+// reduced to 128 bits, folded over the remaining 16-byte blocks and finally
+// reduced to 32 bits with a Barrett reduction. The constants are powers of
+// x modulo the bit-reflected polynomial, as described in the Intel paper
+// "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+//------------------------------------------------------------------------------
+__attribute__((target("pclmul,sse4.1")))
+inline uint32_t hash_crc32::update_pclmul(uint32_t crc, const uint8_t* data, size_t length)
+{
+	assert((length >= 64) && ((length % 16) == 0));
+	const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+	const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+	const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+	__m128i x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+	__m128i x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+	__m128i x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+	data += 64;
+	length -= 64;
+
+	// Fold 64 bytes at a time
+	for (; length>=64; data+=64, length-=64) {
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+	}
+
+	// Fold the four accumulators into one
+	auto fold16 = [&](__m128i acc, __m128i next) __attribute__((target("pclmul,sse4.1"))) {
+		__m128i low = _mm_clmulepi64_si128(acc, k3k4, 0x00);
+		__m128i high = _mm_clmulepi64_si128(acc, k3k4, 0x11);
+		return _mm_xor_si128(_mm_xor_si128(high, next), low);
+	};
+	x1 = fold16(x1, x2);
+	x1 = fold16(x1, x3);
+	x1 = fold16(x1, x4);
+
+	// Fold the remaining 16-byte blocks
+	for (; length>=16; data+=16, length-=16) {
+		x1 = fold16(x1, _mm_loadu_si128((const __m128i*)data));
+	}
+
+	// Reduce from 128 to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+#endif
+
 /// @brief Virtual method that adds the indicated bytes to the current hash sum using CRC-32
 ///
 /// @param bytes Pointer to the array of raw bytes to be processed
@@ -130,11 +331,17 @@ inline constexpr uint32_t crc32_table [256] = {
 /// @return Returns this hash to allow chaining
 inline hash& hash_crc32::add_binary(const void* bytes, size_t length)
 {
-	size_t i;
-	for (i=0; i<length; i++) {
-		uint32_t ch = ((const uint8_t*)bytes)[i];
-		m_crc32 = crc32_table[(m_crc32 ^ ch) & 0xff] ^ (m_crc32 >> 8);
+	const uint8_t* data = (const uint8_t*)bytes;
+	#ifdef DASTD_CRC32_X86
+	if ((m_impl == hash_crc32_impl::PCLMUL) && (length >= 64)) {
+		size_t folded = length & ~(size_t)15;
+		m_crc32 = update_pclmul(m_crc32, data, folded);
+		data += folded;
+		length -= folded;
 	}
+	#endif
+	if (m_impl == hash_crc32_impl::BYTEWISE) m_crc32 = update_bytewise(m_crc32, data, length);
+	else m_crc32 = update_slicing_by_8(m_crc32, data, length);
 	return *this;
 }
 
@@ -0,0 +1,624 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+*
+* JSON DOM
+* ^^^^^^^^
+* `json_dom` parses a whole JSON document with `json_tokenizer_sourced` and
+* stores it in a read-only form that can be navigated randomly.
+*
+* The nodes are stored in a single array in document order: the first child
+* of a container immediately follows it and each node records the position
+* of its next sibling. The strings (values and object keys, in UTF-8) are
+* stored back to back in a single buffer and referred to by offset.
+* Arrays and objects with many elements have an additional lookup table,
+* stored in a third buffer, giving direct access to the N-th element of an
+* array or to the member of an object with a given key.
+*
+* So a whole document lives in three buffers, freed at once when the
+* `json_dom` is destroyed. Parsing another document in the same `json_dom`
+* reuses the memory already allocated.
+**/
+#pragma once
+#include "json_tokenizer.hpp"
+#include "source_membuf.hpp"
+#include "exception.hpp"
+#include "fmt_string.hpp"
+#include <bit>
+#include <string_view>
+#include <vector>
+
+namespace dastd {
+
+/// @brief Exception thrown by `json_dom`
+DASTD_DEF_EXCEPTION(exception_json_dom)
+
+/// @brief Type of a `json_dom` node
+enum class json_dom_type: uint8_t {
+	/// @brief Invalid node (for example, a missing object member)
+	INVALID,
+
+	/// @brief `null`
+	NULL_VALUE,
+
+	/// @brief `true` or `false`
+	BOOL,
+
+	/// @brief Number that fits an `int64_t`
+	INT64,
+
+	/// @brief Positive number that fits only an `uint64_t`
+	UINT64,
+
+	/// @brief Number available only as `double`
+	DOUBLE,
+
+	/// @brief String
+	STRING,
+
+	/// @brief Array
+	ARRAY,
+
+	/// @brief Object
+	OBJECT,
+};
+
+/// @brief Print operator
+std::ostream& operator<<(std::ostream& o, json_dom_type t);
+
+/// @brief Read-only JSON document
+///
+/// See JSON DOM in the header.
+///
+/// Example:
+///
+///     json_dom dom;
+///     dom.parse(text);
+///     json_dom::value items = dom.root().find("items");
+///     for (json_dom::value item = items.first_child(); item.valid(); item = item.next_sibling()) {
+///         std::cout << item.find("name").get_string() << std::endl;
+///     }
+///
+class json_dom {
+	private:
+		/// @brief Node of the document
+		struct node {
+			/// @brief Index of the next sibling; zero if this is the last one
+			uint32_t m_next = 0;
+
+			/// @brief Offset of the key in `m_strings` (members of objects only)
+			uint32_t m_key_offset = 0;
+
+			/// @brief Length of the key (members of objects only)
+			uint32_t m_key_length = 0;
+
+			/// @brief Type of the node
+			json_dom_type m_type = json_dom_type::INVALID;
+
+			/// @brief Value, according to `m_type`
+			union {
+				/// @brief BOOL (0 or 1) and INT64
+				int64_t m_i64;
+
+				/// @brief UINT64
+				uint64_t m_u64;
+
+				/// @brief DOUBLE
+				double m_double;
+
+				/// @brief STRING
+				struct {
+					/// @brief Offset in `m_strings`
+					uint32_t m_offset;
+
+					/// @brief Length
+					uint32_t m_length;
+				} m_string;
+
+				/// @brief ARRAY and OBJECT
+				struct {
+					/// @brief Number of elements
+					uint32_t m_count;
+
+					/// @brief Offset of the lookup table in `m_tables` or `NO_TABLE`
+					uint32_t m_table;
+				} m_container;
+			};
+
+			/// @brief Constructor
+			node(): m_i64(0) {}
+		};
+
+		/// @brief Value of `m_container.m_table` when there is no lookup table
+		static constexpr uint32_t NO_TABLE = UINT32_MAX;
+
+		/// @brief Containers with less elements are scanned linearly, with no lookup table
+		static constexpr uint32_t MIN_TABLE_ELEMENTS = 8;
+
+		/// @brief Nodes in document order; the root is the first one
+		std::vector<node> m_nodes;
+
+		/// @brief Strings and keys, back to back
+		std::string m_strings;
+
+		/// @brief Lookup tables
+		///
+		/// For arrays, the table contains the node indexes of the elements.
+		/// For objects, the table is a hash table with a power of two number
+		/// of slots, each containing the node index of a member or zero if empty;
+		/// the table is preceded by the number of slots.
+		std::vector<uint32_t> m_tables;
+
+		/// @brief Hash of a key (32-bit FNV-1a)
+		static uint32_t key_hash(std::string_view key);
+
+		/// @brief Append a string to `m_strings`
+		/// @param text String to be added
+		/// @param offset Receives the offset in `m_strings`
+		/// @param length Receives the length
+		void add_string(const std::string& text, uint32_t& offset, uint32_t& length);
+
+		/// @brief Build the lookup table of a container, if needed
+		/// @param index Node index of the container
+		void build_table(uint32_t index);
+
+		/// @brief Parse a document from a tokenizer
+		template<class CHARTYPE>
+		void parse_tokens(json_tokenizer_sourced<CHARTYPE>& tokenizer);
+
+	public:
+		/// @brief Handle to a node of the document
+		///
+		/// It is a lightweight object that can be copied freely; it is
+		/// valid as long as the `json_dom` is not modified or destroyed.
+		class value {
+			private:
+				/// @brief Document; `nullptr` for invalid values
+				const json_dom* m_dom = nullptr;
+
+				/// @brief Node index
+				uint32_t m_index = 0;
+
+				/// @brief Return the node
+				const node& get_node() const {return m_dom->m_nodes[m_index];}
+
+			public:
+				/// @brief Constructor of an invalid value
+				value() {}
+
+				/// @brief Constructor
+				/// @param dom   Document
+				/// @param index Node index
+				value(const json_dom* dom, uint32_t index): m_dom(dom), m_index(index) {}
+
+				/// @brief Return `true` if the value refers to an existing node
+				bool valid() const {return m_dom != nullptr;}
+
+				/// @brief Return the type of the node (`INVALID` for invalid values)
+				json_dom_type type() const {return (valid() ? get_node().m_type : json_dom_type::INVALID);}
+
+				/// @brief Return `true` if the value is `null`
+				bool is_null() const {return type() == json_dom_type::NULL_VALUE;}
+
+				/// @brief Return `true` if the value is a number
+				bool is_number() const {json_dom_type t=type(); return (t == json_dom_type::INT64) || (t == json_dom_type::UINT64) || (t == json_dom_type::DOUBLE);}
+
+				/// @brief Return `true` if the value is a string
+				bool is_string() const {return type() == json_dom_type::STRING;}
+
+				/// @brief Return `true` if the value is an array
+				bool is_array() const {return type() == json_dom_type::ARRAY;}
+
+				/// @brief Return `true` if the value is an object
+				bool is_object() const {return type() == json_dom_type::OBJECT;}
+
+				/// @brief Return the boolean value
+				/// @param value_on_fail Value returned if the node is not a boolean
+				bool get_bool(bool value_on_fail=false) const {return (type() == json_dom_type::BOOL ? get_node().m_i64 != 0 : value_on_fail);}
+
+				/// @brief Return the number; it is not valid if the node is not a number
+				multinum get_multinum() const;
+
+				/// @brief Attempt to retrieve the number as the indicated NUMTYPE
+				/// @tparam NUMTYPE A valid integral or floating numtype
+				/// @return Returns a pair where `first` is the value and `second` is `true` if the value is valid.
+				template<class NUMTYPE>
+				std::pair<NUMTYPE,bool> get() const {return get_multinum().get<NUMTYPE>();}
+
+				/// @brief Return the string in UTF-8; empty if the node is not a string
+				std::string_view get_string() const;
+
+				/// @brief Return the key of an object member in UTF-8; empty for the other nodes
+				std::string_view get_key() const;
+
+				/// @brief Return the number of elements of an array or an object; zero for the other nodes
+				size_t size() const;
+
+				/// @brief Return the first element of an array or an object (invalid if none)
+				value first_child() const {return (size() > 0 ? value(m_dom, m_index+1) : value());}
+
+				/// @brief Return the next element of the container this value belongs to (invalid if none)
+				value next_sibling() const {return ((valid() && (get_node().m_next != 0)) ? value(m_dom, get_node().m_next) : value());}
+
+				/// @brief Return the element of an array or an object at the indicated position
+				///
+				/// It is a direct access for arrays with a lookup table; for objects
+				/// and small arrays it walks the siblings.
+				///
+				/// @param pos Position of the element
+				/// @return Returns the element or an invalid value if `pos` is out of range
+				value at(size_t pos) const;
+
+				/// @brief Return the element of an array or an object at the indicated position (see `at`)
+				template<std::integral INTTYPE>
+				value operator[](INTTYPE pos) const {return (pos < 0 ? value() : at((size_t)pos));}
+
+				/// @brief Find an object member by key
+				///
+				/// If the key appears more than once, the first member is returned.
+				///
+				/// @param key Key in UTF-8
+				/// @return Returns the member or an invalid value if not found or
+				///         if this value is not an object
+				value find(std::string_view key) const;
+
+				/// @brief Find an object member by key (see `find`)
+				value operator[](std::string_view key) const {return find(key);}
+
+				/// @brief Find an object member by key (see `find`)
+				value operator[](const char* key) const {return find(key);}
+		};
+
+		/// @brief Constructor
+		json_dom() {}
+
+		/// @brief Clear the document; the allocated memory is kept for reuse
+		void clear() {m_nodes.clear(); m_strings.clear(); m_tables.clear();}
+
+		/// @brief Parse a document read from a source
+		///
+		/// The source must contain exactly one JSON value, possibly
+		/// surrounded by spaces.
+		///
+		/// @tparam CHARTYPE Type of the character
+		/// @param source Source of the document
+		/// @throw Throws `exception_json_dom` in case of syntax errors
+		template<class CHARTYPE>
+		void parse(source_with_peek<CHARTYPE>& source);
+
+		/// @brief Parse a document in memory
+		/// @param text Document
+		/// @param length Length of the document
+		/// @throw Throws `exception_json_dom` in case of syntax errors
+		void parse(const char* text, size_t length) {source_membuf<char> source(text, length); parse(source);}
+
+		/// @brief Parse a document in memory
+		/// @param text Document
+		/// @throw Throws `exception_json_dom` in case of syntax errors
+		void parse(const std::string& text) {parse(text.data(), text.length());}
+
+		/// @brief Return the root value (invalid if no document has been parsed)
+		value root() const {return (m_nodes.empty() ? value() : value(this, 0));}
+
+		/// @brief Number of nodes of the document
+		size_t get_nodes_count() const {return m_nodes.size();}
+};
+
+//------------------------------------------------------------------------------
+// (brief) Print operator
+//------------------------------------------------------------------------------
+inline std::ostream& operator<<(std::ostream& o, json_dom_type t)
+{
+	switch(t) {
+		case json_dom_type::INVALID: o << "INVALID"; break;
+		case json_dom_type::NULL_VALUE: o << "NULL_VALUE"; break;
+		case json_dom_type::BOOL: o << "BOOL"; break;
+		case json_dom_type::INT64: o << "INT64"; break;
+		case json_dom_type::UINT64: o << "UINT64"; break;
+		case json_dom_type::DOUBLE: o << "DOUBLE"; break;
+		case json_dom_type::STRING: o << "STRING"; break;
+		case json_dom_type::ARRAY: o << "ARRAY"; break;
+		case json_dom_type::OBJECT: o << "OBJECT"; break;
+		default: o << "UNKNOWN(" << (unsigned)t << ")";
+	}
+	return o;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Hash of a key (32-bit FNV-1a)
+//------------------------------------------------------------------------------
+inline uint32_t json_dom::key_hash(std::string_view key)
+{
+	uint32_t h = 2166136261U;
+	for (char ch: key) {
+		h ^= (uint8_t)ch;
+		h *= 16777619U;
+	}
+	return h;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Append a string to `m_strings`
+//------------------------------------------------------------------------------
+inline void json_dom::add_string(const std::string& text, uint32_t& offset, uint32_t& length)
+{
+	if (m_strings.length() + text.length() > UINT32_MAX) DASTD_THROW(exception_json_dom, "json_dom: the strings of the document exceed 4 GiB");
+	offset = (uint32_t)m_strings.length();
+	length = (uint32_t)text.length();
+	m_strings.append(text);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Build the lookup table of a container, if needed
+//------------------------------------------------------------------------------
+inline void json_dom::build_table(uint32_t index)
+{
+	node& container = m_nodes[index];
+	uint32_t count = container.m_container.m_count;
+	if (count < MIN_TABLE_ELEMENTS) return;
+
+	container.m_container.m_table = (uint32_t)m_tables.size();
+	if (container.m_type == json_dom_type::ARRAY) {
+		for (uint32_t child=index+1; child!=0; child=m_nodes[child].m_next) m_tables.push_back(child);
+	}
+	else {
+		uint32_t slots = std::bit_ceil(2*count);
+		m_tables.push_back(slots);
+		size_t base = m_tables.size();
+		m_tables.resize(base + slots, 0);
+		for (uint32_t child=index+1; child!=0; child=m_nodes[child].m_next) {
+			const node& n = m_nodes[child];
+			uint32_t slot = key_hash(std::string_view(m_strings.data()+n.m_key_offset, n.m_key_length)) & (slots-1);
+			while (m_tables[base+slot] != 0) slot = (slot+1) & (slots-1);
+			m_tables[base+slot] = child;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Parse a document read from a source
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_dom::parse(source_with_peek<CHARTYPE>& source)
+{
+	clear();
+	json_tokenizer_sourced<CHARTYPE> tokenizer(source, json_tokenizer_sourced<CHARTYPE>::STRING_VIEWS);
+	try {
+		parse_tokens(tokenizer);
+	}
+	catch(...) {
+		clear();
+		throw;
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Parse a document from a tokenizer
+//
+// The containers being parsed are kept in a stack, so the nesting depth
+// is not limited by the call stack.
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_dom::parse_tokens(json_tokenizer_sourced<CHARTYPE>& tokenizer)
+{
+	// Container being parsed
+	struct frame {
+		/// Node index of the container
+		uint32_t m_index;
+
+		/// Node index of the last element added (zero if none)
+		uint32_t m_last_child;
+	};
+	std::vector<frame> stack;
+
+	// Used to print the raw tokens in the error messages
+	using raw_printer = fmt_string<CHARTYPE,fmt_string_f::C11_ESCAPED_QUOTED>;
+
+	// What is expected next
+	enum class expect_t {VALUE, VALUE_OR_CLOSE, KEY, KEY_OR_CLOSE, COLON, COMMA_OR_CLOSE, NOTHING};
+	expect_t expect = expect_t::VALUE;
+
+	// Key of the member being parsed
+	uint32_t key_offset = 0;
+	uint32_t key_length = 0;
+
+	std::string utf8;
+	for(;;) {
+		json_tokenizer_ret ret = tokenizer.fetch_token();
+		if (ret == json_tokenizer_ret::C_NOTHING_MORE) {
+			if (expect != expect_t::NOTHING) DASTD_THROW(exception_json_dom, "json_dom: unexpected end of the document");
+			return;
+		}
+		if (ret == json_tokenizer_ret::C_ERROR) DASTD_THROW(exception_json_dom, "json_dom: syntax error at " << raw_printer(tokenizer.get_raw_token()));
+
+		bool is_close = ((ret == json_tokenizer_ret::C_BRACE_CLOSE) || (ret == json_tokenizer_ret::C_BRACKET_CLOSE));
+		switch(expect) {
+			case expect_t::COLON: {
+				if (ret != json_tokenizer_ret::C_COLON) break;
+				expect = expect_t::VALUE;
+				continue;
+			}
+			case expect_t::KEY:
+			case expect_t::KEY_OR_CLOSE: {
+				if (ret == json_tokenizer_ret::C_STRING) {
+					tokenizer.get_string_utf8(utf8);
+					add_string(utf8, key_offset, key_length);
+					expect = expect_t::COLON;
+					continue;
+				}
+				if ((expect == expect_t::KEY_OR_CLOSE) && (ret == json_tokenizer_ret::C_BRACE_CLOSE)) break;
+				DASTD_THROW(exception_json_dom, "json_dom: expected an object key, got " << ret << " " << raw_printer(tokenizer.get_raw_token()));
+			}
+			case expect_t::COMMA_OR_CLOSE: {
+				if (ret != json_tokenizer_ret::C_COMMA) break;
+				expect = (m_nodes[stack.back().m_index].m_type == json_dom_type::OBJECT ? expect_t::KEY : expect_t::VALUE);
+				continue;
+			}
+			case expect_t::NOTHING: {
+				DASTD_THROW(exception_json_dom, "json_dom: unexpected " << ret << " " << raw_printer(tokenizer.get_raw_token()) << " after the end of the document");
+			}
+			default: break;
+		}
+
+		// Closing a container
+		if (is_close && ((expect == expect_t::COMMA_OR_CLOSE) || (expect == expect_t::VALUE_OR_CLOSE) || (expect == expect_t::KEY_OR_CLOSE))) {
+			json_dom_type type = m_nodes[stack.back().m_index].m_type;
+			if ((ret == json_tokenizer_ret::C_BRACE_CLOSE) != (type == json_dom_type::OBJECT)) DASTD_THROW(exception_json_dom, "json_dom: mismatched " << raw_printer(tokenizer.get_raw_token()));
+			build_table(stack.back().m_index);
+			stack.pop_back();
+			expect = (stack.empty() ? expect_t::NOTHING : expect_t::COMMA_OR_CLOSE);
+			continue;
+		}
+
+		if ((expect != expect_t::VALUE) && (expect != expect_t::VALUE_OR_CLOSE)) {
+			DASTD_THROW(exception_json_dom, "json_dom: unexpected " << ret << " " << raw_printer(tokenizer.get_raw_token()));
+		}
+
+		// Add the value node
+		if (m_nodes.size() >= UINT32_MAX) DASTD_THROW(exception_json_dom, "json_dom: too many nodes");
+		uint32_t index = (uint32_t)m_nodes.size();
+		m_nodes.emplace_back();
+		node& n = m_nodes.back();
+		bool is_container = false;
+		switch(ret) {
+			case json_tokenizer_ret::C_NULL: n.m_type = json_dom_type::NULL_VALUE; break;
+			case json_tokenizer_ret::C_TRUE: n.m_type = json_dom_type::BOOL; n.m_i64 = 1; break;
+			case json_tokenizer_ret::C_FALSE: n.m_type = json_dom_type::BOOL; n.m_i64 = 0; break;
+			case json_tokenizer_ret::C_NUMBER: {
+				const multinum& number = tokenizer.get_multinum();
+				auto i64 = number.get<int64_t>();
+				auto u64 = number.get<uint64_t>();
+				if (i64.second) {n.m_type = json_dom_type::INT64; n.m_i64 = i64.first;}
+				else if (u64.second) {n.m_type = json_dom_type::UINT64; n.m_u64 = u64.first;}
+				else {n.m_type = json_dom_type::DOUBLE; n.m_double = number.get<double>().first;}
+				break;
+			}
+			case json_tokenizer_ret::C_STRING: {
+				n.m_type = json_dom_type::STRING;
+				tokenizer.get_string_utf8(utf8);
+				add_string(utf8, n.m_string.m_offset, n.m_string.m_length);
+				break;
+			}
+			case json_tokenizer_ret::C_BRACE_OPEN:
+			case json_tokenizer_ret::C_BRACKET_OPEN: {
+				n.m_type = (ret == json_tokenizer_ret::C_BRACE_OPEN ? json_dom_type::OBJECT : json_dom_type::ARRAY);
+				n.m_container.m_count = 0;
+				n.m_container.m_table = NO_TABLE;
+				is_container = true;
+				break;
+			}
+			default: DASTD_THROW(exception_json_dom, "json_dom: unexpected " << ret << " " << raw_printer(tokenizer.get_raw_token()));
+		}
+
+		// Link the node to its container
+		if (!stack.empty()) {
+			frame& parent = stack.back();
+			node& parent_node = m_nodes[parent.m_index];
+			if (parent_node.m_type == json_dom_type::OBJECT) {
+				m_nodes[index].m_key_offset = key_offset;
+				m_nodes[index].m_key_length = key_length;
+			}
+			if (parent.m_last_child != 0) m_nodes[parent.m_last_child].m_next = index;
+			parent.m_last_child = index;
+			parent_node.m_container.m_count++;
+		}
+
+		if (is_container) {
+			stack.push_back(frame{index, 0});
+			expect = (ret == json_tokenizer_ret::C_BRACE_OPEN ? expect_t::KEY_OR_CLOSE : expect_t::VALUE_OR_CLOSE);
+		}
+		else {
+			expect = (stack.empty() ? expect_t::NOTHING : expect_t::COMMA_OR_CLOSE);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return the number; it is not valid if the node is not a number
+//------------------------------------------------------------------------------
+inline multinum json_dom::value::get_multinum() const
+{
+	multinum ret;
+	switch(type()) {
+		case json_dom_type::INT64: ret.set<int64_t>(get_node().m_i64); break;
+		case json_dom_type::UINT64: ret.set<uint64_t>(get_node().m_u64); break;
+		case json_dom_type::DOUBLE: ret.set<double>(get_node().m_double); break;
+		default: break;
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return the string in UTF-8; empty if the node is not a string
+//------------------------------------------------------------------------------
+inline std::string_view json_dom::value::get_string() const
+{
+	if (type() != json_dom_type::STRING) return std::string_view();
+	return std::string_view(m_dom->m_strings.data() + get_node().m_string.m_offset, get_node().m_string.m_length);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return the key of an object member in UTF-8; empty for the other nodes
+//------------------------------------------------------------------------------
+inline std::string_view json_dom::value::get_key() const
+{
+	if (!valid()) return std::string_view();
+	return std::string_view(m_dom->m_strings.data() + get_node().m_key_offset, get_node().m_key_length);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return the number of elements of an array or an object; zero for the other nodes
+//------------------------------------------------------------------------------
+inline size_t json_dom::value::size() const
+{
+	json_dom_type t = type();
+	if ((t != json_dom_type::ARRAY) && (t != json_dom_type::OBJECT)) return 0;
+	return get_node().m_container.m_count;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return the element of an array or an object at the indicated position
+//------------------------------------------------------------------------------
+inline json_dom::value json_dom::value::at(size_t pos) const
+{
+	if (pos >= size()) return value();
+	const node& n = get_node();
+	if ((n.m_type == json_dom_type::ARRAY) && (n.m_container.m_table != NO_TABLE)) {
+		return value(m_dom, m_dom->m_tables[n.m_container.m_table + pos]);
+	}
+	value child = first_child();
+	while (pos-- > 0) child = child.next_sibling();
+	return child;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Find an object member by key
+//------------------------------------------------------------------------------
+inline json_dom::value json_dom::value::find(std::string_view key) const
+{
+	if (type() != json_dom_type::OBJECT) return value();
+	const node& n = get_node();
+
+	// Small objects: linear scan
+	if (n.m_container.m_table == NO_TABLE) {
+		for (value child = first_child(); child.valid(); child = child.next_sibling()) {
+			if (child.get_key() == key) return child;
+		}
+		return value();
+	}
+
+	// Hash table
+	const uint32_t* table = m_dom->m_tables.data() + n.m_container.m_table;
+	uint32_t slots = table[0];
+	uint32_t slot = key_hash(key) & (slots-1);
+	for(;;) {
+		uint32_t child = table[1+slot];
+		if (child == 0) return value();
+		value v(m_dom, child);
+		if (v.get_key() == key) return v;
+		slot = (slot+1) & (slots-1);
+	}
+}
+
+} // namespace dastd
@@ -8,75 +8,186 @@
 #pragma once
 #include "defs.hpp"
 #include "fmt.hpp"
+#include "utf8.hpp"
+#include <bit>
+#include <cassert>
 #include <iostream>
+#include <string>
+
+#if defined __x86_64__ && defined __GNUC__
+	#define DASTD_JSON_ENCODER_X86
+	#include <immintrin.h>
+#endif
 
 namespace dastd {
 
 
+/// @brief Maximum number of characters written by `json_encode_char` for one code point
+inline constexpr size_t JSON_ENCODE_CHAR_MAX_LENGTH = 12;
+
 /// @brief Encodes a char32_t character in ASCII escaped JSON form
-inline void json_encode_char(std::ostream& s, char32_t code_point)
+/// @param buffer Target buffer of at least `JSON_ENCODE_CHAR_MAX_LENGTH` characters
+/// @param code_point Character to be encoded
+/// @return Returns the number of characters written
+inline size_t json_encode_char(char* buffer, char32_t code_point)
 {
+	static constexpr char hex[] = "0123456789ABCDEF";
+	auto write_u = [&](char* p, uint32_t unit) {
+		p[0] = '\\'; p[1] = 'u';
+		p[2] = hex[(unit >> 12) & 0xF]; p[3] = hex[(unit >> 8) & 0xF];
+		p[4] = hex[(unit >> 4) & 0xF]; p[5] = hex[unit & 0xF];
+	};
+
 	switch(code_point) {
-		case 0x22: s << "\\\""; break; // quotation mark  U+0022
-		case 0x5C: s << "\\\\"; break; // reverse solidus U+005C
-		case 0x08: s << "\\b";  break; // backspace       U+0008
-		case 0x0C: s << "\\f";  break; // form feed       U+000C
-		case 0x0A: s << "\\n";  break; // line feed       U+000A
-		case 0x0D: s << "\\r";  break; // carriage return U+000D
-		case 0x09: s << "\\t";  break; // tab             U+0009
+		case 0x22: buffer[0] = '\\'; buffer[1] = '"';  return 2; // quotation mark  U+0022
+		case 0x5C: buffer[0] = '\\'; buffer[1] = '\\'; return 2; // reverse solidus U+005C
+		case 0x08: buffer[0] = '\\'; buffer[1] = 'b';  return 2; // backspace       U+0008
+		case 0x0C: buffer[0] = '\\'; buffer[1] = 'f';  return 2; // form feed       U+000C
+		case 0x0A: buffer[0] = '\\'; buffer[1] = 'n';  return 2; // line feed       U+000A
+		case 0x0D: buffer[0] = '\\'; buffer[1] = 'r';  return 2; // carriage return U+000D
+		case 0x09: buffer[0] = '\\'; buffer[1] = 't';  return 2; // tab             U+0009
 		default: {
 			if (code_point >= 32 && code_point <= 126) {
-				s << ((char)code_point);
+				buffer[0] = (char)code_point;
+				return 1;
+			}
+			// Standard UTF-16 characters excluding the surrogate pairs
+			if (code_point <= 0xD7FF || (code_point >= 0xE000 && code_point <= 0xFFFF)) {
+				write_u(buffer, code_point);
+				return 6;
 			}
-			else {
-				// Standard UTF-16 characters excluding the surrogate pairs
-				if (code_point <= 0xD7FF || (code_point >= 0xE000 && code_point <= 0xFFFF)) {
-					s << "\\u" << fmt(code_point, 16, 4);
-				}
-				// Code points from the other planes (called Supplementary Planes) are encoded
-				// as two 16-bit code units called a surrogate pair
-				else if (code_point >= 0x010000 && code_point <= 0x10FFFF) {
-					// Subtract 0x10000 from the codepoint
-					code_point -= 0x10000;
-					s
-						// Encode the higher 10-bits using the 0xD800 surrogate
-						<< "\\u" << fmt(0xD800 + ((code_point >> 10) & 0x3FF), 16, 4)
-						// Encode the lower 10-bits using the 0xDC00 surrogate
-						<< "\\u" << fmt(0xDC00 + (code_point & 0x3FF), 16, 4)
-					;
-				}
-				else {
-					// The remaining codepoints can not be encoded in UNICODE
-					assert(0);
-				}
+			// Code points from the other planes (called Supplementary Planes) are encoded
+			// as two 16-bit code units called a surrogate pair
+			if (code_point >= 0x010000 && code_point <= 0x10FFFF) {
+				// Subtract 0x10000 from the codepoint
+				code_point -= 0x10000;
+				// Encode the higher 10-bits using the 0xD800 surrogate
+				write_u(buffer, 0xD800 + ((code_point >> 10) & 0x3FF));
+				// Encode the lower 10-bits using the 0xDC00 surrogate
+				write_u(buffer+6, 0xDC00 + (code_point & 0x3FF));
+				return 12;
 			}
+			// The remaining codepoints can not be encoded in UNICODE
+			assert(0);
+			return 0;
 		}
 	}
 }
 
+/// @brief Encodes a char32_t character in ASCII escaped JSON form
+inline void json_encode_char(std::ostream& s, char32_t code_point)
+{
+	char buffer[JSON_ENCODE_CHAR_MAX_LENGTH];
+	s.write(buffer, (std::streamsize)json_encode_char(buffer, code_point));
+}
+
 /// @brief Encodes a char32_t string in ASCII escaped JSON form
-inline void json_encode_string(std::ostream& s, const std::u32string& string) {for(auto ch32: string) json_encode_char(s, ch32);}
+inline void json_encode_string(std::ostream& s, const std::u32string& string)
+{
+	char buffer[256];
+	size_t len = 0;
+	for(auto ch32: string) {
+		if (len + JSON_ENCODE_CHAR_MAX_LENGTH > sizeof(buffer)) {s.write(buffer, (std::streamsize)len); len = 0;}
+		len += json_encode_char(buffer+len, ch32);
+	}
+	s.write(buffer, (std::streamsize)len);
+}
 
-/// @brief Encodes an UTF-8 string into JSON format
-/// @param s Target stream (contains the encoded JSON string, without the double quotes)
+/// @brief Return the length of the initial part of an UTF-8 string that needs no escapes
+///
+/// The characters needing an escape are the controls, the double quote, the backslash,
+/// DEL and all the non-ASCII characters (encoded as `\uXXXX`).
+/// On x86-64 the string is scanned 16 bytes at a time with SSE2.
+///
+/// @param str Input string
+/// @param len Length of the input string
+/// @return Returns the offset of the first character needing an escape or `len` if none
+inline size_t json_encode_find_escape(const char* str, size_t len)
+{
+	size_t i = 0;
+	#ifdef DASTD_JSON_ENCODER_X86
+	const __m128i max_control = _mm_set1_epi8(0x1F);
+	const __m128i min_non_ascii = _mm_set1_epi8(0x7F);
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	for (; i+16<=len; i+=16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(str+i));
+		// Unsigned comparisons: v <= 0x1F and v >= 0x7F
+		__m128i found = _mm_cmpeq_epi8(_mm_min_epu8(v, max_control), v);
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(_mm_max_epu8(v, min_non_ascii), v));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(v, quote));
+		found = _mm_or_si128(found, _mm_cmpeq_epi8(v, backslash));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(found);
+		if (mask != 0) return i + (size_t)std::countr_zero(mask);
+	}
+	#endif
+	for (; i<len; i++) {
+		uint8_t ch = (uint8_t)str[i];
+		if ((ch < 0x20) || (ch >= 0x7F) || (ch == '"') || (ch == '\\')) break;
+	}
+	return i;
+}
+
+/// @brief Encodes an UTF-8 string into JSON format, passing the output to a function
+///
+/// The runs of characters needing no escapes are passed as they are, with no copies;
+/// the other characters are decoded, validated and escaped in a local buffer.
+/// Truncated or invalid sequences, overlong forms, surrogates and values above
+/// 0x10FFFF are errors; the output written up to the error is left as is.
+///
 /// @param str Input string
 /// @param len Length of the input string
+/// @param write Function receiving the output as `write(const char* data, size_t length)`
 /// @return Returns `true` if ok, `false` in case of errors in the UTF-8 sequence
-inline bool json_encode_string_from_UTF8(std::ostream& s, const char* str, size_t len) {
-	size_t offs=0;
-	char32_t ch32;
-	for(; offs<len;) {
-		size_t remaining = len-offs;
-		if (count_utf8_following_chars(str[offs]) > remaining) return false;
-		size_t p = read_utf8_asciiz(str+offs, ch32);
-		if (p == 0) return false;
-		json_encode_char(s, ch32);
+template<class WRITE>
+bool json_encode_string_from_UTF8_with(const char* str, size_t len, WRITE&& write)
+{
+	char buffer[256];
+	size_t buffer_len = 0;
+	size_t offs = 0;
+	while (offs < len) {
+		size_t clean = json_encode_find_escape(str+offs, len-offs);
+		if (clean > 0) {
+			if (buffer_len > 0) {write(buffer, buffer_len); buffer_len = 0;}
+			write(str+offs, clean);
+			offs += clean;
+			if (offs == len) break;
+		}
+
+		// A character needing an escape
+		if (buffer_len + JSON_ENCODE_CHAR_MAX_LENGTH > sizeof(buffer)) {write(buffer, buffer_len); buffer_len = 0;}
+		char32_t ch32;
+		size_t p = read_utf8_strict(str+offs, len-offs, ch32);
+		if (p == 0) {
+			if (buffer_len > 0) write(buffer, buffer_len);
+			return false;
+		}
+		buffer_len += json_encode_char(buffer+buffer_len, ch32);
 		offs += p;
 	}
+	if (buffer_len > 0) write(buffer, buffer_len);
 	return true;
 }
 
+/// @brief Encodes an UTF-8 string into JSON format
+/// @param s Target stream (contains the encoded JSON string, without the double quotes)
+/// @param str Input string
+/// @param len Length of the input string
+/// @return Returns `true` if ok, `false` in case of errors in the UTF-8 sequence
+inline bool json_encode_string_from_UTF8(std::ostream& s, const char* str, size_t len) {
+	return json_encode_string_from_UTF8_with(str, len, [&](const char* data, size_t length) {s.write(data, (std::streamsize)length);});
+}
+
 inline bool json_encode_string_from_UTF8(std::ostream& s, const std::string& utf8_string) {return json_encode_string_from_UTF8(s, utf8_string.c_str(), utf8_string.size());}
 
+/// @brief Encodes an UTF-8 string into JSON format appending it to a string
+/// @param out Target string; the encoded JSON string, without the double quotes, is appended
+/// @param str Input string
+/// @param len Length of the input string
+/// @return Returns `true` if ok, `false` in case of errors in the UTF-8 sequence
+inline bool json_encode_string_from_UTF8(std::string& out, const char* str, size_t len) {
+	return json_encode_string_from_UTF8_with(str, len, [&](const char* data, size_t length) {out.append(data, length);});
+}
+
 
 } // namespace dastd
@@ -0,0 +1,251 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "source_membuf.hpp"
+#include "thread_affinity.hpp"
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace dastd {
+
+/// @brief Decode JSON lines (NDJSON) using multiple threads
+///
+/// The input, entirely available in memory (for example the content
+/// of a `source_mmap`), is a sequence of JSON records separated by
+/// new lines. It is split at the line boundaries in chunks of about
+/// `chunk_size` characters and the chunks are distributed among the
+/// worker threads.
+/// For each record, the worker calls the decoding function passing a
+/// source bound to the record: the function typically runs its own
+/// `json_tokenizer_sourced` or `marshal_dec_json` on it. Each worker
+/// has its own decoders, so no locking is involved.
+///
+/// The lines containing only spaces are skipped. The results are
+/// returned in the same order of the records in the input.
+///
+/// Example:
+///
+///     json_lines_parallel<my_record> parallel;
+///     source_mmap file("records.jsonl");
+///     std::vector<my_record> records = parallel.decode(file.data(), file.size(),
+///         [](source_with_peek<char>& record, size_t offset) {
+///             marshal_dec_json<char> dec(record);
+///             my_record r;
+///             decode_my_record(dec, r);
+///             return r;
+///         });
+///
+/// @tparam RESULT Type returned by the decoding function for each record; it must be movable
+template<class RESULT>
+class json_lines_parallel {
+	public:
+		/// @brief Function decoding one record
+		///
+		/// It is invoked concurrently by multiple threads.
+		///
+		/// @param record Source bound to the record, new line excluded
+		/// @param offset Offset of the record in the input, for diagnostic purposes
+		/// @return Returns the result for the record
+		using decode_fn = std::function<RESULT(source_with_peek<char>& record, size_t offset)>;
+
+		/// @brief Default size of the chunks assigned to the workers
+		static constexpr size_t DEFAULT_CHUNK_SIZE = 1024*1024;
+
+	private:
+		/// @brief Portion of the input assigned to a worker
+		struct chunk {
+			/// @brief Offset of the first character
+			size_t m_begin;
+
+			/// @brief Offset past the last character
+			size_t m_end;
+
+			/// @brief Results of the records of the chunk
+			std::vector<RESULT> m_results;
+
+			/// @brief Exception thrown while decoding the chunk
+			std::exception_ptr m_error;
+		};
+
+		/// @brief Number of worker threads
+		unsigned m_threads_count;
+
+		/// @brief Approximate size of the chunks
+		size_t m_chunk_size = DEFAULT_CHUNK_SIZE;
+
+		/// @brief If true, the worker threads are pinned to consecutive cores
+		bool m_pin_threads = false;
+
+		/// @brief Core of the first worker thread if `m_pin_threads` is set
+		uint32_t m_first_core = 0;
+
+		/// @brief Split the input in chunks ending at line boundaries
+		/// @param data Input
+		/// @param size Size of the input
+		/// @return Returns the chunks
+		std::vector<chunk> split(const char* data, size_t size) const;
+
+		/// @brief Decode all the records of a chunk
+		/// @param data        Input
+		/// @param c           Chunk to be decoded
+		/// @param decode_line Decoding function
+		static void decode_chunk(const char* data, chunk& c, const decode_fn& decode_line);
+
+	public:
+		/// @brief Constructor
+		/// @param threads_count Number of worker threads; zero means one per hardware thread
+		json_lines_parallel(unsigned threads_count=0): m_threads_count(threads_count) {
+			if (m_threads_count == 0) m_threads_count = std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		/// @brief Return the number of worker threads
+		unsigned get_threads_count() const {return m_threads_count;}
+
+		/// @brief Set the approximate size of the chunks assigned to the workers
+		///
+		/// Smaller chunks balance better the load among the threads.
+		///
+		/// @param chunk_size Size in characters; a chunk is never smaller than a record
+		void set_chunk_size(size_t chunk_size) {m_chunk_size = std::max((size_t)1, chunk_size);}
+
+		/// @brief Pin the worker threads to consecutive cores
+		///
+		/// Worker N is pinned to core `first_core+N` using `pin_thread_to_core`.
+		/// Pinning failures are ignored.
+		///
+		/// @param pin_threads If `true`, the threads are pinned
+		/// @param first_core  Core of the first worker
+		void set_core_pinning(bool pin_threads, uint32_t first_core=0) {m_pin_threads = pin_threads; m_first_core = first_core;}
+
+		/// @brief Decode all the records
+		///
+		/// If the decoding function throws an exception, the decoding is stopped
+		/// and the exception of the first failing record (in input order) is re-thrown.
+		///
+		/// @param data        Input, that must stay unchanged during the call
+		/// @param size        Size of the input
+		/// @param decode_line Decoding function
+		/// @return Returns the results in the order of the records in the input
+		std::vector<RESULT> decode(const char* data, size_t size, const decode_fn& decode_line);
+};
+
+//------------------------------------------------------------------------------
+// (brief) Split the input in chunks ending at line boundaries
+//------------------------------------------------------------------------------
+template<class RESULT>
+std::vector<typename json_lines_parallel<RESULT>::chunk> json_lines_parallel<RESULT>::split(const char* data, size_t size) const
+{
+	std::vector<chunk> chunks;
+	size_t begin = 0;
+	while (begin < size) {
+		size_t end = size;
+		if (size - begin > m_chunk_size) {
+			const char* nl = (const char*)memchr(data + begin + m_chunk_size, '\n', size - begin - m_chunk_size);
+			if (nl != nullptr) end = (size_t)(nl - data) + 1;
+		}
+		chunks.push_back(chunk{begin, end, {}, nullptr});
+		begin = end;
+	}
+	return chunks;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Decode all the records of a chunk
+//------------------------------------------------------------------------------
+template<class RESULT>
+void json_lines_parallel<RESULT>::decode_chunk(const char* data, chunk& c, const decode_fn& decode_line)
+{
+	try {
+		size_t begin = c.m_begin;
+		while (begin < c.m_end) {
+			const char* nl = (const char*)memchr(data + begin, '\n', c.m_end - begin);
+			size_t end = (nl != nullptr ? (size_t)(nl - data) : c.m_end);
+
+			// Skip the blank lines
+			size_t i;
+			for (i=begin; i<end; i++) {
+				char ch = data[i];
+				if ((ch != ' ') && (ch != '\t') && (ch != '\r')) break;
+			}
+			if (i < end) {
+				source_membuf<char> record(data + begin, end - begin);
+				c.m_results.push_back(decode_line(record, begin));
+			}
+			begin = end + 1;
+		}
+	}
+	catch(...) {
+		c.m_error = std::current_exception();
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Decode all the records
+// (param) data        Input
+// (param) size        Size of the input
+// (param) decode_line Decoding function
+// (return) Returns the results in the order of the records in the input
+//
+// The workers pick the chunks in order from a shared counter; after
+// a failure, the chunks following the failing one are not started.
+//------------------------------------------------------------------------------
+template<class RESULT>
+std::vector<RESULT> json_lines_parallel<RESULT>::decode(const char* data, size_t size, const decode_fn& decode_line)
+{
+	std::vector<chunk> chunks = split(data, size);
+	std::atomic<size_t> next_chunk{0};
+	std::atomic<size_t> first_failed{SIZE_MAX};
+
+	auto worker = [&](unsigned worker_id, bool pin) {
+		if (pin) pin_thread_to_core(m_first_core + worker_id);
+		for(;;) {
+			size_t index = next_chunk++;
+			if ((index >= chunks.size()) || (index > first_failed)) break;
+			decode_chunk(data, chunks[index], decode_line);
+			if (chunks[index].m_error) {
+				size_t prev = first_failed;
+				while ((index < prev) && !first_failed.compare_exchange_weak(prev, index)) {}
+			}
+		}
+	};
+
+	// With a single thread or a single chunk, the work is done by the calling thread (never pinned)
+	unsigned threads_count = (unsigned)std::min((size_t)m_threads_count, chunks.size());
+	if (threads_count <= 1) {
+		worker(0, false);
+	}
+	else {
+		std::vector<std::thread> threads;
+		threads.reserve(threads_count);
+		try {
+			for (unsigned i=0; i<threads_count; i++) threads.emplace_back(worker, i, m_pin_threads);
+		}
+		catch(...) {
+			// Unable to create all the threads: the chunks are shared among the
+			// workers already started or, if none, processed by the calling thread
+			if (threads.empty()) worker(0, false);
+		}
+		for (auto& t: threads) t.join();
+	}
+
+	// Collect the results in order
+	size_t results_count = 0;
+	for (auto& c: chunks) {
+		if (c.m_error) std::rethrow_exception(c.m_error);
+		results_count += c.m_results.size();
+	}
+	std::vector<RESULT> results;
+	results.reserve(results_count);
+	for (auto& c: chunks) {
+		for (auto& r: c.m_results) results.push_back(std::move(r));
+	}
+	return results;
+}
+
+} // namespace dastd
@@ -0,0 +1,463 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 16-OCT-2026
+*
+* JSON PATHS
+* ^^^^^^^^^^
+* The paths follow the JSON pointer notation (RFC 6901): a sequence of
+* segments, each one preceded by a slash, where `~1` stands for `/` and `~0`
+* for `~`. A segment matches the object member with the same key or, if it
+* is a decimal number, the array element with that index. The empty path
+* refers to the whole document.
+* In addition, the segment `*` matches every member of an object and every
+* element of an array: for example, the path with the segments `items`, `*`
+* and `price` extracts the price of all the items.
+*
+* EXTRACTION
+* ^^^^^^^^^^
+* The document is walked with `json_tokenizer_sourced`, descending only into
+* the objects and the arrays on the way of at least one path: all the other
+* objects and arrays are skipped with `json_tokenizer_sourced::skip_value`,
+* i.e. counting brackets and quotes with no decoding.
+* If no path contains wildcards, the extraction stops as soon as all the
+* paths have been found, without reading the rest of the document.
+**/
+#pragma once
+#include "json_tokenizer.hpp"
+#include "exception.hpp"
+#include "fmt_string.hpp"
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace dastd {
+
+/// @brief Exception thrown by `json_path_extractor`
+DASTD_DEF_EXCEPTION(exception_json_path)
+
+/// @brief Extract the values found at a set of JSON paths
+///
+/// See JSON PATHS and EXTRACTION in the header.
+///
+/// Example:
+///
+///     json_path_extractor<char> extractor;
+///     size_t id_path = extractor.add_path("/meta/id");
+///     size_t price_path = extractor.add_path("/items/*/price");
+///     extractor.extract(source, [&](const json_path_extractor<char>::match& m) {
+///         if (m.m_path_index == id_path) route(m.m_string);
+///         else total += m.m_number.get<double>().first;
+///     });
+///
+/// @tparam CHARTYPE Type of the character
+template<class CHARTYPE>
+class json_path_extractor {
+	public:
+		/// @brief Value found at one of the paths
+		struct match {
+			/// @brief Index of the path, as returned by `add_path`
+			size_t m_path_index = 0;
+
+			/// @brief First token of the value: `C_STRING`, `C_NUMBER`, `C_TRUE`, `C_FALSE`,
+			///        `C_NULL`, `C_BRACE_OPEN` (objects) or `C_BRACKET_OPEN` (arrays)
+			json_tokenizer_ret m_type = json_tokenizer_ret::C_NULL;
+
+			/// @brief Decoded string in UTF-8 (`C_STRING` only)
+			std::string m_string;
+
+			/// @brief Number (`C_NUMBER` only)
+			multinum m_number;
+
+			/// @brief JSON text of the value, as found in the document
+			///
+			/// For objects and arrays, the nested values are not validated;
+			/// the spaces between their tokens might have been removed.
+			string_or_vector<CHARTYPE> m_raw;
+		};
+
+		/// @brief Function receiving the values found
+		///
+		/// The `match` is reused for the following values, so it must be copied
+		/// if needed after the call.
+		using callback_fn = std::function<void(const match& m)>;
+
+	private:
+		/// @brief Segment of a path
+		struct segment {
+			/// @brief Key in UTF-8
+			std::string m_key;
+
+			/// @brief Array index, or SIZE_MAX if the key is not a decimal number
+			size_t m_index = SIZE_MAX;
+
+			/// @brief True for the `*` segment
+			bool m_wildcard = false;
+		};
+
+		/// @brief Path
+		struct path {
+			/// @brief Segments
+			std::vector<segment> m_segments;
+
+			/// @brief True if any segment is `*`
+			bool m_has_wildcards = false;
+		};
+
+		/// @brief Object or array being walked
+		struct frame {
+			/// @brief True for objects, false for arrays
+			bool m_is_object;
+
+			/// @brief Number of segments of the paths matched so far
+			size_t m_depth;
+
+			/// @brief Elements found so far
+			size_t m_items_count;
+
+			/// @brief Begin of the candidates of this container in `m_candidates`
+			///
+			/// The candidates are the paths matching up to this container: first
+			/// the ones ending here, then the ones continuing inside.
+			size_t m_candidates_begin;
+
+			/// @brief Begin of the paths continuing inside this container in `m_candidates`
+			size_t m_deeper_begin;
+
+			/// @brief End of the candidates of this container in `m_candidates`
+			size_t m_candidates_end;
+
+			/// @brief Offset of the container text in `m_capture`, if some paths end here
+			size_t m_capture_begin;
+		};
+
+		/// @brief Value of `frame::m_capture_begin` for the containers not being captured
+		static constexpr size_t NO_CAPTURE = SIZE_MAX;
+
+		/// @brief Paths
+		std::vector<path> m_paths;
+
+		/// @brief Number of paths with wildcards
+		size_t m_wildcard_paths_count = 0;
+
+		/// @brief Stack of the containers being walked
+		std::vector<frame> m_frames;
+
+		/// @brief Indexes of the candidate paths of the containers in `m_frames`
+		std::vector<uint32_t> m_candidates;
+
+		/// @brief For each path, true if it has already been found
+		std::vector<bool> m_found;
+
+		/// @brief Number of paths with no wildcards not found yet
+		size_t m_missing_count = 0;
+
+		/// @brief Text of the objects and the arrays being captured
+		string_or_vector<CHARTYPE> m_capture;
+
+		/// @brief Number of frames being captured
+		size_t m_captures_count = 0;
+
+		/// @brief Key of the current member
+		std::string m_key;
+
+		/// @brief Value passed to the callback
+		match m_match;
+
+		/// @brief Fetch a token, adding it to `m_capture` if a container is being captured
+		json_tokenizer_ret fetch(json_tokenizer_sourced<CHARTYPE>& tokenizer);
+
+		/// @brief Process a value
+		/// @param tokenizer        Tokenizer, whose last token is the first one of the value
+		/// @param depth            Number of segments of the paths matched so far
+		/// @param candidates_begin Begin of the candidate paths in `m_candidates`; they extend to the end
+		/// @param callback         Function receiving the values found
+		/// @return Returns `true` if all the paths have been found and the extraction can stop
+		bool process_value(json_tokenizer_sourced<CHARTYPE>& tokenizer, size_t depth, size_t candidates_begin, const callback_fn& callback);
+
+		/// @brief Pass a value to the callback
+		/// @param path_index Index of the path
+		/// @param callback   Function receiving the values found
+		/// @return Returns `true` if all the paths have been found and the extraction can stop
+		bool deliver(size_t path_index, const callback_fn& callback);
+
+		/// @brief Throw an exception for an unexpected token
+		[[noreturn]] static void throw_unexpected(const json_tokenizer_sourced<CHARTYPE>& tokenizer, const char* expected);
+
+	public:
+		/// @brief Constructor
+		json_path_extractor() {}
+
+		/// @brief Add a path
+		/// @param pointer Path in the JSON pointer notation (see JSON PATHS in the header)
+		/// @return Returns the index of the path, reported in `match::m_path_index`
+		/// @throw Throws `exception_json_path` if the path is not valid
+		size_t add_path(std::string_view pointer);
+
+		/// @brief Return the number of paths
+		size_t get_paths_count() const {return m_paths.size();}
+
+		/// @brief Remove all the paths
+		void clear_paths() {m_paths.clear(); m_wildcard_paths_count = 0;}
+
+		/// @brief Extract the values found at the paths
+		///
+		/// The values are passed to `callback` in the order they end in the
+		/// document, so an object or an array comes after the values found
+		/// inside it. If a path is found more than once (because of duplicated
+		/// keys or wildcards), `callback` is invoked each time, but with no
+		/// wildcard paths the extraction stops as soon as all the paths have
+		/// been found: duplicates are reported only while some path is still missing.
+		///
+		/// @param source   Source containing the document
+		/// @param callback Function receiving the values found
+		/// @throw Throws `exception_json_path` if the document structure is not valid
+		void extract(source_with_peek<CHARTYPE>& source, const callback_fn& callback);
+};
+
+//------------------------------------------------------------------------------
+// (brief) Add a path
+// (param) pointer Path in the JSON pointer notation
+// (return) Returns the index of the path
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+size_t json_path_extractor<CHARTYPE>::add_path(std::string_view pointer)
+{
+	if (m_paths.size() >= UINT32_MAX) DASTD_THROW(exception_json_path, "json_path_extractor: too many paths");
+	if (!pointer.empty() && (pointer[0] != '/')) DASTD_THROW(exception_json_path, "json_path_extractor: the path '" << pointer << "' does not start with '/'");
+
+	path p;
+	size_t pos = 0;
+	while (pos < pointer.length()) {
+		// Skip the slash
+		pos++;
+		size_t end = pointer.find('/', pos);
+		if (end == std::string_view::npos) end = pointer.length();
+
+		segment seg;
+		for (size_t i=pos; i<end; i++) {
+			char ch = pointer[i];
+			if (ch == '~') {
+				char escaped = (i+1 < end ? pointer[i+1] : 0);
+				if (escaped == '0') seg.m_key.push_back('~');
+				else if (escaped == '1') seg.m_key.push_back('/');
+				else DASTD_THROW(exception_json_path, "json_path_extractor: invalid escape in the path '" << pointer << "'");
+				i++;
+			}
+			else {
+				seg.m_key.push_back(ch);
+			}
+		}
+		seg.m_wildcard = (pointer.substr(pos, end-pos) == "*");
+		if (seg.m_wildcard) p.m_has_wildcards = true;
+
+		// Array index: decimal number with no leading zeros
+		bool is_index = !seg.m_key.empty() && (seg.m_key.length() < 20) && ((seg.m_key[0] != '0') || (seg.m_key.length() == 1));
+		for (char ch: seg.m_key) if ((ch < '0') || (ch > '9')) is_index = false;
+		if (is_index) seg.m_index = std::stoull(seg.m_key);
+
+		p.m_segments.push_back(std::move(seg));
+		pos = end;
+	}
+
+	if (p.m_has_wildcards) m_wildcard_paths_count++;
+	m_paths.push_back(std::move(p));
+	return m_paths.size()-1;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Throw an exception for an unexpected token
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_path_extractor<CHARTYPE>::throw_unexpected(const json_tokenizer_sourced<CHARTYPE>& tokenizer, const char* expected)
+{
+	using raw_printer = fmt_string<CHARTYPE,fmt_string_f::C11_ESCAPED_QUOTED>;
+	json_tokenizer_ret ret = tokenizer.get_last_process_ret();
+	if ((ret == json_tokenizer_ret::C_NOTHING_MORE) || (ret == json_tokenizer_ret::C_ERROR && tokenizer.get_raw_token().empty())) DASTD_THROW(exception_json_path, "json_path_extractor: expected " << expected << ", got the end of the document");
+	DASTD_THROW(exception_json_path, "json_path_extractor: expected " << expected << ", got " << ret << " " << raw_printer(tokenizer.get_raw_token()));
+}
+
+//------------------------------------------------------------------------------
+// (brief) Fetch a token, adding it to `m_capture` if a container is being captured
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+json_tokenizer_ret json_path_extractor<CHARTYPE>::fetch(json_tokenizer_sourced<CHARTYPE>& tokenizer)
+{
+	json_tokenizer_ret ret = tokenizer.fetch_token();
+	if (m_captures_count > 0) {
+		const auto& raw = tokenizer.get_raw_token();
+		m_capture.insert(m_capture.end(), raw.begin(), raw.end());
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Pass a value to the callback
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+bool json_path_extractor<CHARTYPE>::deliver(size_t path_index, const callback_fn& callback)
+{
+	m_match.m_path_index = path_index;
+	callback(m_match);
+	if (!m_found[path_index]) {
+		m_found[path_index] = true;
+		if (!m_paths[path_index].m_has_wildcards) m_missing_count--;
+	}
+	return (m_wildcard_paths_count == 0) && (m_missing_count == 0);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Process a value
+// (param) tokenizer        Tokenizer, whose last token is the first one of the value
+// (param) depth            Number of segments of the paths matched so far
+// (param) candidates_begin Begin of the candidate paths in `m_candidates`
+// (param) callback         Function receiving the values found
+// (return) Returns `true` if all the paths have been found
+//
+// The candidates are split in the paths ending at this value and the ones
+// continuing inside it. If the value is an object or an array with paths
+// continuing inside, a frame is pushed and the candidates are left in
+// `m_candidates` until the frame is popped; otherwise they are removed.
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+bool json_path_extractor<CHARTYPE>::process_value(json_tokenizer_sourced<CHARTYPE>& tokenizer, size_t depth, size_t candidates_begin, const callback_fn& callback)
+{
+	auto begin = m_candidates.begin() + (std::ptrdiff_t)candidates_begin;
+	size_t deeper_begin = (size_t)(std::partition(begin, m_candidates.end(), [&](uint32_t p) {return m_paths[p].m_segments.size() == depth;}) - m_candidates.begin());
+	size_t candidates_end = m_candidates.size();
+	bool done = false;
+
+	json_tokenizer_ret ret = tokenizer.get_last_process_ret();
+	switch(ret) {
+		case json_tokenizer_ret::C_STRING:
+		case json_tokenizer_ret::C_NUMBER:
+		case json_tokenizer_ret::C_TRUE:
+		case json_tokenizer_ret::C_FALSE:
+		case json_tokenizer_ret::C_NULL: {
+			if (candidates_begin == deeper_begin) break;
+			m_match.m_type = ret;
+			m_match.m_string.clear();
+			m_match.m_number.clear();
+			if (ret == json_tokenizer_ret::C_STRING) tokenizer.get_string_utf8(m_match.m_string);
+			if (ret == json_tokenizer_ret::C_NUMBER) m_match.m_number = tokenizer.get_multinum();
+			const auto& raw = tokenizer.get_raw_token();
+			m_match.m_raw.assign(raw.begin(), raw.end());
+			for (size_t i=candidates_begin; (i<deeper_begin) && !done; i++) done = deliver(m_candidates[i], callback);
+			break;
+		}
+
+		case json_tokenizer_ret::C_BRACE_OPEN:
+		case json_tokenizer_ret::C_BRACKET_OPEN: {
+			// Capture the text if some paths end here; the opening bracket has
+			// already been added if an enclosing container is being captured
+			size_t capture_begin = NO_CAPTURE;
+			if (candidates_begin < deeper_begin) {
+				if (m_captures_count == 0) {
+					m_capture.clear();
+					m_capture.push_back(tokenizer.get_raw_token()[0]);
+				}
+				capture_begin = m_capture.size()-1;
+				m_captures_count++;
+			}
+
+			// Paths continuing inside: walk the container
+			if (deeper_begin < candidates_end) {
+				m_frames.push_back(frame{ret == json_tokenizer_ret::C_BRACE_OPEN, depth, 0, candidates_begin, deeper_begin, candidates_end, capture_begin});
+				return false;
+			}
+
+			// Otherwise, skip it
+			if (tokenizer.skip_value(m_captures_count > 0 ? &m_capture : nullptr) == json_tokenizer_ret::C_ERROR) throw_unexpected(tokenizer, "a closing bracket");
+			if (capture_begin != NO_CAPTURE) {
+				m_captures_count--;
+				m_match.m_type = ret;
+				m_match.m_string.clear();
+				m_match.m_number.clear();
+				m_match.m_raw.assign(m_capture.begin() + (std::ptrdiff_t)capture_begin, m_capture.end());
+				for (size_t i=candidates_begin; (i<deeper_begin) && !done; i++) done = deliver(m_candidates[i], callback);
+			}
+			break;
+		}
+
+		default: throw_unexpected(tokenizer, "a value");
+	}
+	m_candidates.resize(candidates_begin);
+	return done;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Extract the values found at the paths
+// (param) source   Source containing the document
+// (param) callback Function receiving the values found
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_path_extractor<CHARTYPE>::extract(source_with_peek<CHARTYPE>& source, const callback_fn& callback)
+{
+	m_frames.clear();
+	m_candidates.clear();
+	m_capture.clear();
+	m_captures_count = 0;
+	m_found.assign(m_paths.size(), false);
+	m_missing_count = m_paths.size() - m_wildcard_paths_count;
+	if (m_paths.empty()) return;
+
+	json_tokenizer_sourced<CHARTYPE> tokenizer(source, json_tokenizer_sourced<CHARTYPE>::STRING_VIEWS);
+	if (fetch(tokenizer) == json_tokenizer_ret::C_NOTHING_MORE) return;
+
+	// All the paths are candidates for the root
+	for (size_t i=0; i<m_paths.size(); i++) m_candidates.push_back((uint32_t)i);
+	if (process_value(tokenizer, 0, 0, callback)) return;
+
+	while (!m_frames.empty()) {
+		frame& top = m_frames.back();
+		json_tokenizer_ret ret = fetch(tokenizer);
+
+		// End of the container
+		if ((ret == json_tokenizer_ret::C_BRACE_CLOSE) || (ret == json_tokenizer_ret::C_BRACKET_CLOSE)) {
+			if ((ret == json_tokenizer_ret::C_BRACE_CLOSE) != top.m_is_object) throw_unexpected(tokenizer, (top.m_is_object ? "'}'" : "']'"));
+			if (top.m_capture_begin != NO_CAPTURE) {
+				m_captures_count--;
+				m_match.m_type = (top.m_is_object ? json_tokenizer_ret::C_BRACE_OPEN : json_tokenizer_ret::C_BRACKET_OPEN);
+				m_match.m_string.clear();
+				m_match.m_number.clear();
+				m_match.m_raw.assign(m_capture.begin() + (std::ptrdiff_t)top.m_capture_begin, m_capture.end());
+				for (size_t i=top.m_candidates_begin; i<top.m_deeper_begin; i++) {
+					if (deliver(m_candidates[i], callback)) return;
+				}
+			}
+			m_candidates.resize(top.m_candidates_begin);
+			m_frames.pop_back();
+			continue;
+		}
+
+		if (top.m_items_count > 0) {
+			if (ret != json_tokenizer_ret::C_COMMA) throw_unexpected(tokenizer, "','");
+			ret = fetch(tokenizer);
+		}
+		size_t index = top.m_items_count++;
+
+		// Select the paths matching this element
+		size_t child_begin = m_candidates.size();
+		if (top.m_is_object) {
+			if (ret != json_tokenizer_ret::C_STRING) throw_unexpected(tokenizer, "a key");
+			tokenizer.get_string_utf8(m_key);
+			for (size_t i=top.m_deeper_begin; i<top.m_candidates_end; i++) {
+				const segment& seg = m_paths[m_candidates[i]].m_segments[top.m_depth];
+				if (seg.m_wildcard || (seg.m_key == m_key)) m_candidates.push_back(m_candidates[i]);
+			}
+			if (fetch(tokenizer) != json_tokenizer_ret::C_COLON) throw_unexpected(tokenizer, "':'");
+			fetch(tokenizer);
+		}
+		else {
+			for (size_t i=top.m_deeper_begin; i<top.m_candidates_end; i++) {
+				const segment& seg = m_paths[m_candidates[i]].m_segments[top.m_depth];
+				if (seg.m_wildcard || (seg.m_index == index)) m_candidates.push_back(m_candidates[i]);
+			}
+		}
+
+		// `top` is not valid after this call
+		if (process_value(tokenizer, top.m_depth+1, child_begin, callback)) return;
+	}
+}
+
+} // namespace dastd
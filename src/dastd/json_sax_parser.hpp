@@ -0,0 +1,324 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 16-OCT-2026
+*
+* PUSH PARSING
+* ^^^^^^^^^^^^
+* `json_sax_parser` is fed with the data as it arrives, in chunks of any size,
+* and reports what it finds to a `json_sax_handler` as soon as possible.
+* It does not block nor use threads: everything happens inside `feed`, and
+* the state (the `json_tokenizer` and the stack of the open objects and
+* arrays) is kept in the parser between the calls. This allows parsing on
+* event loop threads, for example in the callback receiving data from a socket.
+*
+* A token is reported when the character following it has been received:
+* in particular, a number at the end of the data is reported only by `finish`.
+* The input can contain multiple documents one after the other, like in
+* the JSON lines format: `json_sax_handler::on_document_end` is called
+* after each one.
+**/
+#pragma once
+#include "json_tokenizer.hpp"
+#include "exception.hpp"
+#include "fmt_string.hpp"
+#include <optional>
+#include <vector>
+
+namespace dastd {
+
+/// @brief Exception thrown by `json_sax_parser`
+DASTD_DEF_EXCEPTION(exception_json_sax)
+
+/// @brief Receiver of the events of `json_sax_parser`
+///
+/// The default implementation of every method does nothing: the derived
+/// classes implement only the events they are interested in.
+/// The methods can throw exceptions, that are propagated by `feed` and `finish`;
+/// like after a syntax error, the parser must then be reset.
+class json_sax_handler {
+	public:
+		/// @brief Destructor
+		virtual ~json_sax_handler() {}
+
+		/// @brief Beginning of an object
+		virtual void on_object_begin() {}
+
+		/// @brief End of an object
+		virtual void on_object_end() {}
+
+		/// @brief Beginning of an array
+		virtual void on_array_begin() {}
+
+		/// @brief End of an array
+		virtual void on_array_end() {}
+
+		/// @brief Key of an object member; its value is reported next
+		/// @param key Key in UTF-8, valid only during the call
+		virtual void on_key(const std::string& key) {DASTD_NOWARN_UNUSED(key);}
+
+		/// @brief String value
+		/// @param value String in UTF-8, valid only during the call
+		virtual void on_string(const std::string& value) {DASTD_NOWARN_UNUSED(value);}
+
+		/// @brief Number value
+		/// @param value Number
+		virtual void on_number(const multinum& value) {DASTD_NOWARN_UNUSED(value);}
+
+		/// @brief `true` or `false`
+		/// @param value Value
+		virtual void on_bool(bool value) {DASTD_NOWARN_UNUSED(value);}
+
+		/// @brief `null`
+		virtual void on_null() {}
+
+		/// @brief End of a document, i.e. of the root value
+		virtual void on_document_end() {}
+};
+
+/// @brief Push-mode JSON parser
+///
+/// See PUSH PARSING in the header.
+///
+/// Example:
+///
+///     my_handler handler;
+///     json_sax_parser<char> parser(handler);
+///     // Every time some data is received
+///     parser.feed(buffer, received);
+///     // When the connection is closed
+///     parser.finish();
+///
+/// @tparam CHARTYPE Type of the character
+template<class CHARTYPE>
+class json_sax_parser {
+	private:
+		/// @brief What is expected next
+		enum class expect_t: uint8_t {
+			/// @brief A value (at the root or after a colon or a comma in an array)
+			VALUE,
+			/// @brief A value or the end of the array (after the opening bracket)
+			VALUE_OR_CLOSE,
+			/// @brief A key (after a comma in an object)
+			KEY,
+			/// @brief A key or the end of the object (after the opening brace)
+			KEY_OR_CLOSE,
+			/// @brief A colon (after a key)
+			COLON,
+			/// @brief A comma or the end of the object or the array (after a value)
+			COMMA_OR_CLOSE,
+		};
+
+		/// @brief Receiver of the events
+		json_sax_handler& m_handler;
+
+		/// @brief Tokenizer; created when the first character is received
+		std::optional<json_tokenizer<CHARTYPE>> m_tokenizer;
+
+		/// @brief What is expected next
+		expect_t m_expect = expect_t::VALUE;
+
+		/// @brief Objects and arrays open; `true` for the objects
+		std::vector<bool> m_stack;
+
+		/// @brief Characters received so far
+		size_t m_offset = 0;
+
+		/// @brief Set after an error
+		bool m_failed = false;
+
+		/// @brief Buffer for the strings in UTF-8
+		std::string m_utf8;
+
+		/// @brief Process a token
+		/// @param ret Token returned by the tokenizer
+		void process_token(json_tokenizer_ret ret);
+
+		/// @brief Process a token; any exception, including those thrown by the
+		///        handler, leaves the parser in the failed state
+		/// @param ret Token returned by the tokenizer
+		void process_token_or_fail(json_tokenizer_ret ret) {
+			try {process_token(ret);}
+			catch(...) {m_failed = true; throw;}
+		}
+
+		/// @brief Throw an exception, leaving the parser in the failed state
+		[[noreturn]] void fail(const char* expected);
+
+	public:
+		/// @brief Constructor
+		/// @param handler Receiver of the events; it must stay available while the parser is used
+		json_sax_parser(json_sax_handler& handler): m_handler(handler) {}
+
+		/// @brief Process a chunk of data
+		///
+		/// The events for the tokens completed by the chunk are reported
+		/// before returning.
+		///
+		/// @param data Characters received
+		/// @param length Number of characters
+		/// @throw Throws `exception_json_sax` in case of syntax errors
+		void feed(const CHARTYPE* data, size_t length);
+
+		/// @brief Signal that there is no more data
+		///
+		/// The pending token, if any, is reported.
+		///
+		/// @throw Throws `exception_json_sax` if the data ends in the middle of a document,
+		///     including inside a string or a comment following a complete document
+		void finish();
+
+		/// @brief Reset the parser, to parse new data or to recover after an error
+		void reset() {m_tokenizer.reset(); m_expect = expect_t::VALUE; m_stack.clear(); m_offset = 0; m_failed = false;}
+
+		/// @brief Return the number of characters received so far
+		size_t get_offset() const {return m_offset;}
+
+		/// @brief Return the nesting level: zero between the documents
+		size_t get_depth() const {return m_stack.size();}
+};
+
+//------------------------------------------------------------------------------
+// (brief) Process a chunk of data
+// (param) data Characters received
+// (param) length Number of characters
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_sax_parser<CHARTYPE>::feed(const CHARTYPE* data, size_t length)
+{
+	if (m_failed) DASTD_THROW(exception_json_sax, "json_sax_parser: feed after an error; call reset");
+	if (length == 0) return;
+
+	// The tokenizer needs the first character when created
+	size_t i = 0;
+	if (!m_tokenizer) {
+		m_tokenizer.emplace(data[0], 0);
+		m_offset++;
+		i++;
+	}
+	for (; i<length; i++) {
+		json_tokenizer_ret ret = m_tokenizer->process_char(data[i]);
+		if ((ret != json_tokenizer_ret::C_NEED_MORE_CHARS) && (ret != json_tokenizer_ret::C_SPACE)) process_token_or_fail(ret);
+		m_offset++;
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Signal that there is no more data
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_sax_parser<CHARTYPE>::finish()
+{
+	if (m_failed) DASTD_THROW(exception_json_sax, "json_sax_parser: finish after an error; call reset");
+	if (m_tokenizer) {
+		// The tokenizer returns the pending token, then C_NOTHING_MORE;
+		// C_NEED_MORE_CHARS means that the data ends inside a string or a comment
+		for(;;) {
+			json_tokenizer_ret ret = m_tokenizer->process_eof();
+			if (ret == json_tokenizer_ret::C_NOTHING_MORE) break;
+			if (ret == json_tokenizer_ret::C_NEED_MORE_CHARS) fail("the end of the document");
+			if (ret != json_tokenizer_ret::C_SPACE) process_token_or_fail(ret);
+		}
+	}
+	if (!m_stack.empty() || (m_expect != expect_t::VALUE)) fail("the end of the document");
+}
+
+//------------------------------------------------------------------------------
+// (brief) Throw an exception, leaving the parser in the failed state
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_sax_parser<CHARTYPE>::fail(const char* expected)
+{
+	using raw_printer = fmt_string<CHARTYPE,fmt_string_f::C11_ESCAPED_QUOTED>;
+	m_failed = true;
+	json_tokenizer_ret ret = (m_tokenizer ? m_tokenizer->get_last_process_ret() : json_tokenizer_ret::C_NOTHING_MORE);
+	if ((ret == json_tokenizer_ret::C_NOTHING_MORE) || (ret == json_tokenizer_ret::C_NEED_MORE_CHARS)) {
+		DASTD_THROW(exception_json_sax, "json_sax_parser: unexpected end of the data at offset " << m_offset << ", expected " << expected);
+	}
+	DASTD_THROW(exception_json_sax, "json_sax_parser: unexpected " << ret << " " << raw_printer(m_tokenizer->get_raw_token()) << " at offset " << m_offset << ", expected " << expected);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Process a token
+// (param) ret Token returned by the tokenizer
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+void json_sax_parser<CHARTYPE>::process_token(json_tokenizer_ret ret)
+{
+	switch(m_expect) {
+		case expect_t::COLON: {
+			if (ret != json_tokenizer_ret::C_COLON) fail("':'");
+			m_expect = expect_t::VALUE;
+			return;
+		}
+
+		case expect_t::KEY:
+		case expect_t::KEY_OR_CLOSE: {
+			if (ret == json_tokenizer_ret::C_STRING) {
+				m_tokenizer->get_string_utf8(m_utf8);
+				m_expect = expect_t::COLON;
+				m_handler.on_key(m_utf8);
+				return;
+			}
+			if ((m_expect == expect_t::KEY) || (ret != json_tokenizer_ret::C_BRACE_CLOSE)) fail("a key");
+			break;
+		}
+
+		case expect_t::COMMA_OR_CLOSE: {
+			if (ret == json_tokenizer_ret::C_COMMA) {
+				m_expect = (m_stack.back() ? expect_t::KEY : expect_t::VALUE);
+				return;
+			}
+			if ((ret != json_tokenizer_ret::C_BRACE_CLOSE) && (ret != json_tokenizer_ret::C_BRACKET_CLOSE)) fail("',' or a closing bracket");
+			break;
+		}
+
+		case expect_t::VALUE_OR_CLOSE: {
+			if (ret == json_tokenizer_ret::C_BRACKET_CLOSE) break;
+			[[fallthrough]];
+		}
+
+		case expect_t::VALUE: {
+			// A value completes the container or the document
+			expect_t after_value = (m_stack.empty() ? expect_t::VALUE : expect_t::COMMA_OR_CLOSE);
+			switch(ret) {
+				case json_tokenizer_ret::C_BRACE_OPEN: {
+					m_stack.push_back(true);
+					m_expect = expect_t::KEY_OR_CLOSE;
+					m_handler.on_object_begin();
+					return;
+				}
+				case json_tokenizer_ret::C_BRACKET_OPEN: {
+					m_stack.push_back(false);
+					m_expect = expect_t::VALUE_OR_CLOSE;
+					m_handler.on_array_begin();
+					return;
+				}
+				case json_tokenizer_ret::C_STRING: {
+					m_tokenizer->get_string_utf8(m_utf8);
+					m_expect = after_value;
+					m_handler.on_string(m_utf8);
+					break;
+				}
+				case json_tokenizer_ret::C_NUMBER: m_expect = after_value; m_handler.on_number(m_tokenizer->get_multinum()); break;
+				case json_tokenizer_ret::C_TRUE: m_expect = after_value; m_handler.on_bool(true); break;
+				case json_tokenizer_ret::C_FALSE: m_expect = after_value; m_handler.on_bool(false); break;
+				case json_tokenizer_ret::C_NULL: m_expect = after_value; m_handler.on_null(); break;
+				default: fail("a value");
+			}
+			if (m_stack.empty()) m_handler.on_document_end();
+			return;
+		}
+	}
+
+	// Closing bracket, matching `m_expect`
+	bool is_object = (ret == json_tokenizer_ret::C_BRACE_CLOSE);
+	if (is_object != m_stack.back()) fail(m_stack.back() ? "'}'" : "']'");
+	m_stack.pop_back();
+	m_expect = (m_stack.empty() ? expect_t::VALUE : expect_t::COMMA_OR_CLOSE);
+	if (is_object) m_handler.on_object_end();
+	else m_handler.on_array_end();
+	if (m_stack.empty()) m_handler.on_document_end();
+}
+
+} // namespace dastd
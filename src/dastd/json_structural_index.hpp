@@ -0,0 +1,359 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+*
+* STRUCTURAL INDEX
+* ^^^^^^^^^^^^^^^^
+* `json_structural_index` scans a JSON document entirely available in memory
+* and records the positions of:
+*
+* - the double quotes opening and closing the strings (escaped ones excluded);
+* - the characters `{`, `}`, `[`, `]`, `:` and `,` outside the strings;
+* - the first character of the unquoted tokens (numbers, `true`, `false`, `null`
+*   and any other unexpected sequence) outside the strings.
+*
+* All the other characters outside the strings are spaces (` `, `\t`, `\r`
+* and `\n`), so `json_tokenizer_sourced` can jump from one position to the
+* next one and, for the strings, it knows the closing double quote in advance.
+*
+* The document is processed in blocks of 64 characters: each block is
+* classified with SSE2 or AVX2 instructions when available (the best one
+* is detected at runtime) or with plain C++ otherwise; the resulting bit
+* masks are then combined to find the escaped characters and the content
+* of the strings with no branches.
+*
+* The index does not validate the document: that is still done by the
+* tokenizer. The only exception are comments (see `json_tokenizer`): if a
+* `/` or a `#` is detected outside the strings, the index is not built and
+* the tokenizer processes the whole document character by character.
+**/
+#pragma once
+#include "defs.hpp"
+#include <bit>
+#include <vector>
+
+#if defined __x86_64__ && defined __GNUC__
+	#define DASTD_JSON_INDEX_X86
+	#include <immintrin.h>
+#endif
+
+namespace dastd {
+
+/// @brief Implementation used to classify the characters
+enum class json_structural_index_impl {
+	/// @brief Best implementation available on this CPU
+	AUTO,
+
+	/// @brief Plain C++
+	SCALAR,
+
+	/// @brief SSE2 instructions, 16 characters at a time
+	SSE2,
+
+	/// @brief AVX2 instructions, 32 characters at a time
+	AVX2,
+};
+
+/// @brief Positions of the structural characters of a JSON document in memory
+///
+/// See STRUCTURAL INDEX in the header.
+class json_structural_index {
+	public:
+		/// @brief Returned by `next_position` when there are no more positions
+		static constexpr size_t npos = SIZE_MAX;
+
+		/// @brief Number of characters processed at a time
+		static constexpr size_t BLOCK_SIZE = 64;
+
+	private:
+		/// @brief Bit masks of one block; bit N refers to the N-th character
+		struct block_masks {
+			/// @brief Double quotes
+			uint64_t quote = 0;
+
+			/// @brief Backslashes
+			uint64_t backslash = 0;
+
+			/// @brief Spaces
+			uint64_t space = 0;
+
+			/// @brief Characters `{`, `}`, `[`, `]`, `:` and `,`
+			uint64_t op = 0;
+
+			/// @brief Characters starting a comment: `/` and `#`
+			uint64_t comment = 0;
+		};
+
+		/// @brief Function classifying one block
+		using classify_fn = void(*)(const char* block, block_masks& masks);
+
+		/// @brief Indexed document
+		const char* m_data = nullptr;
+
+		/// @brief Size of the indexed document
+		size_t m_size = 0;
+
+		/// @brief Positions, in increasing order
+		std::vector<uint32_t> m_positions;
+
+		/// @brief True if the index has been built successfully
+		bool m_valid = false;
+
+		/// @brief Implementation used by the last `build`
+		json_structural_index_impl m_impl = json_structural_index_impl::SCALAR;
+
+		/// @brief Classify one block with plain C++
+		static void classify_scalar(const char* block, block_masks& masks);
+
+		#ifdef DASTD_JSON_INDEX_X86
+		/// @brief Classify one block with SSE2 instructions
+		static void classify_sse2(const char* block, block_masks& masks);
+
+		/// @brief Classify one block with AVX2 instructions
+		static void classify_avx2(const char* block, block_masks& masks);
+		#endif
+
+		/// @brief Compute the characters escaped by a backslash
+		/// @param backslash     Backslashes in the block
+		/// @param prev_escaped  In input, 1 if the first character of the block is escaped;
+		///                      in output, 1 if the first character of the next block is escaped
+		/// @return Returns the mask of the escaped characters
+		static uint64_t find_escaped(uint64_t backslash, uint64_t& prev_escaped);
+
+		/// @brief Compute the prefix XOR of the bits (bit N is the XOR of bits 0..N)
+		static uint64_t prefix_xor(uint64_t bits);
+
+	public:
+		/// @brief Build the index
+		///
+		/// The document must stay in memory, unchanged, as long as the index is used.
+		///
+		/// @param data Document
+		/// @param size Size of the document; it must be less than 4 GiB
+		/// @param impl Implementation to be used; if not available, the scalar one is used
+		/// @return Returns `false` if the document contains comments or it is too big;
+		///         in that case the index is not valid and it must not be used
+		bool build(const char* data, size_t size, json_structural_index_impl impl=json_structural_index_impl::AUTO);
+
+		/// @brief Clear the index
+		void clear() {m_data=nullptr; m_size=0; m_positions.clear(); m_valid=false;}
+
+		/// @brief Return `true` if the index has been built successfully
+		bool valid() const {return m_valid;}
+
+		/// @brief Indexed document
+		const char* data() const {return m_data;}
+
+		/// @brief Size of the indexed document
+		size_t size() const {return m_size;}
+
+		/// @brief Positions of the structural characters, in increasing order
+		const std::vector<uint32_t>& positions() const {return m_positions;}
+
+		/// @brief Implementation used to build the index
+		json_structural_index_impl get_impl() const {return m_impl;}
+
+		/// @brief Return the best implementation available on this CPU
+		static json_structural_index_impl best_impl();
+
+		/// @brief Return the first position following `offset`
+		///
+		/// It is meant to be called with increasing offsets: `cursor` keeps track
+		/// of the position reached so far and it must be zero on the first call.
+		///
+		/// @param offset Offset in the document
+		/// @param cursor Index in `positions` from which the search starts; it is updated
+		/// @return Returns the position or `npos` if there are no positions after `offset`
+		size_t next_position(size_t offset, size_t& cursor) const {
+			while ((cursor < m_positions.size()) && (m_positions[cursor] <= offset)) cursor++;
+			return (cursor < m_positions.size() ? m_positions[cursor] : npos);
+		}
+};
+
+//------------------------------------------------------------------------------
+// (brief) Return the best implementation available on this CPU
+//------------------------------------------------------------------------------
+inline json_structural_index_impl json_structural_index::best_impl()
+{
+	#ifdef DASTD_JSON_INDEX_X86
+	static const json_structural_index_impl best = (__builtin_cpu_supports("avx2") ? json_structural_index_impl::AVX2 : json_structural_index_impl::SSE2);
+	return best;
+	#else
+	return json_structural_index_impl::SCALAR;
+	#endif
+}
+
+//------------------------------------------------------------------------------
+// (brief) Classify one block with plain C++
+//------------------------------------------------------------------------------
+inline void json_structural_index::classify_scalar(const char* block, block_masks& masks)
+{
+	masks = block_masks();
+	for (size_t i=0; i<BLOCK_SIZE; i++) {
+		uint64_t bit = ((uint64_t)1) << i;
+		switch(block[i]) {
+			case '"': masks.quote |= bit; break;
+			case '\\': masks.backslash |= bit; break;
+			case ' ': case '\t': case '\r': case '\n': masks.space |= bit; break;
+			case '{': case '}': case '[': case ']': case ':': case ',': masks.op |= bit; break;
+			case '/': case '#': masks.comment |= bit; break;
+		}
+	}
+}
+
+#ifdef DASTD_JSON_INDEX_X86
+//------------------------------------------------------------------------------
+// (brief) Classify one block with SSE2 instructions
+//------------------------------------------------------------------------------
+inline void json_structural_index::classify_sse2(const char* block, block_masks& masks)
+{
+	masks = block_masks();
+	for (size_t i=0; i<BLOCK_SIZE; i+=16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(block+i));
+		auto eq = [v](char ch) {return _mm_cmpeq_epi8(v, _mm_set1_epi8(ch));};
+		auto bits = [](__m128i m) {return ((uint64_t)(uint32_t)_mm_movemask_epi8(m));};
+		masks.quote |= bits(eq('"')) << i;
+		masks.backslash |= bits(eq('\\')) << i;
+		masks.space |= bits(_mm_or_si128(_mm_or_si128(eq(' '), eq('\t')), _mm_or_si128(eq('\r'), eq('\n')))) << i;
+		masks.op |= bits(_mm_or_si128(_mm_or_si128(_mm_or_si128(eq('{'), eq('}')), _mm_or_si128(eq('['), eq(']'))), _mm_or_si128(eq(':'), eq(',')))) << i;
+		masks.comment |= bits(_mm_or_si128(eq('/'), eq('#'))) << i;
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Classify one block with AVX2 instructions
+//------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+inline void json_structural_index::classify_avx2(const char* block, block_masks& masks)
+{
+	masks = block_masks();
+	for (size_t i=0; i<BLOCK_SIZE; i+=32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(block+i));
+		// Macros instead of lambdas: lambdas would not inherit the target attribute
+		#define DASTD_JSON_INDEX_EQ(ch) _mm256_cmpeq_epi8(v, _mm256_set1_epi8(ch))
+		#define DASTD_JSON_INDEX_BITS(m) (((uint64_t)(uint32_t)_mm256_movemask_epi8(m)) << i)
+		masks.quote |= DASTD_JSON_INDEX_BITS(DASTD_JSON_INDEX_EQ('"'));
+		masks.backslash |= DASTD_JSON_INDEX_BITS(DASTD_JSON_INDEX_EQ('\\'));
+		masks.space |= DASTD_JSON_INDEX_BITS(_mm256_or_si256(_mm256_or_si256(DASTD_JSON_INDEX_EQ(' '), DASTD_JSON_INDEX_EQ('\t')), _mm256_or_si256(DASTD_JSON_INDEX_EQ('\r'), DASTD_JSON_INDEX_EQ('\n'))));
+		masks.op |= DASTD_JSON_INDEX_BITS(_mm256_or_si256(_mm256_or_si256(_mm256_or_si256(DASTD_JSON_INDEX_EQ('{'), DASTD_JSON_INDEX_EQ('}')), _mm256_or_si256(DASTD_JSON_INDEX_EQ('['), DASTD_JSON_INDEX_EQ(']'))), _mm256_or_si256(DASTD_JSON_INDEX_EQ(':'), DASTD_JSON_INDEX_EQ(','))));
+		masks.comment |= DASTD_JSON_INDEX_BITS(_mm256_or_si256(DASTD_JSON_INDEX_EQ('/'), DASTD_JSON_INDEX_EQ('#')));
+		#undef DASTD_JSON_INDEX_EQ
+		#undef DASTD_JSON_INDEX_BITS
+	}
+}
+#endif
+
+//------------------------------------------------------------------------------
+// (brief) Compute the characters escaped by a backslash
+//
+// A backslash escapes the following character unless it is escaped itself:
+// in a sequence of backslashes, the ones in odd position (counting from the
+// first one) are escapes. The sequences are identified with a subtraction,
+// whose borrow runs along the sequence and stops at its end.
+//------------------------------------------------------------------------------
+inline uint64_t json_structural_index::find_escaped(uint64_t backslash, uint64_t& prev_escaped)
+{
+	constexpr uint64_t ODD_BITS = 0xAAAAAAAAAAAAAAAAULL;
+	if (backslash == 0) {
+		uint64_t escaped = prev_escaped;
+		prev_escaped = 0;
+		return escaped;
+	}
+	// A backslash escaped by the previous block is not an escape
+	uint64_t potential_escape = backslash & ~prev_escaped;
+	uint64_t maybe_escaped = potential_escape << 1;
+	uint64_t escape_and_terminal_code = ((maybe_escaped | ODD_BITS) - potential_escape) ^ ODD_BITS;
+	uint64_t escaped = escape_and_terminal_code ^ (backslash | prev_escaped);
+	uint64_t escape = escape_and_terminal_code & backslash;
+	prev_escaped = escape >> 63;
+	return escaped;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Compute the prefix XOR of the bits (bit N is the XOR of bits 0..N)
+//------------------------------------------------------------------------------
+inline uint64_t json_structural_index::prefix_xor(uint64_t bits)
+{
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Build the index
+// (param) data Document
+// (param) size Size of the document; it must be less than 4 GiB
+// (param) impl Implementation to be used
+// (return) Returns `false` if the document contains comments or it is too big
+//------------------------------------------------------------------------------
+inline bool json_structural_index::build(const char* data, size_t size, json_structural_index_impl impl)
+{
+	clear();
+	if (size >= UINT32_MAX) return false;
+
+	if (impl == json_structural_index_impl::AUTO) impl = best_impl();
+	classify_fn classify = &classify_scalar;
+	m_impl = json_structural_index_impl::SCALAR;
+	#ifdef DASTD_JSON_INDEX_X86
+	if ((impl == json_structural_index_impl::AVX2) && __builtin_cpu_supports("avx2")) {classify = &classify_avx2; m_impl = impl;}
+	else if (impl != json_structural_index_impl::SCALAR) {classify = &classify_sse2; m_impl = json_structural_index_impl::SSE2;}
+	#endif
+
+	// Status carried from one block to the next one
+	uint64_t prev_escaped = 0;   // 1 if the first character is escaped
+	uint64_t prev_in_string = 0; // All ones if the first character is inside a string
+	uint64_t prev_scalar = 0;    // 1 if the last character was part of an unquoted token
+
+	block_masks masks;
+	char tail[BLOCK_SIZE];
+	size_t used = 0;
+	for (size_t offset=0; offset<size; offset+=BLOCK_SIZE) {
+		// The last block is padded with spaces
+		const char* block = data+offset;
+		if (size-offset < BLOCK_SIZE) {
+			memset(tail, ' ', BLOCK_SIZE);
+			memcpy(tail, block, size-offset);
+			block = tail;
+		}
+		classify(block, masks);
+
+		// The content of the strings includes the opening double quote but not the closing one
+		uint64_t quote = masks.quote & ~find_escaped(masks.backslash, prev_escaped);
+		uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+		prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+
+		// Comments are not supported
+		if ((masks.comment & ~in_string) != 0) {
+			clear();
+			return false;
+		}
+
+		// Unquoted tokens: only their first character is recorded
+		uint64_t scalar = ~(masks.space | masks.op | quote | in_string);
+		uint64_t scalar_begin = scalar & ~((scalar << 1) | prev_scalar);
+		prev_scalar = scalar >> 63;
+
+		// The vector is grown in advance so that the positions can be written with no checks
+		if (used + BLOCK_SIZE > m_positions.size()) m_positions.resize(std::max(2*m_positions.size(), used + BLOCK_SIZE));
+		uint32_t* out = m_positions.data() + used;
+		uint64_t bits = quote | (masks.op & ~in_string) | scalar_begin;
+		used += (size_t)std::popcount(bits);
+		while (bits != 0) {
+			*out++ = (uint32_t)(offset + (size_t)std::countr_zero(bits));
+			bits &= bits-1;
+		}
+	}
+	m_positions.resize(used);
+
+	m_data = data;
+	m_size = size;
+	m_valid = true;
+	return true;
+}
+
+} // namespace dastd
@@ -18,6 +18,27 @@
 * From now on, every time we call `process_char(ch)` we must consume the previous char
 * and peek `ch` without consuming it. If the call returns that it is done, `ch` has
 * not been used and must remain in the stream for further consumption.
+*
+*
+* STRING VIEWS
+* ^^^^^^^^^^^^
+* With the `STRING_VIEWS` flag, `json_tokenizer_sourced` scans the strings
+* directly in the memory exposed by the source (see `source::tentative_window`).
+* If a string has no escapes, the token is returned as a pointer into the
+* source data (`get_string_view`) and nothing is copied: the decoded string
+* (`get_string`) and the raw token (`get_raw_token`) are built only if
+* requested. The strings containing escapes or not entirely available in
+* memory are processed character by character as usual.
+* The same applies to the numbers: they are parsed by `multinum` directly
+* from the source data and their text is available as a view as well.
+*
+* STRUCTURAL INDEX
+* ^^^^^^^^^^^^^^^^
+* For `char` documents entirely available in memory, `json_tokenizer_sourced`
+* can walk a `json_structural_index` (see `set_structural_index`): the spaces
+* between the tokens are skipped with no examination and, with `STRING_VIEWS`,
+* the strings with no escapes are returned without scanning them.
+* Everything else is processed as usual, so the tokens returned are the same.
 **/
 #pragma once
 #include "defs.hpp"
@@ -26,6 +47,7 @@
 #include "char32string.hpp"
 #include "strtointegral.hpp"
 #include "multinum.hpp"
+#include "json_structural_index.hpp"
 #include "utf16.hpp"
 
 namespace dastd {
@@ -90,12 +112,26 @@ class json_tokenizer_base {
 		///
 		/// For example, in case of a string, contains everything from the initial
 		/// double quote to the final one included.
-		RAWSTRING m_raw_token;
+		/// It is filled lazily for the strings returned as views.
+		mutable RAWSTRING m_raw_token;
 
 		/// @brief Decoded string (escapes resolved, double quotes removed, etc.)
 		///
 		/// It contains the token that has been matched in case
-		char32string m_string;
+		/// It is filled lazily for the strings returned as views.
+		mutable char32string m_string;
+
+		/// @brief Content of the last string or number, if returned as a view (see `STRING_VIEWS`)
+		const CHARTYPE* m_view = nullptr;
+
+		/// @brief Number of characters in `m_view`
+		size_t m_view_length = 0;
+
+		/// @brief True if `m_view` is valid and `m_string` and `m_raw_token` have not been filled yet
+		mutable bool m_view_pending = false;
+
+		/// @brief Fill `m_string` and `m_raw_token` from `m_view`
+		void fill_from_view() const;
 
 		/// @brief The string can be converted to a number
 		///
@@ -222,7 +258,14 @@ class json_tokenizer_base {
 		static bool is_valid_number_char(char32_t ch32) {return (((ch32 >= '0') && (ch32 <= '9')) || (ch32 == 'E') || (ch32 == 'e') || (ch32 == '+') || (ch32 == '-') || (ch32 == '.'));}
 
 		/// @brief Clear all the public data
-		void clear() {m_raw_token.clear(); m_string.clear(); m_multinum.clear(); m_string_can_converted_to_number=DASTD_ISSET(m_flags, NUMBERS_IN_STRINGS);}
+		void clear() {m_raw_token.clear(); m_string.clear(); m_multinum.clear(); m_view_pending=false; m_view=nullptr; m_string_can_converted_to_number=DASTD_ISSET(m_flags, NUMBERS_IN_STRINGS);}
+
+		/// @brief Combine UTF-16 surrogates
+		/// @param str String whose last character might be the first surrogate
+		/// @param ch32 Character to be added
+		/// @return Returns `true` if `ch32` was the second surrogate and it has been combined
+		///         with the last character of `str`
+		static bool combine_utf16_surrogates(char32string& str, char32_t ch32);
 
 		/// @brief Add a character to m_string when parsing string
 		/// @param ch32 The character to be added
@@ -249,6 +292,83 @@ class json_tokenizer_base {
         /// Used by derived classes that can not do it in the constructor
         void set_first_char(CHARTYPE first_char) {m_prev_char = first_char;}
 
+		/// @brief Tells whether the next character will start a string that can be returned as a view
+		bool can_process_string_view() const {
+			return (m_state == state_t::IDLING) && ((m_flags & (STRING_VIEWS | NUMBERS_IN_STRINGS)) == STRING_VIEWS) && (cast_to_unsigned<char32_t>(m_prev_char) == '"');
+		}
+
+		/// @brief Process a whole string available in memory returning it as a view
+		///
+		/// It must be invoked only if `can_process_string_view` returns `true`,
+		/// i.e. the current character is the opening double quote.
+		/// The characters at `chars` must stay valid until the next call
+		/// to `internal_process_char`.
+		///
+		/// @param chars Characters following the opening double quote
+		/// @param count Number of characters available at `chars`
+		/// @return Returns the number of characters used, closing double quote included,
+		///         after which the token `C_STRING` is ready; the character following the
+		///         closing double quote must be available in `chars` and it becomes the
+		///         current character. Returns zero with no side effects if the string
+		///         contains escapes or it is not entirely available.
+		size_t internal_process_string_view(const CHARTYPE* chars, size_t count);
+
+		/// @brief Return as a view a string whose closing double quote is known
+		///
+		/// It must be invoked only if `can_process_string_view` returns `true` and
+		/// the string has no escapes.
+		///
+		/// @param chars  Characters following the opening double quote
+		/// @param length Length of the string; `chars[length]` is the closing double quote and
+		///               `chars[length+1]` must be available
+		/// @return Returns the number of characters used, closing double quote included
+		size_t internal_set_string_view(const CHARTYPE* chars, size_t length);
+
+		/// @brief Tells whether the current character is a space between two tokens
+		bool can_skip_space() const {
+			if (m_state != state_t::IDLING) return false;
+			char32_t ch32 = cast_to_unsigned<char32_t>(m_prev_char);
+			return (ch32 == ' ') || (ch32 == '\t') || (ch32 == '\r') || (ch32 == '\n');
+		}
+
+		/// @brief Tells whether the current character starts a number that can be returned as a view
+		bool can_process_number_view() const {
+			if ((m_state != state_t::IDLING) || !DASTD_ISSET(m_flags, STRING_VIEWS)) return false;
+			char32_t ch32 = cast_to_unsigned<char32_t>(m_prev_char);
+			return ((ch32 >= '0') && (ch32 <= '9')) || (ch32 == '-');
+		}
+
+		/// @brief Process a whole number available in memory parsing it in place
+		///
+		/// It must be invoked only if `can_process_number_view` returns `true`.
+		/// The characters at `chars` must stay valid until the next call
+		/// to `internal_process_char`.
+		///
+		/// @param chars Characters of the number, starting with the current character
+		/// @param count Number of characters available at `chars`
+		/// @return Returns the number of characters used, after which the token `C_NUMBER`
+		///         is ready; the character following the number must be available in
+		///         `chars` and it becomes the current character. Returns zero if the
+		///         number is not entirely available or it is not valid: in that case
+		///         it must be processed character by character.
+		size_t internal_process_number_view(const CHARTYPE* chars, size_t count);
+
+		/// @brief Tells whether the last token opened an object or an array that can be skipped
+		bool can_skip_value() const {
+			return (m_last_process_ret == json_tokenizer_ret::C_BRACE_OPEN) || (m_last_process_ret == json_tokenizer_ret::C_BRACKET_OPEN);
+		}
+
+		/// @brief Complete the skip of an object or an array performed by the derived class
+		/// @param closing Closing bracket, that becomes the last token
+		/// @param next    Character following the closing bracket, that becomes the current
+		///                character, or `nullptr` if there are no more characters
+		/// @return Returns the last token
+		json_tokenizer_ret internal_end_skip(CHARTYPE closing, const CHARTYPE* next);
+
+		/// @brief Fail the skip of an object or an array because there are no more characters
+		/// @return Returns `C_ERROR`
+		json_tokenizer_ret internal_fail_skip() {clear(); m_state = state_t::REACHED_EOF; m_last_process_ret = json_tokenizer_ret::C_ERROR; return m_last_process_ret;}
+
 	public:
 		//--------------------------------------------------------
 		// FLAGS
@@ -261,6 +381,11 @@ class json_tokenizer_base {
 		/// In that case it will return `C_STRING_AND_NUMBER`.
 		static constexpr uint32_t NUMBERS_IN_STRINGS = 1;
 
+		/// @brief Return the strings with no escapes as views on the source data
+		///
+		/// See STRING VIEWS in the header. It is ignored if `NUMBERS_IN_STRINGS` is set.
+		static constexpr uint32_t STRING_VIEWS = 2;
+
 		//--------------------------------------------------------
 		// UPDATE ACCESS SECTION
 		//--------------------------------------------------------
@@ -277,10 +402,32 @@ class json_tokenizer_base {
 		json_tokenizer_ret get_last_process_ret() const {return m_last_process_ret;}
 
 		/// @brief Get the raw token parsed so far
-		const RAWSTRING& get_raw_token() const {return m_raw_token;}
+		const RAWSTRING& get_raw_token() const {if (m_view_pending) fill_from_view(); return m_raw_token;}
 
 		/// @brief Get the string (valid only in case it returned C_STRING)
-		const char32string& get_string() const {return m_string;}
+		const char32string& get_string() const {if (m_view_pending) fill_from_view(); return m_string;}
+
+		/// @brief Get the number of characters of the string (valid only in case it returned C_STRING)
+		size_t get_string_length() const {return (m_view_pending ? m_view_length : m_string.length());}
+
+		/// @brief Get the string as a view on the source data (see `STRING_VIEWS`)
+		///
+		/// The view is valid until the next token is fetched. Each character
+		/// corresponds to one character of `get_string`; in case of `C_NUMBER`,
+		/// it contains the text of the number.
+		///
+		/// @param length Receives the number of characters in the string
+		/// @return Returns the pointer to the characters or `nullptr` if the last
+		///         token has not been returned as a view; use `get_string` in that case
+		const CHARTYPE* get_string_view(size_t& length) const {length = m_view_length; return m_view;}
+
+		/// @brief Get the string (valid only in case it returned C_STRING) in UTF-8
+		///
+		/// For the strings returned as views, made of ASCII characters
+		/// only, the conversion does not go through `get_string`.
+		///
+		/// @param utf8 Receives the string
+		void get_string_utf8(std::string& utf8) const;
 
 		/// @brief Get the number value, valid in case of C_NUMBER
 		const multinum& get_multinum() const {return m_multinum;}
@@ -307,7 +454,8 @@ class json_tokenizer: public json_tokenizer_base<CHARTYPE,RAWSTRING> {
 		json_tokenizer_ret process_char(CHARTYPE ch) {return json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_char(ch);}
 
 		/// @brief Call when there are no more characters to feed
-		/// @return Returns the result of this step
+		/// @return Returns the result of this step; it is `C_ERROR` if the data
+		///     ends inside a string or a slash-star comment
 		json_tokenizer_ret process_eof() {return json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_eof();}
 };
 
@@ -318,6 +466,59 @@ class json_tokenizer_sourced: public json_tokenizer_base<CHARTYPE,RAWSTRING> {
 		/// @brief Source used to fetch characters
 		source_with_peek<CHARTYPE>& m_source;
 
+		/// @brief Structural index of the data exposed by the source (see `set_structural_index`)
+		const json_structural_index* m_index = nullptr;
+
+		/// @brief Cursor used to walk `m_index`
+		size_t m_index_cursor = 0;
+
+		/// @brief What `skip_value` is scanning
+		enum class skip_mode_t: uint8_t {
+			/// @brief Between the tokens
+			VALUE,
+			/// @brief Inside a string
+			STRING,
+			/// @brief Inside a string, after a backslash
+			STRING_ESCAPE,
+			/// @brief After a slash that might start a comment
+			SLASH,
+			/// @brief Inside a slash-slash or hash comment
+			COMMENT_LINE,
+			/// @brief Inside a slash-star comment
+			COMMENT_BLOCK,
+			/// @brief Inside a slash-star comment, after a star
+			COMMENT_BLOCK_STAR,
+		};
+
+		/// @brief State of `skip_value`, kept across the windows of the source
+		struct skip_state {
+			/// @brief Brackets still open
+			size_t m_depth = 1;
+
+			/// @brief What is being scanned
+			skip_mode_t m_mode = skip_mode_t::VALUE;
+		};
+
+		/// @brief Scan the characters skipped by `skip_value`
+		/// @param chars Characters to be scanned
+		/// @param count Number of characters
+		/// @param state State of the scan, updated
+		/// @return Returns the number of characters scanned: if `state.m_depth` has
+		///         become zero, the last one is the closing bracket
+		static size_t skip_scan(const CHARTYPE* chars, size_t count, skip_state& state);
+
+		/// @brief Find the first character that can change the state of `skip_scan`
+		///
+		/// Outside the strings, they are the brackets, the double quote and the
+		/// characters starting a comment; inside the strings, the double quote
+		/// and the backslash.
+		///
+		/// @param chars     Characters to be scanned
+		/// @param count     Number of characters
+		/// @param in_string True if the characters are inside a string
+		/// @return Returns the offset of the character or `count` if not found
+		static size_t skip_find(const char* chars, size_t count, bool in_string);
+
 	public:
 		//--------------------------------------------------------
 		// UPDATE ACCESS SECTION
@@ -336,6 +537,49 @@ class json_tokenizer_sourced: public json_tokenizer_base<CHARTYPE,RAWSTRING> {
 		///
 		/// Note: C_SPACEs are silently skipped
 		json_tokenizer_ret fetch_token();
+
+		/// @brief Skip the object or the array opened by the last token
+		///
+		/// If the last token returned by `fetch_token` is `C_BRACE_OPEN` or
+		/// `C_BRACKET_OPEN`, everything up to the matching closing bracket is
+		/// consumed with no decoding: only the nesting level, the strings and
+		/// the comments are tracked, so the skipped content is not validated.
+		/// The closing bracket becomes the last token. For the other tokens,
+		/// it does nothing.
+		///
+		/// @param raw If not `nullptr`, the skipped characters, closing bracket
+		///            included, are appended to it
+		/// @return Returns the last token: `C_BRACE_CLOSE` or `C_BRACKET_CLOSE`,
+		///         or `C_ERROR` if the input ends before the closing bracket
+		json_tokenizer_ret skip_value(RAWSTRING* raw=nullptr) {return (this->can_skip_value() ? skip_until_close(1, raw) : this->get_last_process_ret());}
+
+		/// @brief Skip everything up to the closing bracket of an enclosing object or array
+		///
+		/// Like `skip_value`, but the skip can start anywhere between two tokens:
+		/// `depth` brackets are considered open and the skip ends when all of them
+		/// have been closed. For example, with `depth` 1 it skips the remaining
+		/// elements of the object or the array being parsed, up to its closing bracket.
+		///
+		/// @param depth Number of brackets open; it must be at least 1
+		/// @param raw   If not `nullptr`, the skipped characters, closing bracket
+		///              included, are appended to it
+		/// @return Returns the last token: `C_BRACE_CLOSE` or `C_BRACKET_CLOSE`,
+		///         or `C_ERROR` if the input ends before the closing bracket
+		json_tokenizer_ret skip_until_close(size_t depth, RAWSTRING* raw=nullptr);
+
+		/// @brief Walk a structural index instead of examining every character
+		///
+		/// The index must have been built on the memory exposed by the source
+		/// through `tentative_window`, for example the buffer of a `source_membuf`
+		/// or the file of a `source_mmap`; it is used only while the window falls
+		/// inside the indexed memory. See STRUCTURAL INDEX in the header.
+		///
+		/// @param index Index, that must stay available while it is used; `nullptr`
+		///              or an invalid index are ignored
+		void set_structural_index(const json_structural_index* index) requires std::is_same_v<CHARTYPE,char> {
+			m_index = ((index != nullptr) && index->valid() ? index : nullptr);
+			m_index_cursor = 0;
+		}
 };
 
 
@@ -410,6 +654,12 @@ json_tokenizer_ret json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_eof
 			if (m_state == state_t::IDLING) clear();
 			char32_t ch32_curr = cast_to_unsigned<char32_t>(m_prev_char);
 			m_last_process_ret = process_char_internal(ch32_curr, CH32_EOF);
+			// Inside a string or a comment, the EOF must be processed as well: it
+			// ends a slash-slash comment and it is an error for the others
+			if (m_last_process_ret == json_tokenizer_ret::C_NEED_MORE_CHARS) {
+				if (m_state == state_t::IN_STRING) m_last_process_ret = process_char_string(CH32_EOF);
+				else if (m_state == state_t::IN_COMMENT) m_last_process_ret = process_char_comment(CH32_EOF);
+			}
 			m_raw_token.push_back(m_prev_char);
 
 			m_state = state_t::REACHED_EOF;
@@ -545,18 +795,17 @@ json_tokenizer_ret json_tokenizer_base<CHARTYPE,RAWSTRING>::process_char_interna
 
 
 //------------------------------------------------------------------------------
-// (brief) Add a character to m_string when parsing string
-// (param) ch32 The character to be added
-//
-// In case of `NUMBERS_IN_STRINGS` enabled, it checks if the character being added
-// is 100% invalid for numbers and sets the `m_string_can_converted_to_number` flag.
+// (brief) Combine UTF-16 surrogates
+// (param) str String whose last character might be the first surrogate
+// (param) ch32 Character to be added
+// (return) Returns `true` if `ch32` was the second surrogate and it has been combined
+//          with the last character of `str`
 //------------------------------------------------------------------------------
 template<class CHARTYPE, class RAWSTRING>
-void json_tokenizer_base<CHARTYPE,RAWSTRING>::add_char_to_string(char32_t ch32)
+bool json_tokenizer_base<CHARTYPE,RAWSTRING>::combine_utf16_surrogates(char32string& str, char32_t ch32)
 {
-	// Resolve UTF-16 surrogates
-	if ((m_string.size() > 0) && (ch32 < 0x10000) && (detect_utf16_char((char16_t)ch32) == utf16_SECOND)) {
-		char32_t prev = m_string[m_string.size()-1];
+	if ((str.size() > 0) && (ch32 < 0x10000) && (detect_utf16_char((char16_t)ch32) == utf16_SECOND)) {
+		char32_t prev = str[str.size()-1];
 		if ((prev < 0x10000) && (detect_utf16_char((char16_t)prev) == utf16_FIRST)) {
 			char16_t surrogates[3];
 			surrogates[0] = (char16_t)prev;
@@ -564,11 +813,127 @@ void json_tokenizer_base<CHARTYPE,RAWSTRING>::add_char_to_string(char32_t ch32)
 			surrogates[2] = 0;
 			char32_t codepoint;
 			if (read_utf16_asciiz(surrogates, codepoint) == 2) {
-				m_string[m_string.size()-1] = codepoint;
-				return;
+				str[str.size()-1] = codepoint;
+				return true;
 			}
 		}
 	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Process a whole string available in memory returning it as a view
+//
+// The string is rejected if it contains a backslash or, for wide characters,
+// a UTF-16 surrogate: in both cases `get_string` would not correspond one
+// to one to the source characters.
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+size_t json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_string_view(const CHARTYPE* chars, size_t count)
+{
+	assert(can_process_string_view());
+	size_t i;
+	for (i=0; i<count; i++) {
+		char32_t ch32 = cast_to_unsigned<char32_t>(chars[i]);
+		if (ch32 == '"') break;
+		if (ch32 == '\\') return 0;
+		if constexpr (sizeof(CHARTYPE) > 1) {
+			if ((ch32 >= 0xD800) && (ch32 <= 0xDFFF)) return 0;
+		}
+	}
+
+	// The closing double quote and the following character must be available
+	if (i+1 >= count) return 0;
+	return internal_set_string_view(chars, i);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Return as a view a string whose closing double quote is known
+// (param) chars  Characters following the opening double quote
+// (param) length Length of the string
+// (return) Returns the number of characters used, closing double quote included
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+size_t json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_set_string_view(const CHARTYPE* chars, size_t length)
+{
+	assert(can_process_string_view());
+	clear();
+	m_view = chars;
+	m_view_length = length;
+	m_view_pending = true;
+	m_prev_char = chars[length+1];
+	m_last_process_ret = json_tokenizer_ret::C_STRING;
+	return length+1;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Complete the skip of an object or an array performed by the derived class
+// (param) closing Closing bracket, that becomes the last token
+// (param) next    Character following the closing bracket, that becomes the current
+//                 character, or `nullptr` if there are no more characters
+// (return) Returns the last token
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+json_tokenizer_ret json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_end_skip(CHARTYPE closing, const CHARTYPE* next)
+{
+	clear();
+	m_raw_token.push_back(closing);
+	if (next != nullptr) m_prev_char = *next;
+	else m_state = state_t::REACHED_EOF;
+	m_last_process_ret = (cast_to_unsigned<char32_t>(closing) == ']' ? json_tokenizer_ret::C_BRACKET_CLOSE : json_tokenizer_ret::C_BRACE_CLOSE);
+	return m_last_process_ret;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Fill `m_string` and `m_raw_token` from `m_view`
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+void json_tokenizer_base<CHARTYPE,RAWSTRING>::fill_from_view() const
+{
+	// Numbers have no double quotes
+	bool quoted = (m_last_process_ret == json_tokenizer_ret::C_STRING);
+	m_view_pending = false;
+	m_string.reserve(m_view_length);
+	if (quoted) m_raw_token.push_back((CHARTYPE)'"');
+	for (size_t i=0; i<m_view_length; i++) {
+		m_string.push_back(cast_to_unsigned<char32_t>(m_view[i]));
+		m_raw_token.push_back(m_view[i]);
+	}
+	if (quoted) m_raw_token.push_back((CHARTYPE)'"');
+}
+
+//------------------------------------------------------------------------------
+// (brief) Get the string (valid only in case it returned C_STRING) in UTF-8
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+void json_tokenizer_base<CHARTYPE,RAWSTRING>::get_string_utf8(std::string& utf8) const
+{
+	if (m_view_pending) {
+		utf8.resize(m_view_length);
+		size_t i;
+		for (i=0; i<m_view_length; i++) {
+			char32_t ch32 = cast_to_unsigned<char32_t>(m_view[i]);
+			if (ch32 >= 0x80) break;
+			utf8[i] = (char)ch32;
+		}
+		if (i == m_view_length) return;
+	}
+	utf8.clear();
+	get_string().get_utf8(utf8);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Add a character to m_string when parsing string
+// (param) ch32 The character to be added
+//
+// In case of `NUMBERS_IN_STRINGS` enabled, it checks if the character being added
+// is 100% invalid for numbers and sets the `m_string_can_converted_to_number` flag.
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+void json_tokenizer_base<CHARTYPE,RAWSTRING>::add_char_to_string(char32_t ch32)
+{
+	// Resolve UTF-16 surrogates
+	if (combine_utf16_surrogates(m_string, ch32)) return;
 
 	m_string.push_back(ch32);
 	// If the string can still be converted to a number, let's see if it contains
@@ -815,6 +1180,46 @@ inline size_t json_tokenizer_numeric_ch(char32_t ch32)
 	return 0;
 }
 
+/// @brief Numeric parser state: the character is not supported
+constexpr uint8_t JSON_TOKENIZER_NUMERIC_FAIL = UINT8_MAX;
+
+/// @brief Numeric parser state: the character terminates the number
+constexpr uint8_t JSON_TOKENIZER_NUMERIC_END = UINT8_MAX-1;
+
+//------------------------------------------------------------------------------
+// (brief) Evolve the numeric parser state
+// (param) state Current state
+// (param) ch32  Character to be processed
+// (return) Returns the new state, `JSON_TOKENIZER_NUMERIC_FAIL` or `JSON_TOKENIZER_NUMERIC_END`
+//------------------------------------------------------------------------------
+inline uint8_t json_tokenizer_numeric_next_state(uint8_t state, char32_t ch32)
+{
+	constexpr size_t STATES_COUNT=8;
+	constexpr size_t EVENTS_COUNT=6;
+
+	size_t ev = json_tokenizer_numeric_ch(ch32);
+	assert((size_t)state < STATES_COUNT);
+	assert(ev < EVENTS_COUNT);
+
+	// This map indicates, for each state, what state to move to according
+	// to the various events. The event is at the position indicated in `json_tokenizer_numeric_ch`.
+	// The state machine is depicted in ../../devdocs/json_tokenizer_numeric.jpg
+	constexpr uint8_t _ = JSON_TOKENIZER_NUMERIC_FAIL;  // Not supported
+	constexpr uint8_t X = JSON_TOKENIZER_NUMERIC_END;   // Terminate
+	static constexpr uint8_t state_map[STATES_COUNT][EVENTS_COUNT] = {
+	             //  ?  -  +  .  E  0-9
+		/* STATE 0 */ {_, 1, _, _, _, 2},
+		/* STATE 1 */ {_, _, _, _, _, 2},
+		/* STATE 2 */ {X, _, _, 3, 5, 2},
+		/* STATE 3 */ {_, _, _, _, _, 4},
+		/* STATE 4 */ {X, _, _, _, 5, 4},
+		/* STATE 5 */ {_, 6, 6, _, _, 7},
+		/* STATE 6 */ {_, _, _, _, _, 7},
+		/* STATE 7 */ {X, _, _, _, _, 7},
+	};
+	return state_map[state][ev];
+}
+
 //------------------------------------------------------------------------------
 // (brief) Process one character of a number
 // (param) ch32_curr Character to be processed or EOF
@@ -847,35 +1252,11 @@ json_tokenizer_ret json_tokenizer_base<CHARTYPE,RAWSTRING>::process_char_number(
 		is consistent, it will return OK, otherwise it will return an error.
 
 	*/
-	constexpr size_t STATES_COUNT=8;
-	constexpr size_t EVENTS_COUNT=6;
-
-	size_t ev_curr = json_tokenizer_numeric_ch(ch32_curr);
-	size_t ev_next = json_tokenizer_numeric_ch(ch32_next);
-
-	assert((size_t)m_numeric_parser_state < STATES_COUNT);
-	assert(ev_curr < EVENTS_COUNT);
-	assert(ev_next < EVENTS_COUNT);
-
-	// This map indicates, for each state, what state to move to according
-	// to the various events. The event is at the position indicated in `json_tokenizer_numeric_ch`.
-	// The state machine is depicted in ../../devdocs/json_tokenizer_numeric.jpg
-	static constexpr uint8_t _ = UINT8_MAX;    // Not supported
-	static constexpr uint8_t X = UINT8_MAX-1;  // Terminate
-	static constexpr uint8_t state_map[STATES_COUNT][EVENTS_COUNT] = {
-	             //  ?  -  +  .  E  0-9
-		/* STATE 0 */ {_, 1, _, _, _, 2},
-		/* STATE 1 */ {_, _, _, _, _, 2},
-		/* STATE 2 */ {X, _, _, 3, 5, 2},
-		/* STATE 3 */ {_, _, _, _, _, 4},
-		/* STATE 4 */ {X, _, _, _, 5, 4},
-		/* STATE 5 */ {_, 6, 6, _, _, 7},
-		/* STATE 6 */ {_, _, _, _, _, 7},
-		/* STATE 7 */ {X, _, _, _, _, 7},
-	};
+	static constexpr uint8_t _ = JSON_TOKENIZER_NUMERIC_FAIL;
+	static constexpr uint8_t X = JSON_TOKENIZER_NUMERIC_END;
 
 	// Find the next state according to the current character and the current state
-	m_numeric_parser_state = state_map[m_numeric_parser_state][ev_curr];
+	m_numeric_parser_state = json_tokenizer_numeric_next_state(m_numeric_parser_state, ch32_curr);
 
 	// By design, this code checks in advance if the current transaction will
 	// fail or terminate. See 'INTERNAL DESIGN' at the beginnin of this function.
@@ -888,8 +1269,7 @@ json_tokenizer_ret json_tokenizer_base<CHARTYPE,RAWSTRING>::process_char_number(
 	// Get the evolution from the next state.
 	// With this information we know in advance if the next transition
 	// will fail and we can stop here. In this way
-	assert(m_numeric_parser_state <= STATES_COUNT);
-	uint8_t future_state = state_map[m_numeric_parser_state][ev_next];
+	uint8_t future_state = json_tokenizer_numeric_next_state(m_numeric_parser_state, ch32_next);
 
 	// If m_numeric_parser_state is '_' it means that the following character will not be
 	// supported.
@@ -914,21 +1294,129 @@ json_tokenizer_ret json_tokenizer_base<CHARTYPE,RAWSTRING>::process_char_number(
 	return json_tokenizer_ret::C_NEED_MORE_CHARS;
 }
 
+//------------------------------------------------------------------------------
+// (brief) Process a whole number available in memory parsing it in place
+// (param) chars Characters of the number, starting with the current character
+// (param) count Number of characters available at `chars`
+// (return) Returns the number of characters used or zero
+//
+// The number is delimited with the same state machine used by `process_char_number`.
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+size_t json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_number_view(const CHARTYPE* chars, size_t count)
+{
+	assert(can_process_number_view());
+	uint8_t state = 0;
+	size_t i;
+	for (i=0; i+1<count; i++) {
+		state = json_tokenizer_numeric_next_state(state, cast_to_unsigned<char32_t>(chars[i]));
+		assert(state < JSON_TOKENIZER_NUMERIC_END);
+		uint8_t future_state = json_tokenizer_numeric_next_state(state, cast_to_unsigned<char32_t>(chars[i+1]));
+		// Errors are reported by the character by character processing
+		if (future_state == JSON_TOKENIZER_NUMERIC_FAIL) return 0;
+		if (future_state == JSON_TOKENIZER_NUMERIC_END) break;
+	}
+
+	// The character following the number must be available
+	if (i+1 >= count) return 0;
+
+	clear();
+	m_multinum.parse(chars, i+1);
+	if (!m_multinum.valid()) return 0;
+	m_view = chars;
+	m_view_length = i+1;
+	m_view_pending = true;
+	m_prev_char = chars[i+1];
+	m_last_process_ret = json_tokenizer_ret::C_NUMBER;
+	return i+1;
+}
+
 //------------------------------------------------------------------------------
 // (brief) Extract the next token
 // (return) Returns the result of this step or `C_NOTHING_MORE` if there are no more tokens
 //
 // Note: C_SPACEs are silently skipped
+//
+// If the source exposes its data in memory (see `source::tentative_window`)
+// the characters are scanned directly from there and then discarded in a single call;
+// otherwise they are fetched one by one. Discarding does not move the data
+// exposed by the window, so the string views stay valid until the next call.
+// In both cases, the first character available in the source is the one
+// already stored in `m_prev_char` (peeked but not extracted yet).
 //------------------------------------------------------------------------------
 template<class CHARTYPE, class RAWSTRING>
 json_tokenizer_ret json_tokenizer_sourced<CHARTYPE,RAWSTRING>::fetch_token()
 {
 	json_tokenizer_ret ret;
 	for(;;) {
+		// Fast path: contiguous data
+		size_t count;
+		const CHARTYPE* window = m_source.tentative_window(SIZE_MAX, count);
+		if (count > 1) {
+			// Offset of the window in the indexed memory
+			size_t index_offset = json_structural_index::npos;
+			if constexpr (std::is_same_v<CHARTYPE,char>) {
+				if (m_index != nullptr) {
+					uintptr_t begin = (uintptr_t)m_index->data();
+					if (((uintptr_t)window >= begin) && ((uintptr_t)(window+count) <= begin + m_index->size())) index_offset = (size_t)((uintptr_t)window - begin);
+				}
+			}
+
+			size_t i;
+			for (i=1; i<count; i++) {
+				// With a structural index, jump over the spaces and to the end of the strings;
+				// the current character is at window[i-1]
+				if (index_offset != json_structural_index::npos) {
+					size_t curr = index_offset+i-1;
+					if (this->can_skip_space()) {
+						size_t next = std::min(m_index->next_position(curr, m_index_cursor), index_offset+count-1);
+						if (next > curr) {
+							i = next-index_offset;
+							this->set_first_char(window[i]);
+							continue;
+						}
+					}
+					else if (this->can_process_string_view()) {
+						size_t closing = m_index->next_position(curr, m_index_cursor);
+						if ((closing < index_offset+count-1) && (window[closing-index_offset] == '"') && (memchr(window+i, '\\', closing-curr-1) == nullptr)) {
+							size_t used = this->internal_set_string_view(window+i, closing-curr-1);
+							m_source.tentative_discard(i+used);
+							return json_tokenizer_ret::C_STRING;
+						}
+					}
+				}
+
+
+				// Strings with no escapes are returned as views on the window
+				if (this->can_process_string_view()) {
+					size_t used = this->internal_process_string_view(window+i, count-i);
+					if (used > 0) {
+						m_source.tentative_discard(i+used);
+						return json_tokenizer_ret::C_STRING;
+					}
+				}
+				// Numbers are parsed in place; the current character is at window[i-1]
+				if (this->can_process_number_view()) {
+					size_t used = this->internal_process_number_view(window+i-1, count-i+1);
+					if (used > 0) {
+						m_source.tentative_discard(i-1+used);
+						return json_tokenizer_ret::C_NUMBER;
+					}
+				}
+				ret = json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_char(window[i]);
+				if ((ret != json_tokenizer_ret::C_NEED_MORE_CHARS) && (ret != json_tokenizer_ret::C_SPACE)) {
+					m_source.tentative_discard(i);
+					return ret;
+				}
+			}
+			// Leave the last character in the source: it is the current "m_prev_char"
+			m_source.tentative_discard(count-1);
+		}
+
+		// Slow path: one character at a time
 		CHARTYPE ch;
-		//if (m_source.tentative_read_char(ch)) {
-        m_source.tentative_read_char(ch);
-        if (m_source.tentative_peek_char(ch)) {
+		m_source.tentative_read_char(ch);
+		if (m_source.tentative_peek_char(ch)) {
 			ret = json_tokenizer_base<CHARTYPE,RAWSTRING>::internal_process_char(ch);
 		}
 		else {
@@ -939,5 +1427,163 @@ json_tokenizer_ret json_tokenizer_sourced<CHARTYPE,RAWSTRING>::fetch_token()
 	return ret;
 }
 
+//------------------------------------------------------------------------------
+// (brief) Skip everything up to the closing bracket of an enclosing object or array
+// (param) depth Number of brackets open
+// (param) raw   If not `nullptr`, the skipped characters, closing bracket included,
+//               are appended to it
+// (return) Returns the last token
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+json_tokenizer_ret json_tokenizer_sourced<CHARTYPE,RAWSTRING>::skip_until_close(size_t depth, RAWSTRING* raw)
+{
+	assert(depth > 0);
+
+	// As in `fetch_token`, the first character available in the source is the current one
+	skip_state state;
+	state.m_depth = depth;
+	for(;;) {
+		// Fast path: contiguous data
+		size_t count;
+		const CHARTYPE* window = m_source.tentative_window(SIZE_MAX, count);
+		if (count > 0) {
+			size_t used = skip_scan(window, count, state);
+			if (raw != nullptr) raw->insert(raw->end(), window, window+used);
+			if (state.m_depth == 0) {
+				CHARTYPE closing = window[used-1];
+				CHARTYPE next;
+				bool has_next = (used < count);
+				if (has_next) next = window[used];
+				m_source.tentative_discard(used);
+				if (!has_next) has_next = m_source.tentative_peek_char(next);
+				return this->internal_end_skip(closing, has_next ? &next : nullptr);
+			}
+			m_source.tentative_discard(used);
+			continue;
+		}
+
+		// Slow path: one character at a time
+		CHARTYPE ch;
+		if (!m_source.tentative_read_char(ch)) return this->internal_fail_skip();
+		skip_scan(&ch, 1, state);
+		if (raw != nullptr) raw->push_back(ch);
+		if (state.m_depth == 0) {
+			CHARTYPE next;
+			return this->internal_end_skip(ch, m_source.tentative_peek_char(next) ? &next : nullptr);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Scan the characters skipped by `skip_value`
+// (param) chars Characters to be scanned
+// (param) count Number of characters
+// (param) state State of the scan, updated
+// (return) Returns the number of characters scanned
+//
+// For `char`, the characters that can not change the state are jumped
+// over in blocks (see `skip_find`).
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+size_t json_tokenizer_sourced<CHARTYPE,RAWSTRING>::skip_scan(const CHARTYPE* chars, size_t count, skip_state& state)
+{
+	for (size_t i=0; i<count; i++) {
+		if constexpr (std::is_same_v<CHARTYPE,char>) {
+			if ((state.m_mode == skip_mode_t::VALUE) || (state.m_mode == skip_mode_t::STRING)) {
+				i += skip_find(chars+i, count-i, state.m_mode == skip_mode_t::STRING);
+				if (i == count) break;
+			}
+		}
+		char32_t ch32 = cast_to_unsigned<char32_t>(chars[i]);
+		switch(state.m_mode) {
+			case skip_mode_t::SLASH: {
+				if (ch32 == '/') {state.m_mode = skip_mode_t::COMMENT_LINE; break;}
+				if (ch32 == '*') {state.m_mode = skip_mode_t::COMMENT_BLOCK; break;}
+				// Not a comment: the character is processed normally
+				state.m_mode = skip_mode_t::VALUE;
+				[[fallthrough]];
+			}
+			case skip_mode_t::VALUE: {
+				switch(ch32) {
+					case '"': state.m_mode = skip_mode_t::STRING; break;
+					case '{': case '[': state.m_depth++; break;
+					case '}': case ']': if (--state.m_depth == 0) return i+1; break;
+					case '/': state.m_mode = skip_mode_t::SLASH; break;
+					case '#': state.m_mode = skip_mode_t::COMMENT_LINE; break;
+					default:;
+				}
+				break;
+			}
+			case skip_mode_t::STRING: {
+				if (ch32 == '\\') state.m_mode = skip_mode_t::STRING_ESCAPE;
+				else if (ch32 == '"') state.m_mode = skip_mode_t::VALUE;
+				break;
+			}
+			case skip_mode_t::STRING_ESCAPE: state.m_mode = skip_mode_t::STRING; break;
+			case skip_mode_t::COMMENT_LINE: if ((ch32 == '\n') || (ch32 == '\r')) state.m_mode = skip_mode_t::VALUE; break;
+			case skip_mode_t::COMMENT_BLOCK: if (ch32 == '*') state.m_mode = skip_mode_t::COMMENT_BLOCK_STAR; break;
+			case skip_mode_t::COMMENT_BLOCK_STAR: {
+				if (ch32 == '/') state.m_mode = skip_mode_t::VALUE;
+				else if (ch32 != '*') state.m_mode = skip_mode_t::COMMENT_BLOCK;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Find the first character that can change the state of `skip_scan`
+// (param) chars     Characters to be scanned
+// (param) count     Number of characters
+// (param) in_string True if the characters are inside a string
+// (return) Returns the offset of the character or `count` if not found
+//------------------------------------------------------------------------------
+template<class CHARTYPE, class RAWSTRING>
+size_t json_tokenizer_sourced<CHARTYPE,RAWSTRING>::skip_find(const char* chars, size_t count, bool in_string)
+{
+	size_t i = 0;
+	#ifdef DASTD_JSON_INDEX_X86
+	// SSE2 is always available on x86-64: 16 characters at a time
+	if (in_string) {
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		for (; i+16<=count; i+=16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(chars+i));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+			if (mask != 0) return i + (size_t)std::countr_zero(mask);
+		}
+	}
+	else {
+		// The brackets differ only in the bits 0x20 and 0x06: '[' 0x5B, ']' 0x5D, '{' 0x7B, '}' 0x7D;
+		// the few other characters matching (like '_' or 'y') are harmless
+		const __m128i bracket_mask = _mm_set1_epi8((char)0xD9);
+		const __m128i bracket = _mm_set1_epi8(0x59);
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i slash = _mm_set1_epi8('/');
+		const __m128i hash = _mm_set1_epi8('#');
+		for (; i+16<=count; i+=16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(chars+i));
+			__m128i found = _mm_cmpeq_epi8(_mm_and_si128(v, bracket_mask), bracket);
+			found = _mm_or_si128(found, _mm_cmpeq_epi8(v, quote));
+			found = _mm_or_si128(found, _mm_cmpeq_epi8(v, slash));
+			found = _mm_or_si128(found, _mm_cmpeq_epi8(v, hash));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(found);
+			if (mask != 0) return i + (size_t)std::countr_zero(mask);
+		}
+	}
+	#endif
+
+	for (; i<count; i++) {
+		char ch = chars[i];
+		if (in_string) {
+			if ((ch == '"') || (ch == '\\')) break;
+		}
+		else {
+			if ((ch == '"') || (ch == '{') || (ch == '}') || (ch == '[') || (ch == ']') || (ch == '/') || (ch == '#')) break;
+		}
+	}
+	return i;
+}
 
 } // namespace dastd
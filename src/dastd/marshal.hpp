@@ -181,6 +181,20 @@
 
 	@endcode
 
+	Arrays of numbers (integrals other than `bool`, enums and `double`) can be encoded
+	and decoded in a single call. The encoding is the same as the element-by-element
+	one, so the two forms can be mixed freely between encoder and decoder, but the
+	encoders can implement it far more efficiently:
+
+	@code{.cpp}
+
+	std::vector<uint32_t> myNumbers;
+	encoder.encode_array_of<uint32_t>(myNumbers);
+	...
+	decoder.decode_array_of(myNumbers);
+
+	@endcode
+
 	@subsection marshaling_dictionaries Marshaling dictionarys
 	Dictionaries are sequences of a variable number of (key,object) pairs of the same type.
 	Keys are required to be strings.
@@ -277,8 +291,11 @@
 #include "defs.hpp"
 #include "exception.hpp"
 #include "hash_crc32.hpp"
+#include "utf8.hpp"
 #include "fmt.hpp"
 #include <cassert>
+#include <span>
+#include <vector>
 
 namespace dastd {
 	/// @brief Marshaling option for integrals
@@ -348,6 +365,17 @@ namespace dastd {
 		/// @brief Function that calculates the hash
 		static marshal_label_id_t hash(const std::string& label_text) {return (marshal_label_id_t)crc32(label_text);}
 
+		/// @brief Function that calculates the hash of a text made of UNICODE code points
+		///
+		/// Returns the same value as `hash` applied to the UTF-8 encoding
+		/// of the text, without allocating the UTF-8 string.
+		///
+		/// @tparam CHARTYPE Character type; each character is a code point
+		/// @param label_text Label text
+		/// @param length Number of characters in `label_text`
+		template<class CHARTYPE>
+		static marshal_label_id_t hash(const CHARTYPE* label_text, size_t length);
+
 #if DASTD_CPP_VER >= 20
 		/// @brief Function that calculates the hash working on const values
 		///
@@ -365,6 +393,27 @@ namespace dastd {
 
 	DASTD_DEF_OSTREAM(marshal_label);
 
+	// (brief) Function that calculates the hash of a text made of UNICODE code points
+	template<class CHARTYPE>
+	marshal_label_id_t marshal_label::hash(const CHARTYPE* label_text, size_t length)
+	{
+		// The text is converted to UTF-8 in blocks
+		hash_crc32 h;
+		char buffer[64+UTF8_CHAR_MAX_LEN];
+		size_t used = 0;
+		for (size_t i=0; i<length; i++) {
+			char32_t ch32 = cast_to_unsigned<char32_t>(label_text[i]);
+			if (ch32 < 0x80) buffer[used++] = (char)ch32;
+			else used += write_utf8_asciiz(buffer+used, ch32);
+			if (used >= 64) {
+				h.add((const void*)buffer, used);
+				used = 0;
+			}
+		}
+		h.add((const void*)buffer, used);
+		return (marshal_label_id_t)h.get();
+	}
+
 
 	/// @exception dastd::exception_marshal
 	/// @brief Base exception for marshal execution
@@ -373,6 +422,86 @@ namespace dastd {
 
 	template <class T>
 	concept marshal_integral_types = std::is_integral_v<T> || std::is_enum_v<T>;
+
+	/// @brief Types that can be encoded with `encode_array_of` and decoded with `decode_array_of`
+	template <class T>
+	concept marshal_array_item_types = (marshal_integral_types<T> && !std::is_same_v<T, bool>) || std::is_same_v<T, double>;
+
+	/// @brief Type of the elements of an array encoded with `encode_array_of`
+	enum class marshal_array_item: uint8_t {
+		U8, I8, U16, I16, U32, I32, U64, I64, F64
+	};
+
+	/// @brief Return the `marshal_array_item` corresponding to a type
+	///
+	/// Enums are handled as unsigned integers of the same size, as done
+	/// by `marshal_enc::encode`.
+	template<marshal_array_item_types TYPE>
+	constexpr marshal_array_item marshal_array_item_of() {
+		constexpr bool is_signed = std::is_signed_v<TYPE>;
+		if constexpr (std::is_same_v<TYPE, double>) return marshal_array_item::F64;
+		else if constexpr (sizeof(TYPE) == 1) return (is_signed ? marshal_array_item::I8 : marshal_array_item::U8);
+		else if constexpr (sizeof(TYPE) == 2) return (is_signed ? marshal_array_item::I16 : marshal_array_item::U16);
+		else if constexpr (sizeof(TYPE) == 4) return (is_signed ? marshal_array_item::I32 : marshal_array_item::U32);
+		else return (is_signed ? marshal_array_item::I64 : marshal_array_item::U64);
+	}
+
+	/// @brief Invoke `func` with a null pointer to the C++ type corresponding to `item`
+	///
+	/// Allows writing the array handling once as a generic lambda:
+	///
+	///     marshal_array_item_dispatch(item, [&](auto* tag) {
+	///         using ITEM = std::remove_pointer_t<decltype(tag)>;
+	///         ...
+	///     });
+	///
+	template<class FUNC>
+	inline void marshal_array_item_dispatch(marshal_array_item item, FUNC&& func) {
+		switch(item) {
+			case marshal_array_item::U8: func((uint8_t*)nullptr); break;
+			case marshal_array_item::I8: func((int8_t*)nullptr); break;
+			case marshal_array_item::U16: func((uint16_t*)nullptr); break;
+			case marshal_array_item::I16: func((int16_t*)nullptr); break;
+			case marshal_array_item::U32: func((uint32_t*)nullptr); break;
+			case marshal_array_item::I32: func((int32_t*)nullptr); break;
+			case marshal_array_item::U64: func((uint64_t*)nullptr); break;
+			case marshal_array_item::I64: func((int64_t*)nullptr); break;
+			case marshal_array_item::F64: func((double*)nullptr); break;
+		}
+	}
+
+	/// @brief Type-erased reference to the std::vector receiving the result of `decode_array_of`
+	///
+	/// The elements are written as raw bytes (with `memcpy`) in the memory
+	/// returned by `resize`, using the representation of the corresponding
+	/// `marshal_array_item`.
+	class marshal_array_target {
+		public:
+			/// @brief Constructor
+			/// @param vector Vector receiving the decoded elements
+			template<marshal_array_item_types TYPE>
+			marshal_array_target(std::vector<TYPE>& vector): m_vector(&vector), m_resize(&resize_vector<TYPE>) {}
+
+			/// @brief Resize the vector
+			/// @param count New number of elements
+			/// @return Returns the pointer to the first element
+			void* resize(size_t count) const {return m_resize(m_vector, count);}
+
+		private:
+			/// @brief Pointer to the std::vector
+			void* m_vector;
+
+			/// @brief Function resizing the std::vector
+			void* (*m_resize)(void* vector, size_t count);
+
+			/// @brief Resize a std::vector<TYPE>
+			template<class TYPE>
+			static void* resize_vector(void* vector, size_t count) {
+				std::vector<TYPE>& v = *(std::vector<TYPE>*)vector;
+				v.resize(count);
+				return v.data();
+			}
+	};
 }
 
 /// @brief Creates a statically calculated marshal_label
@@ -41,6 +41,31 @@
 	data. If the typed object is saved as `extensible=true`, it will encode
 	the type as u32, followed by the length in bytes (u32) and the encoded data.
 
+	Compact format
+	--------------
+	The rules above describe the `marshal_bin_format::FIXED` format, that is the
+	default one. The `marshal_bin_format::COMPACT` format differs as follows:
+
+	- array and dictionary sizes, string and binary lengths are encoded as
+	  LEB128 varints: 7 bits per byte, least significant group first, with the
+	  high bit set on all the bytes but the last one;
+	- 16, 32 and 64 bit integers are encoded as varints if their suggestions
+	  allow it (see `marshal_bin_varint_suggested`); signed values are
+	  zigzag-encoded first, so small negative values take few bytes as well;
+	- the size indicators of extensible structures and typed objects are
+	  still fixed u32 values, since they are written after the content.
+
+	The decoder must be set to the same format and must pass the same suggestions
+	used by the encoder.
+
+	Format header
+	-------------
+	The optional format header consists of the three bytes "DAB" followed by one byte
+	with the `marshal_bin_format` value. It is written by `encode_format_header` and
+	read by `decode_format_header`, that switches the decoder to the indicated format.
+	Data encoded before the introduction of the compact format has no header and is
+	decoded with the default `FIXED` format.
+
 
 	@link marshaling_main Marshaling page @endlink
 	@see dastd::marshal_dec_bin
@@ -48,6 +73,7 @@
 
 **/
 #pragma once
+#include "marshal.hpp"
 #include <iostream>
 namespace dastd {
 	/// @brief Type of element
@@ -69,4 +95,59 @@ namespace dastd {
 		}
 		return o;
 	}
+
+	/// @brief Binary encoding format version
+	///
+	/// See @link marshaling_bin_format "Marshaling binary format" @endlink.
+	enum class marshal_bin_format: uint8_t {
+		/// @brief Fixed-size little-endian integers and size indicators
+		FIXED = 0,
+
+		/// @brief Varint size indicators and varint integers where suggested
+		COMPACT = 1
+	};
+
+	/// @brief Magic bytes preceding the format version in the format header
+	constexpr char marshal_bin_FORMAT_MAGIC[3] = {'D', 'A', 'B'};
+
+	/// @brief Maximum length of a LEB128 encoded 64-bit value
+	constexpr size_t marshal_bin_VARINT_MAX_LEN = 10;
+
+	/// @brief Tells whether the `COMPACT` format encodes an integer as varint
+	///
+	/// The varint is used if the value is suggested to be increasing (hence most
+	/// likely small) or if it is limited to a number of bits whose varint
+	/// encoding is not longer than the fixed one. Signed values take one more
+	/// bit once zigzag-encoded.
+	///
+	/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+	/// @param type_size Size in bytes of the integral type
+	/// @param is_signed True if the integral type is signed
+	constexpr bool marshal_bin_varint_suggested(uint32_t suggestions, size_t type_size, bool is_signed) {
+		if (suggestions & marshal_suggest_increasing) return true;
+		uint32_t bits = suggestions & 0x3F;
+		if (bits == 0) return false;
+		if (is_signed) bits++;
+		return ((bits+6)/7 <= type_size);
+	}
+
+	/// @brief Zigzag-encode a signed value so that small absolute values give small unsigned values
+	constexpr uint64_t marshal_bin_zigzag_encode(int64_t value) {return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);}
+
+	/// @brief Decode a zigzag-encoded value
+	constexpr int64_t marshal_bin_zigzag_decode(uint64_t value) {return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);}
+
+	/// @brief Write a LEB128 varint
+	/// @param target Buffer of at least `marshal_bin_VARINT_MAX_LEN` bytes
+	/// @param value Value to be encoded
+	/// @return Returns the number of bytes written
+	inline size_t marshal_bin_varint_write(uint8_t* target, uint64_t value) {
+		size_t len = 0;
+		while (value >= 0x80) {
+			target[len++] = (uint8_t)(value | 0x80);
+			value >>= 7;
+		}
+		target[len++] = (uint8_t)value;
+		return len;
+	}
 }
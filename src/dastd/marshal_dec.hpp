@@ -34,6 +34,104 @@ namespace dastd {
 
 	/// Returns true if the field_id from a marshal_label_info_t
 	inline marshal_label_id_t marshal_label_info_to_id(marshal_label_info_t label_info) {return (marshal_label_id_t)(label_info & 0xFFFFFFFFULL);}
+
+	/// @brief Lookup table of the labels declared in a `field_infos` array
+	///
+	/// Used by the decoders that receive the fields by name to find out
+	/// whether a label-id is among the ones expected by `decode_struct_begin`.
+	///
+	/// The slot of a label-id is given by its lower bits: being the label-ids
+	/// CRC-32 values, the smallest power-of-two size with no collisions (a perfect
+	/// hash) is usually small. If none is found within a reasonable size, the
+	/// collisions are resolved with linear probing.
+	class marshal_field_table {
+		public:
+			/// @brief Value returned by `find` when the label-id is not in the table
+			static constexpr size_t npos = (size_t)-1;
+
+			/// @brief Constructor
+			/// @param field_infos Declared fields
+			/// @param field_infos_count Number of elements in `field_infos`
+			marshal_field_table(const marshal_label_info_t* field_infos, size_t field_infos_count);
+
+			/// @brief Tells whether the table has been built from the same fields
+			/// @param field_infos Declared fields
+			/// @param field_infos_count Number of elements in `field_infos`
+			bool same_fields(const marshal_label_info_t* field_infos, size_t field_infos_count) const {
+				return (field_infos_count == m_field_infos.size()) && ((field_infos_count == 0) || (memcmp(field_infos, m_field_infos.data(), field_infos_count*sizeof(marshal_label_info_t)) == 0));
+			}
+
+			/// @brief Find a label-id
+			/// @param label_id Label-id to be searched
+			/// @return Returns the index of the label in the `field_infos` array or `npos` if not found
+			size_t find(marshal_label_id_t label_id) const {
+				for (size_t slot = (label_id & m_mask); ; slot = ((slot+1) & m_mask)) {
+					uint32_t entry = m_slots[slot];
+					if (entry == 0) return npos;
+					if (marshal_label_info_to_id(m_field_infos[entry-1]) == label_id) return entry-1;
+				}
+			}
+
+			/// @brief Mark a field as seen
+			/// @param index Index of the label in the `field_infos` array
+			/// @return Returns `true` if it is the first time the field is marked
+			bool mark_seen(size_t index) {
+				if (m_seen[index]) return false;
+				m_seen[index] = true;
+				return true;
+			}
+
+		private:
+			/// @brief Copy of the declared fields
+			std::vector<marshal_label_info_t> m_field_infos;
+
+			/// @brief Hash table: each slot contains the index in `m_field_infos` plus one; zero means empty
+			std::vector<uint32_t> m_slots;
+
+			/// @brief Mask applied to the label-ids to get the slot
+			size_t m_mask = 0;
+
+			/// @brief Fields already marked with `mark_seen`
+			std::vector<bool> m_seen;
+	};
+
+	// (brief) Constructor
+	// (param) field_infos Declared fields
+	// (param) field_infos_count Number of elements in `field_infos`
+	inline marshal_field_table::marshal_field_table(const marshal_label_info_t* field_infos, size_t field_infos_count):
+		m_field_infos(field_infos, field_infos+field_infos_count), m_seen(field_infos_count, false)
+	{
+		// The table is always at least half empty so the probing terminates quickly
+		size_t min_size = 1;
+		while (min_size < 2*field_infos_count) min_size <<= 1;
+
+		// Look for a size with no collisions
+		size_t size;
+		for (size = min_size; size <= std::max<size_t>(16*min_size, 64); size <<= 1) {
+			m_slots.assign(size, 0);
+			bool collision = false;
+			for (size_t i=0; (i<field_infos_count) && !collision; i++) {
+				uint32_t& slot = m_slots[marshal_label_info_to_id(field_infos[i]) & (size-1)];
+				if (slot != 0) collision = true;
+				slot = (uint32_t)(i+1);
+			}
+			if (!collision) {
+				m_mask = size-1;
+				return;
+			}
+		}
+
+		// Use linear probing
+		m_slots.assign(min_size, 0);
+		m_mask = min_size-1;
+		for (size_t i=0; i<field_infos_count; i++) {
+			marshal_label_id_t label_id = marshal_label_info_to_id(field_infos[i]);
+			if (find(label_id) != npos) continue;
+			size_t slot = (label_id & m_mask);
+			while (m_slots[slot] != 0) slot = ((slot+1) & m_mask);
+			m_slots[slot] = (uint32_t)(i+1);
+		}
+	}
 	#endif
 
 	/// @brief Base class for the marshaling decoder
@@ -194,6 +292,18 @@ namespace dastd {
 			/// See @link marshaling_arrays documentation for details and examples.
 			virtual void decode_array_element_end() = 0;
 
+			/// @brief Decode a whole array of numbers
+			/// @param values Receives the decoded elements; the previous content is replaced
+			/// @param suggestions Encoding suggestions applied to each element; see @link marshaling_suggestions documentation @endlink.
+			///
+			/// It decodes arrays encoded with `encode_array_of` as well as the ones
+			/// encoded element by element.
+			/// See @link marshaling_arrays documentation for details and examples.
+			template<marshal_array_item_types TYPE>
+			void decode_array_of(std::vector<TYPE>& values, uint32_t suggestions=0) {
+				internal_decode_array_of(marshal_array_target(values), marshal_array_item_of<TYPE>(), suggestions);
+			}
+
 			/// @brief Start decoding a dictionary
 			/// @param count Number of elements that will be decoded
 			///
@@ -261,8 +371,45 @@ namespace dastd {
 			/// @param value Receives the raw decoded data
 			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
 			virtual void internal_decode_varsize_binary(std::string& value, uint32_t suggestions=0) = 0;
+
+			/// @brief Decode a whole array of numbers
+			/// @param target Vector receiving the elements
+			/// @param item Type of the elements
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			///
+			/// The default implementation decodes the elements one by one.
+			virtual void internal_decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions);
 	};
 
+	// (brief) Decode a whole array of numbers one element at a time
+	// (param) target Vector receiving the elements
+	// (param) item Type of the elements
+	// (param) suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+	inline void marshal_dec::internal_decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions)
+	{
+		marshal_array_item_dispatch(item, [&](auto* tag) {
+			using ITEM = std::remove_pointer_t<decltype(tag)>;
+			size_t expected = decode_array_begin();
+			size_t capacity = ((expected == marshal_array_SIZE_UNKNOWN) ? 16 : std::min<size_t>(expected, 65536));
+			uint8_t* ptr = (uint8_t*)target.resize(capacity);
+			size_t count = 0;
+			while (decode_array_element_begin()) {
+				ITEM value;
+				if constexpr (std::is_same_v<ITEM, double>) value = decode_f64(suggestions);
+				else value = decode<ITEM>(suggestions);
+				decode_array_element_end();
+				if (count == capacity) {
+					capacity = std::max<size_t>(capacity*2, 16);
+					ptr = (uint8_t*)target.resize(capacity);
+				}
+				memcpy(ptr+count*sizeof(ITEM), &value, sizeof(ITEM));
+				count++;
+			}
+			decode_array_end();
+			target.resize(count);
+		});
+	}
+
 	// (brief) Decode raw binary data of a known and fixed length
 	// (param) value Receives the raw  decoded data
 	// (param) suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
@@ -4,267 +4,178 @@
 * @date 23-AUG-2023
 **/
 #pragma once
-#include "marshal_dec.hpp"
-#include "marshal_bin.hpp"
+#include "marshal_dec_bin_core.hpp"
 #include "source_string_or_vector.hpp"
-#include <stack>
 
 namespace dastd {
 
-	/// @brief Binary little-endian marshaling decoder
+	/// @brief Binary little-endian marshaling decoder exposing the `marshal_dec` interface
 	///
-	/// Decodes binary data using the binary little-endian encoding.
-	/// See @link marshaling_bin_format "Marshaling binary format" @endlink
-	/// for details on the binary encoding format.
-	class marshal_dec_bin: public marshal_dec {
-		private:
-			/// @brief Stack element
-			struct stack_element {
-				/// @brief Type of the element on the stack
-				marshal_bin_element_type m_element_type;
-
-				/// @brief True if extensible
-				bool m_extensible = false;
-
-				/// @brief Offset where the element is expected to terminate.
-				///
-				/// This is the position of the first byte that is not part of
-				/// the current object. It is calculated only if "m_extensible" is
-				/// set to true.
-				size_t m_end_offset = 0;
-
-				/// @brief Used by structures; contains the list of expected fields
-				const marshal_label_info_t* m_field_infos = nullptr;
-
-				/// @brief Used by structures; indicates the position the number of elements
-				/// in the `m_field_infos` array.
-				/// In case of arrays, it contains the number of elements.
-				size_t m_fields_count = 0;
-
-				/// @brief Used by structures; indicates the position of the next structure
-				/// field.
-				/// In case of arrays, it contains the current of elements.
-				size_t m_field_pos = 0;
-
-				/// @brief Constructor
-				stack_element(marshal_bin_element_type element_type):
-					m_element_type(element_type) {}
-
-				/// @brief Constructor
-				stack_element(marshal_bin_element_type element_type, size_t fields_count):
-					m_element_type(element_type), m_fields_count(fields_count) {}
+	/// Thin adapter forwarding the virtual methods of `marshal_dec` to a
+	/// `marshal_dec_bin_core` instance, so it can be used where a `marshal_dec&`
+	/// is required. Each `decode_xxx` costs one virtual call; the
+	/// input policy is still invoked with no further virtual calls.
+	///
+	/// @tparam INPUT Input policy; see `marshal_bin_input`
+	template<marshal_bin_input INPUT>
+	class marshal_dec_bin_adapter: public marshal_dec {
+		public:
+			/// @brief Constructor
+			/// @param args Arguments passed to the constructor of the input policy
+			template<class... ARGS>
+			explicit marshal_dec_bin_adapter(ARGS&&... args): m_core(std::forward<ARGS>(args)...) {}
 
-				/// @brief Constructor
-				stack_element(marshal_bin_element_type element_type, bool extensible, size_t end_offset):
-					m_element_type(element_type), m_extensible(extensible), m_end_offset(end_offset) {}
+			/// @brief Access the underlying non-virtual decoder
+			marshal_dec_bin_core<INPUT>& core() {return m_core;}
 
-				/// @brief Constructor
-				stack_element(marshal_bin_element_type element_type, bool extensible, size_t end_offset, const marshal_label_info_t* field_infos, size_t fields_count):
-					m_element_type(element_type), m_extensible(extensible), m_end_offset(end_offset),
-					m_field_infos(field_infos), m_fields_count(fields_count) {}
+			/// @brief Access the input policy
+			std::remove_reference_t<INPUT>& input() {return m_core.input();}
 
-				/// @brief Constructor
-				stack_element() {}
-			};
+			/// @brief Select the decoding format; see `marshal_dec_bin_core::set_format`
+			void set_format(marshal_bin_format format) {m_core.set_format(format);}
 
-			/// @brief Internal encoding stack
-			std::stack<stack_element> m_stack;
+			/// @brief Return the current decoding format
+			marshal_bin_format get_format() const {return m_core.get_format();}
 
-			/// @brief Bytes read so far
-			size_t m_offset = 0;
+			/// @brief Read the format header and switch to the indicated format
+			void decode_format_header() {m_core.decode_format_header();}
 
-		public:
 			/// @brief Decode a bool
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual bool decode_bool(uint32_t suggestions=0) override;
+			virtual bool decode_bool(uint32_t suggestions=0) override {return m_core.decode_bool(suggestions);}
 
 			/// @brief Decode a uint8_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual uint8_t decode_u8(uint32_t suggestions=0) override;
+			virtual uint8_t decode_u8(uint32_t suggestions=0) override {return m_core.decode_u8(suggestions);}
 
 			/// @brief Decode a int8_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual int8_t decode_i8(uint32_t suggestions=0) override;
+			virtual int8_t decode_i8(uint32_t suggestions=0) override {return m_core.decode_i8(suggestions);}
 
 			/// @brief Decode a uint16_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual uint16_t decode_u16(uint32_t suggestions=0) override;
+			virtual uint16_t decode_u16(uint32_t suggestions=0) override {return m_core.decode_u16(suggestions);}
 
 			/// @brief Decode a int16_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual int16_t decode_i16(uint32_t suggestions=0) override;
+			virtual int16_t decode_i16(uint32_t suggestions=0) override {return m_core.decode_i16(suggestions);}
 
 			/// @brief Decode a uint32_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual uint32_t decode_u32(uint32_t suggestions=0) override;
+			virtual uint32_t decode_u32(uint32_t suggestions=0) override {return m_core.decode_u32(suggestions);}
 
 			/// @brief Decode a int32_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual int32_t decode_i32(uint32_t suggestions=0) override;
+			virtual int32_t decode_i32(uint32_t suggestions=0) override {return m_core.decode_i32(suggestions);}
 
 			/// @brief Decode a uint64_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual uint64_t decode_u64(uint32_t suggestions=0) override;
+			virtual uint64_t decode_u64(uint32_t suggestions=0) override {return m_core.decode_u64(suggestions);}
 
 			/// @brief Decode a int64_t
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual int64_t decode_i64(uint32_t suggestions=0) override;
+			virtual int64_t decode_i64(uint32_t suggestions=0) override {return m_core.decode_i64(suggestions);}
 
 			/// @brief Decode a 64-bit floating point
-			/// @return Return the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual double decode_f64(uint32_t suggestions=0) override;
+			virtual double decode_f64(uint32_t suggestions=0) override {return m_core.decode_f64(suggestions);}
 
 			/// @brief Decode a std::string (UTF-8)
-			/// @param value Receives the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual void decode_string_utf8(std::string& value, uint32_t suggestions=0) override;
+			virtual void decode_string_utf8(std::string& value, uint32_t suggestions=0) override {m_core.decode_string_utf8(value, suggestions);}
 
 			/// @brief Decode a std::u32string
-			/// @param value Receives the decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual void decode_u32string(std::u32string& value, uint32_t suggestions=0) override;
+			virtual void decode_u32string(std::u32string& value, uint32_t suggestions=0) override {m_core.decode_u32string(value, suggestions);}
 
 			/// @brief Start Decoding a structure
-			/// @param extensible If true, the structure will be encoded so more or less fields can be expected.
-			/// @param field_infos Array with the label-ids of the expected fields in their correct order and a marker telling if that field is optional.
-			/// @param field_infos_count Number of elements to be expected in the field_ids array.
-			///
-			/// See @link marshaling_structs documentation for details and examples.
-			virtual void decode_struct_begin(bool extensible, const marshal_label_info_t* field_infos, size_t fields_infos_count) override;
+			virtual void decode_struct_begin(bool extensible, const marshal_label_info_t* field_infos, size_t fields_infos_count) override {m_core.decode_struct_begin(extensible, field_infos, fields_infos_count);}
 
 			/// @brief Terminate Decoding a structure
-			///
-			/// See @link marshaling_structs documentation for details and examples.
-			virtual void decode_struct_end() override;
+			virtual void decode_struct_end() override {m_core.decode_struct_end();}
 
 			/// @brief Start decoding a field within a structure
-			///
-			/// This must be invoked inside a `decode_struct_begin` and `decode_struct_end` pair.
-			///
-			/// It extracts a field from the structure and returns its label id. Depending on the
-			/// encoding format, the fields can be out of order, dupe, missing or unknown.
-			/// If the encoding type allows dupe or unknown fields, the `decode_struct_field_skip()`
-			/// method will be available for skipping the unwanted fields.
-			///
-			/// See @link marshaling_structs documentation for details and examples.
-			///
-			/// @param optional_present This flag is set to `true` if the field is present, or `false`
-			///                         if missing.
-			///                         A field can be missing only if optional, i.e. encoded with `OPTIONAL_MISSING`
-			///                         or `OPTIONAL_PRESENT`.
-			///                         An optional field must be declared in the `field_infos` array
-			///                         passed to `decode_struct_begin`.
-			///
-			/// @return Returns the label id of the field that has been detected or `marshal_label_id_INVALID`
-			///         if no more fields are available.
-			virtual marshal_label_id_t decode_struct_field_begin(bool* optional_present = nullptr) override;
+			virtual marshal_label_id_t decode_struct_field_begin(bool* optional_present = nullptr) override {return m_core.decode_struct_field_begin(optional_present);}
 
 			/// @brief Terminate decoding a field within a structure
-			///
-			/// This must be invoked inside a `decode_struct_begin` and `decode_struct_end` pair.
-			/// See @link marshaling_structs documentation for details and examples.
-			virtual void decode_struct_field_end() override;
+			virtual void decode_struct_field_end() override {m_core.decode_struct_field_end();}
 
 			/// @brief Start decoding an array
-			/// @param count Number of elements that will be decoded
-			///
-			/// See @link marshaling_arrays documentation for details and examples.
-			///
-			/// @return Returns the expected number of elements or `marshal_array_SIZE_UNKNOWN`
-			///         if the size is unknown.
-			virtual size_t decode_array_begin() override;
+			virtual size_t decode_array_begin() override {return m_core.decode_array_begin();}
 
 			/// @brief Terminate decoding an array
-			///
-			/// See @link marshaling_arrays documentation for details and examples.
-			virtual void decode_array_end() override;
+			virtual void decode_array_end() override {m_core.decode_array_end();}
 
 			/// @brief Start decoding an array element
-			/// @param count Number of elements that will be decoded
-			///
-			/// See @link marshaling_arrays documentation for details and examples.
-			///
-			/// @return Returns `true` if the element is available or `false` if
-			///         no more elements are available.
-			virtual bool decode_array_element_begin() override;
+			virtual bool decode_array_element_begin() override {return m_core.decode_array_element_begin();}
 
 			/// @brief Terminate decoding an array element
-			///
-			/// See @link marshaling_arrays documentation for details and examples.
-			virtual void decode_array_element_end() override;
+			virtual void decode_array_element_end() override {m_core.decode_array_element_end();}
 
 			/// @brief Start decoding a dictionary
-			/// @param count Number of elements that will be decoded
-			///
-			/// See @link marshaling_dictionaries documentation for details and examples.
-			///
-			/// @return Returns the expected number of elements or `marshal_array_SIZE_UNKNOWN`
-			///         if the size is unknown.
-			virtual size_t decode_dictionary_begin() override;
+			virtual size_t decode_dictionary_begin() override {return m_core.decode_dictionary_begin();}
 
 			/// @brief Terminate decoding a dictionary
-			///
-			/// See @link marshaling_dictionaries documentation for details and examples.
-			virtual void decode_dictionary_end() override;
+			virtual void decode_dictionary_end() override {m_core.decode_dictionary_end();}
 
 			/// @brief Start decoding a dictionary element
-			/// @param key UTF-8 encoded string key that has been encoded along with the object
-			///
-			/// See @link marshaling_dictionaries documentation for details and examples.
-			///
-			/// @return Returns `true` if the element is available or `false` if
-			///         no more elements are available.
-			virtual bool decode_dictionary_element_begin(std::string& key) override;
+			virtual bool decode_dictionary_element_begin(std::string& key) override {return m_core.decode_dictionary_element_begin(key);}
 
 			/// @brief Terminate decoding a dictionary element
-			///
-			/// See @link marshaling_dictionaries documentation for details and examples.
-			virtual void decode_dictionary_element_end() override;
+			virtual void decode_dictionary_element_end() override {m_core.decode_dictionary_element_end();}
 
 			/// @brief Start decoding a typed object
-			/// @param extensible If true, the object is decoded in way that allows skipping it during decoding.
-			///
-			/// See @link marshaling_typeds documentation for details and examples.
-			///
-			/// @return Returns the label-id of the type of the object that is following
-			virtual marshal_label_id_t decode_typed_begin(bool extensible) override;
+			virtual marshal_label_id_t decode_typed_begin(bool extensible) override {return m_core.decode_typed_begin(extensible);}
 
 			/// @brief Skip the object without decoding it
-			///
-			/// This method will skip the object without decoding. It can be invoked only if
-			/// the `extensible` parameter is `true`. Useful when the encoding data comes from
-			/// a newer version that has new object types unknown to this version.
-			///
-			/// See @link marshaling_typeds documentation for details and examples.
-			virtual void decode_typed_end_skip() override;
+			virtual void decode_typed_end_skip() override {m_core.decode_typed_end_skip();}
 
 			/// @brief Terminate decoding a typed object
-			///
-			/// See @link marshaling_typeds documentation for details and examples.
-			virtual void decode_typed_end() override;
+			virtual void decode_typed_end() override {m_core.decode_typed_end();}
 
 		protected:
 			/// @brief Decode raw binary data of a known and fixed length
-			/// @param buffer Receives the raw decoded data
-			/// @param length Number of bytes expected
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual void internal_decode_binary(void* buffer, size_t length, uint32_t suggestions=0) override;
+			virtual void internal_decode_binary(void* buffer, size_t length, uint32_t suggestions=0) override {m_core.decode_binary(buffer, length, suggestions);}
 
 			/// @brief Decode raw binary data of a variable length
-			/// @param value Receives the raw decoded data
-			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-			virtual void internal_decode_varsize_binary(std::string& value, uint32_t suggestions=0) override;
+			virtual void internal_decode_varsize_binary(std::string& value, uint32_t suggestions=0) override {m_core.decode_varsize_binary(value, suggestions);}
+
+			/// @brief Decode a whole array of numbers
+			virtual void internal_decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions) override {m_core.decode_array_of(target, item, suggestions);}
+
+		private:
+			/// @brief Decoder doing the actual job
+			marshal_dec_bin_core<INPUT> m_core;
+	};
+
+	class marshal_dec_bin;
+
+	/// @brief Input policy calling the virtual methods of `marshal_dec_bin`
+	class marshal_bin_input_virtual {
+		public:
+			/// @brief Constructor
+			/// @param decoder Decoder implementing the virtual input methods
+			marshal_bin_input_virtual(marshal_dec_bin* decoder): m_decoder(decoder) {}
+
+			/// @brief Read the required amount of bytes
+			void read(void* target, size_t length);
+
+			/// @brief Skip the required amount of bytes
+			void skip(size_t length);
+
+			/// @brief Read the required amount of bytes into a string
+			void read_string(std::string& target, size_t length);
+
+		private:
+			/// @brief Decoder implementing the virtual input methods
+			marshal_dec_bin* m_decoder;
+	};
+
+	/// @brief Binary little-endian marshaling decoder
+	///
+	/// Decodes binary data using the binary little-endian encoding.
+	/// See @link marshaling_bin_format "Marshaling binary format" @endlink
+	/// for details on the binary encoding format.
+	///
+	/// The input is implemented by the derived classes through virtual
+	/// methods. Where the input is known at compile time, prefer
+	/// `marshal_dec_bin_core` (or `marshal_dec_bin_adapter`) with an input policy.
+	class marshal_dec_bin: public marshal_dec_bin_adapter<marshal_bin_input_virtual> {
+		friend class marshal_bin_input_virtual;
+
+		public:
+			/// @brief Constructor
+			marshal_dec_bin(): marshal_dec_bin_adapter(this) {}
 
+		protected:
 			/// @brief Read the required amount of bytes
 			///
 			/// Attempts to read the indicated number of bytes. If it fails, it
@@ -278,39 +189,32 @@ namespace dastd {
 			///
 			/// Attempts to skip the indicated number of bytes. If it fails, it
 			/// should throw an exception or report in other way.
-			/// Default implementation is trivial (reads a byte at the time).
+			/// Default implementation reads the data in chunks into a dummy buffer;
+			/// implementations able to seek should redefine it.
 			///
 			/// @param length The required number of bytes
 			virtual void skip_bytes_impl(size_t length) {
-				for(; length>0; length--) {uint8_t c; read_bytes_impl(&c, 1);}
-			}
-
-		private:
-			/// @brief Read the required amount of bytes
-			///
-			/// Attempts to read the indicated number of bytes. If it fails, it
-			/// should throw an exception or report in other way.
-			///
-			/// @param target The target buffer where to write the data
-			/// @param length The required number of bytes
-			void read_bytes(void* target, size_t length) {
-				read_bytes_impl(target, length);
-				m_offset += length;
+				uint8_t buf[256];
+				while (length > 0) {
+					size_t chunk = std::min(length, sizeof(buf));
+					read_bytes_impl(buf, chunk);
+					length -= chunk;
+				}
 			}
 
-			/// @brief Skip the required amount of bytes
+			/// @brief Read the required amount of bytes into a string
 			///
-			/// Attempts to skipthe indicated number of bytes. If it fails, it
-			/// should throw an exception or report in other way.
+			/// Attempts to read the indicated number of bytes replacing the content
+			/// of `target`. If it fails, it should throw an exception or report in other way.
+			/// Default implementation resizes the string and calls `read_bytes_impl`;
+			/// implementations having the data already in memory can copy it directly.
 			///
+			/// @param target The target string
 			/// @param length The required number of bytes
-			void skip_bytes(size_t length) {
-				skip_bytes_impl(length);
-				m_offset += length;
+			virtual void read_string_impl(std::string& target, size_t length) {
+				target.resize(length);
+				read_bytes_impl(target.data(), length);
 			}
-
-			/// @brief Decode a size indicaotr
-			size_t decode_size_indicator() {return (size_t)decode_u32();}
 	};
 
 	/// @brief Binary little-endian marshaling decoder
@@ -321,7 +225,7 @@ namespace dastd {
 		public:
 			/// @brief Constructor
 			/// @param output Binary output stream; make sure it does no ASCII transaltions.
-			marshal_dec_bin_istream(std::istream& input): m_input(input) {}
+			marshal_dec_bin_istream(std::istream& input): m_input(input), m_input_policy(input) {}
 
 			/// @brief Read the required amount of bytes
 			///
@@ -332,9 +236,21 @@ namespace dastd {
 			/// @param length The required number of bytes
 			virtual void read_bytes_impl(void* target, size_t length) override;
 
+			/// @brief Skip the required amount of bytes
+			///
+			/// Short skips are extracted from the stream buffer with `ignore`; longer
+			/// ones move the reading position checking it against the end of the stream,
+			/// located once. See `marshal_bin_input_istream::skip`.
+			///
+			/// @param length The required number of bytes
+			virtual void skip_bytes_impl(size_t length) override;
+
 		protected:
 			/// @brief Binary output stream
 			std::istream& m_input;
+
+			/// @brief Input policy on `m_input`, keeping the end of the stream across skips
+			marshal_bin_input_istream m_input_policy;
 	};
 
 	/// @brief Binary little-endian marshaling decoder
@@ -357,6 +273,23 @@ namespace dastd {
 			/// @param length The required number of bytes
 			virtual void read_bytes_impl(void* target, size_t length) override;
 
+			/// @brief Read the required amount of bytes into a string
+			///
+			/// If the source exposes its data in memory (see `source::tentative_window`),
+			/// the string is assigned directly from there.
+			///
+			/// @param target The target string
+			/// @param length The required number of bytes
+			virtual void read_string_impl(std::string& target, size_t length) override;
+
+			/// @brief Skip the required amount of bytes
+			///
+			/// Skips the data with a single `tentative_discard` call, which
+			/// is constant time on in-memory sources.
+			///
+			/// @param length The required number of bytes
+			virtual void skip_bytes_impl(size_t length) override;
+
 	protected:
 			/// @brief Binary output stream
 			dastd::source<CHARTYPE>& m_input;
@@ -0,0 +1,576 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "marshal_dec.hpp"
+#include "marshal_bin.hpp"
+#include "source.hpp"
+#include <limits>
+#include <stack>
+#include <vector>
+
+namespace dastd {
+
+	/// @brief Input policy of `marshal_dec_bin_core`
+	///
+	/// The policy reads exactly the requested number of bytes (`read`),
+	/// skips them (`skip`) or reads them replacing the content of a
+	/// string (`read_string`). In all cases, it throws an exception if
+	/// not enough data is available.
+	///
+	/// See `marshal_bin_input_membuf`, `marshal_bin_input_istream` and
+	/// `marshal_bin_input_source` below.
+	template<class INPUT>
+	concept marshal_bin_input = requires(INPUT& input, void* target, std::string& str, size_t length) {
+		input.read(target, length);
+		input.skip(length);
+		input.read_string(str, length);
+	};
+
+	/// @brief Binary little-endian marshaling decoder with no virtual methods
+	///
+	/// Decodes binary data using the binary little-endian encoding, exactly
+	/// like `marshal_dec_bin`, but the input is a policy class known at compile
+	/// time instead of a set of virtual methods. This way, the whole decoding path
+	/// from `decode_u32` down to the `memcpy` from the input buffer can be inlined
+	/// by the compiler.
+	///
+	/// Since this class does not derive from `marshal_dec`, it can not be passed
+	/// to functions expecting a `marshal_dec&`: use `marshal_dec_bin_adapter`
+	/// for that, or write the decoding functions as templates.
+	///
+	/// Example:
+	///
+	///     dastd::marshal_dec_bin_core<dastd::marshal_bin_input_membuf> dec(msg.data(), msg.size());
+	///     uint32_t value = dec.decode_u32();
+	///
+	/// @tparam INPUT Input policy; it can be a reference type
+	template<marshal_bin_input INPUT>
+	class marshal_dec_bin_core {
+		private:
+			/// @brief Stack element
+			struct stack_element {
+				/// @brief Type of the element on the stack
+				marshal_bin_element_type m_element_type;
+
+				/// @brief True if extensible
+				bool m_extensible = false;
+
+				/// @brief Offset where the element is expected to terminate.
+				///
+				/// This is the position of the first byte that is not part of
+				/// the current object. It is calculated only if "m_extensible" is
+				/// set to true.
+				size_t m_end_offset = 0;
+
+				/// @brief Used by structures; contains the list of expected fields
+				const marshal_label_info_t* m_field_infos = nullptr;
+
+				/// @brief Used by structures; indicates the position the number of elements
+				/// in the `m_field_infos` array.
+				/// In case of arrays, it contains the number of elements.
+				size_t m_fields_count = 0;
+
+				/// @brief Used by structures; indicates the position of the next structure
+				/// field.
+				/// In case of arrays, it contains the current of elements.
+				size_t m_field_pos = 0;
+
+				/// @brief Constructor
+				stack_element(marshal_bin_element_type element_type):
+					m_element_type(element_type) {}
+
+				/// @brief Constructor
+				stack_element(marshal_bin_element_type element_type, size_t fields_count):
+					m_element_type(element_type), m_fields_count(fields_count) {}
+
+				/// @brief Constructor
+				stack_element(marshal_bin_element_type element_type, bool extensible, size_t end_offset):
+					m_element_type(element_type), m_extensible(extensible), m_end_offset(end_offset) {}
+
+				/// @brief Constructor
+				stack_element(marshal_bin_element_type element_type, bool extensible, size_t end_offset, const marshal_label_info_t* field_infos, size_t fields_count):
+					m_element_type(element_type), m_extensible(extensible), m_end_offset(end_offset),
+					m_field_infos(field_infos), m_fields_count(fields_count) {}
+
+				/// @brief Constructor
+				stack_element() {}
+			};
+
+			/// @brief Internal encoding stack
+			std::stack<stack_element> m_stack;
+
+			/// @brief Bytes read so far
+			size_t m_offset = 0;
+
+			/// @brief Input policy
+			INPUT m_input;
+
+		public:
+			/// @brief Constructor
+			/// @param args Arguments passed to the constructor of the input policy
+			template<class... ARGS>
+			explicit marshal_dec_bin_core(ARGS&&... args): m_input(std::forward<ARGS>(args)...) {}
+
+			/// @brief Copy not allowed
+			marshal_dec_bin_core(const marshal_dec_bin_core&) = delete;
+
+			/// @brief Copy not allowed
+			marshal_dec_bin_core& operator=(const marshal_dec_bin_core&) = delete;
+
+			/// @brief Access the input policy
+			std::remove_reference_t<INPUT>& input() {return m_input;}
+
+			/// @brief Template for decoding integral types
+			/// @tparam TYPE Integral type
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			template<marshal_integral_types TYPE>
+			TYPE decode(uint32_t suggestions=0);
+
+			/// @brief Decode a bool
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			bool decode_bool(uint32_t suggestions=0);
+
+			/// @brief Decode a uint8_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			uint8_t decode_u8(uint32_t suggestions=0);
+
+			/// @brief Decode a int8_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			int8_t decode_i8(uint32_t suggestions=0);
+
+			/// @brief Decode a uint16_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			uint16_t decode_u16(uint32_t suggestions=0);
+
+			/// @brief Decode a int16_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			int16_t decode_i16(uint32_t suggestions=0);
+
+			/// @brief Decode a uint32_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			uint32_t decode_u32(uint32_t suggestions=0);
+
+			/// @brief Decode a int32_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			int32_t decode_i32(uint32_t suggestions=0);
+
+			/// @brief Decode a uint64_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			uint64_t decode_u64(uint32_t suggestions=0);
+
+			/// @brief Decode a int64_t
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			int64_t decode_i64(uint32_t suggestions=0);
+
+			/// @brief Decode a 64-bit floating point
+			/// @return Return the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			double decode_f64(uint32_t suggestions=0);
+
+			/// @brief Decode a std::string (UTF-8)
+			/// @param value Receives the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			void decode_string_utf8(std::string& value, uint32_t suggestions=0);
+
+			/// @brief Decode a std::u32string
+			/// @param value Receives the decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			void decode_u32string(std::u32string& value, uint32_t suggestions=0);
+
+			/// @brief Start Decoding a structure
+			/// @param extensible If true, the structure will be encoded so more or less fields can be expected.
+			/// @param field_infos Array with the label-ids of the expected fields in their correct order and a marker telling if that field is optional.
+			/// @param field_infos_count Number of elements to be expected in the field_ids array.
+			///
+			/// See @link marshaling_structs documentation for details and examples.
+			void decode_struct_begin(bool extensible, const marshal_label_info_t* field_infos, size_t fields_infos_count);
+
+			/// @brief Terminate Decoding a structure
+			///
+			/// See @link marshaling_structs documentation for details and examples.
+			void decode_struct_end();
+
+			/// @brief Start decoding a field within a structure
+			///
+			/// This must be invoked inside a `decode_struct_begin` and `decode_struct_end` pair.
+			///
+			/// It extracts a field from the structure and returns its label id. Depending on the
+			/// encoding format, the fields can be out of order, dupe, missing or unknown.
+			/// If the encoding type allows dupe or unknown fields, the `decode_struct_field_skip()`
+			/// method will be available for skipping the unwanted fields.
+			///
+			/// See @link marshaling_structs documentation for details and examples.
+			///
+			/// @param optional_present This flag is set to `true` if the field is present, or `false`
+			///                         if missing.
+			///                         A field can be missing only if optional, i.e. encoded with `OPTIONAL_MISSING`
+			///                         or `OPTIONAL_PRESENT`.
+			///                         An optional field must be declared in the `field_infos` array
+			///                         passed to `decode_struct_begin`.
+			///
+			/// @return Returns the label id of the field that has been detected or `marshal_label_id_INVALID`
+			///         if no more fields are available.
+			marshal_label_id_t decode_struct_field_begin(bool* optional_present = nullptr);
+
+			/// @brief Terminate decoding a field within a structure
+			///
+			/// This must be invoked inside a `decode_struct_begin` and `decode_struct_end` pair.
+			/// See @link marshaling_structs documentation for details and examples.
+			void decode_struct_field_end();
+
+			/// @brief Start decoding an array
+			/// @param count Number of elements that will be decoded
+			///
+			/// See @link marshaling_arrays documentation for details and examples.
+			///
+			/// @return Returns the expected number of elements or `marshal_array_SIZE_UNKNOWN`
+			///         if the size is unknown.
+			size_t decode_array_begin();
+
+			/// @brief Terminate decoding an array
+			///
+			/// See @link marshaling_arrays documentation for details and examples.
+			void decode_array_end();
+
+			/// @brief Start decoding an array element
+			/// @param count Number of elements that will be decoded
+			///
+			/// See @link marshaling_arrays documentation for details and examples.
+			///
+			/// @return Returns `true` if the element is available or `false` if
+			///         no more elements are available.
+			bool decode_array_element_begin();
+
+			/// @brief Terminate decoding an array element
+			///
+			/// See @link marshaling_arrays documentation for details and examples.
+			void decode_array_element_end();
+
+			/// @brief Decode a whole array of numbers
+			/// @param values Receives the decoded elements; the previous content is replaced
+			/// @param suggestions Encoding suggestions applied to each element; see @link marshaling_suggestions documentation @endlink.
+			///
+			/// See @link marshaling_arrays documentation for details and examples.
+			template<marshal_array_item_types TYPE>
+			void decode_array_of(std::vector<TYPE>& values, uint32_t suggestions=0) {decode_array_of(marshal_array_target(values), marshal_array_item_of<TYPE>(), suggestions);}
+
+			/// @brief Decode a whole array of numbers
+			///
+			/// On little-endian hosts, unless the elements are encoded as varint,
+			/// the elements are read directly into the target vector. The vector
+			/// is grown in blocks while reading, so a corrupted element count
+			/// can not cause a huge allocation before the data is actually read.
+			///
+			/// @param target Vector receiving the elements
+			/// @param item Type of the elements
+			/// @param suggestions Encoding suggestions applied to each element; see @link marshaling_suggestions documentation @endlink.
+			void decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions=0);
+
+			/// @brief Start decoding a dictionary
+			/// @param count Number of elements that will be decoded
+			///
+			/// See @link marshaling_dictionaries documentation for details and examples.
+			///
+			/// @return Returns the expected number of elements or `marshal_array_SIZE_UNKNOWN`
+			///         if the size is unknown.
+			size_t decode_dictionary_begin();
+
+			/// @brief Terminate decoding a dictionary
+			///
+			/// See @link marshaling_dictionaries documentation for details and examples.
+			void decode_dictionary_end();
+
+			/// @brief Start decoding a dictionary element
+			/// @param key UTF-8 encoded string key that has been encoded along with the object
+			///
+			/// See @link marshaling_dictionaries documentation for details and examples.
+			///
+			/// @return Returns `true` if the element is available or `false` if
+			///         no more elements are available.
+			bool decode_dictionary_element_begin(std::string& key);
+
+			/// @brief Terminate decoding a dictionary element
+			///
+			/// See @link marshaling_dictionaries documentation for details and examples.
+			void decode_dictionary_element_end();
+
+			/// @brief Start decoding a typed object
+			/// @param extensible If true, the object is decoded in way that allows skipping it during decoding.
+			///
+			/// See @link marshaling_typeds documentation for details and examples.
+			///
+			/// @return Returns the label-id of the type of the object that is following
+			marshal_label_id_t decode_typed_begin(bool extensible);
+
+			/// @brief Skip the object without decoding it
+			///
+			/// This method will skip the object without decoding. It can be invoked only if
+			/// the `extensible` parameter is `true`. Useful when the encoding data comes from
+			/// a newer version that has new object types unknown to this version.
+			///
+			/// See @link marshaling_typeds documentation for details and examples.
+			void decode_typed_end_skip();
+
+			/// @brief Terminate decoding a typed object
+			///
+			/// See @link marshaling_typeds documentation for details and examples.
+			void decode_typed_end();
+
+			/// @brief Decode raw binary data of a known and fixed length
+			/// @param buffer Receives the raw decoded data
+			/// @param length Number of bytes expected
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			void decode_binary(void* buffer, size_t length, uint32_t suggestions=0);
+
+			/// @brief Decode raw binary data of a known and fixed length
+			/// @param value Receives the raw decoded data
+			/// @param length Number of bytes expected
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			void decode_binary(std::string& value, size_t length, uint32_t suggestions=0) {DASTD_NOWARN_UNUSED(suggestions); read_string(value, length);}
+
+			/// @brief Decode raw binary data of a variable length
+			/// @param value Receives the raw decoded data
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			void decode_varsize_binary(std::string& value, uint32_t suggestions=0);
+
+			/// @brief Select the decoding format
+			///
+			/// The format can be changed only between two root elements and
+			/// must match the one used by the encoder.
+			///
+			/// @param format Format of the following elements
+			void set_format(marshal_bin_format format) {assert(m_stack.empty()); m_format = format;}
+
+			/// @brief Return the current decoding format
+			marshal_bin_format get_format() const {return m_format;}
+
+			/// @brief Read the format header and switch to the indicated format
+			/// @throw dastd::exception_marshal if the header is not valid or the format is unknown
+			void decode_format_header();
+
+		private:
+			/// @brief Decoding format
+			marshal_bin_format m_format = marshal_bin_format::FIXED;
+
+			/// @brief Tells whether an integer has been encoded as varint
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			/// @param type_size Size in bytes of the integral type
+			/// @param is_signed True if the integral type is signed
+			bool use_varint(uint32_t suggestions, size_t type_size, bool is_signed) const {return (m_format == marshal_bin_format::COMPACT) && marshal_bin_varint_suggested(suggestions, type_size, is_signed);}
+
+			/// @brief Decode a LEB128 varint
+			/// @throw dastd::exception_marshal if the varint is longer than 64 bits
+			uint64_t decode_varint();
+
+			/// @brief Decode a varint checking that it fits the given type
+			/// @tparam TYPE Integral type; if signed, the varint is zigzag-decoded
+			/// @throw dastd::exception_marshal if the value is out of range
+			template<class TYPE>
+			TYPE decode_varint_as();
+
+			/// @brief Read the required amount of bytes
+			///
+			/// Attempts to read the indicated number of bytes. If it fails, it
+			/// should throw an exception or report in other way.
+			///
+			/// @param target The target buffer where to write the data
+			/// @param length The required number of bytes
+			void read_bytes(void* target, size_t length) {
+				m_input.read(target, length);
+				m_offset += length;
+			}
+
+			/// @brief Skip the required amount of bytes
+			///
+			/// Attempts to skipthe indicated number of bytes. If it fails, it
+			/// should throw an exception or report in other way.
+			///
+			/// @param length The required number of bytes
+			void skip_bytes(size_t length) {
+				m_input.skip(length);
+				m_offset += length;
+			}
+
+			/// @brief Read the required amount of bytes into a string
+			///
+			/// Attempts to read the indicated number of bytes. If it fails, it
+			/// should throw an exception or report in other way.
+			///
+			/// @param target The target string
+			/// @param length The required number of bytes
+			void read_string(std::string& target, size_t length) {
+				m_input.read_string(target, length);
+				m_offset += length;
+			}
+
+			/// @brief Decode a size indicaotr
+			size_t decode_size_indicator() {
+				if (m_format == marshal_bin_format::COMPACT) return decode_varint_as<size_t>();
+				return (size_t)decode_u32();
+			}
+
+			/// @brief Decode a back-patched size indicator; it is always a fixed-size u32
+			size_t decode_patched_size_indicator() {return (size_t)decode_u32();}
+	};
+
+	/// @brief Input policy reading a contiguous memory buffer
+	///
+	/// The strings are assigned directly from the buffer and skipping
+	/// just moves the current position.
+	class marshal_bin_input_membuf {
+		public:
+			/// @brief Constructor
+			/// @param data Encoded data; it must outlive this object
+			/// @param size Size of the encoded data
+			marshal_bin_input_membuf(const void* data, size_t size): m_data((const char*)data), m_size(size) {}
+
+			/// @brief Constructor
+			/// @param data Encoded data; it must outlive this object
+			marshal_bin_input_membuf(const std::string& data): marshal_bin_input_membuf(data.data(), data.size()) {}
+
+			/// @brief Number of bytes still to be decoded
+			size_t remaining() const {return m_size - m_pos;}
+
+			/// @brief Read the required amount of bytes
+			/// @param target The target buffer where to write the data
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal if not enough data is available
+			void read(void* target, size_t length) {
+				check(length);
+				memcpy(target, m_data + m_pos, length);
+				m_pos += length;
+			}
+
+			/// @brief Skip the required amount of bytes
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal if not enough data is available
+			void skip(size_t length) {check(length); m_pos += length;}
+
+			/// @brief Read the required amount of bytes into a string
+			/// @param target The target string
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal if not enough data is available
+			void read_string(std::string& target, size_t length) {
+				check(length);
+				target.assign(m_data + m_pos, length);
+				m_pos += length;
+			}
+
+		private:
+			/// @brief Make sure `length` bytes are available
+			void check(size_t length) const {
+				if (length > remaining()) {
+					DASTD_THROW(exception_marshal, "marshal_bin_input_membuf failed reading " << length << " bytes; only " << remaining() << " available")
+				}
+			}
+
+			/// @brief Encoded data
+			const char* m_data;
+
+			/// @brief Size of the encoded data
+			size_t m_size;
+
+			/// @brief Current reading position
+			size_t m_pos = 0;
+	};
+
+	/// @brief Input policy reading a std::istream
+	class marshal_bin_input_istream {
+		public:
+			/// @brief Constructor
+			/// @param input Binary input stream; make sure it does no ASCII transaltions.
+			marshal_bin_input_istream(std::istream& input): m_input(input) {}
+
+			/// @brief Skips up to this number of bytes are extracted instead of seeking
+			static constexpr size_t SHORT_SKIP_LENGTH = 4096;
+
+			/// @brief Read the required amount of bytes
+			/// @param target The target buffer where to write the data
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal
+			void read(void* target, size_t length);
+
+			/// @brief Skip the required amount of bytes
+			///
+			/// Up to `SHORT_SKIP_LENGTH` bytes are extracted with `ignore` from the
+			/// stream buffer. Longer skips move the reading position directly, checking
+			/// it against the end of the stream; if the stream is not seekable, the bytes
+			/// are extracted with `ignore` as well. The end of the stream is located
+			/// at the first long skip only, so data appended to the stream later can
+			/// not be skipped by seeking.
+			///
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal
+			void skip(size_t length);
+
+			/// @brief Read the required amount of bytes into a string
+			/// @param target The target string
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal
+			void read_string(std::string& target, size_t length) {target.resize(length); read(target.data(), length);}
+
+		private:
+			/// @brief Binary input stream
+			std::istream& m_input;
+
+			/// @brief True once `m_end` has been computed
+			bool m_end_known = false;
+
+			/// @brief End of the stream or -1 if the stream is not seekable
+			std::streampos m_end = -1;
+	};
+
+	/// @brief Input policy reading a dastd::source
+	template<concept_integral_8bit CHARTYPE>
+	class marshal_bin_input_source {
+		public:
+			/// @brief Constructor
+			/// @param input Source of the encoded data
+			marshal_bin_input_source(source<CHARTYPE>& input): m_input(input) {}
+
+			/// @brief Read the required amount of bytes
+			/// @param target The target buffer where to write the data
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal
+			void read(void* target, size_t length);
+
+			/// @brief Skip the required amount of bytes
+			///
+			/// Skips the data with a single `tentative_discard` call, which
+			/// is constant time on in-memory sources.
+			///
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal
+			void skip(size_t length);
+
+			/// @brief Read the required amount of bytes into a string
+			///
+			/// If the source exposes its data in memory (see `source::tentative_window`),
+			/// the string is assigned directly from there.
+			///
+			/// @param target The target string
+			/// @param length The required number of bytes
+			/// @throw dastd::exception_marshal
+			void read_string(std::string& target, size_t length);
+
+		private:
+			/// @brief Source of the encoded data
+			source<CHARTYPE>& m_input;
+	};
+
+} // namespace dastd
+#define INCLUDE_dastd_marshal_dec_bin_core_inline
+#include "marshal_dec_bin_core__inline.hpp"
+#undef INCLUDE_dastd_marshal_dec_bin_core_inline
@@ -0,0 +1,670 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#if defined INCLUDE_dastd_marshal_dec_bin_core_inline && !defined dastd_marshal_dec_bin_core_inline
+#define dastd_marshal_dec_bin_core_inline
+
+#include "marshal_dec_bin_core.hpp"
+#include "endian_aware.hpp"
+#include "utf8.hpp"
+#include "float.hpp"
+
+namespace dastd {
+
+// Template for decoding integral types
+template<marshal_bin_input INPUT>
+template<marshal_integral_types TYPE>
+inline TYPE marshal_dec_bin_core<INPUT>::decode(uint32_t suggestions)
+{
+	if constexpr (std::is_same_v<TYPE, bool>) {
+		return static_cast<TYPE>(decode_bool(suggestions));
+	}
+	else if constexpr (std::is_signed_v<TYPE>) {
+		if constexpr (sizeof(TYPE) == 1) return static_cast<TYPE>(decode_i8(suggestions));
+		else if constexpr (sizeof(TYPE) == 2) return static_cast<TYPE>(decode_i16(suggestions));
+		else if constexpr (sizeof(TYPE) == 4) return static_cast<TYPE>(decode_i32(suggestions));
+		else if constexpr (sizeof(TYPE) == 8) return static_cast<TYPE>(decode_i64(suggestions));
+	}
+	else {
+		if constexpr (sizeof(TYPE) == 1) return static_cast<TYPE>(decode_u8(suggestions));
+		else if constexpr (sizeof(TYPE) == 2) return static_cast<TYPE>(decode_u16(suggestions));
+		else if constexpr (sizeof(TYPE) == 4) return static_cast<TYPE>(decode_u32(suggestions));
+		else if constexpr (sizeof(TYPE) == 8) return static_cast<TYPE>(decode_u64(suggestions));
+	}
+}
+
+// Decode a bool
+template<marshal_bin_input INPUT>
+inline bool marshal_dec_bin_core<INPUT>::decode_bool(uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	uint8_t value;
+	read_bytes(&value, sizeof(value));
+	return (value != 0);
+}
+
+// Decode a uint8_t
+template<marshal_bin_input INPUT>
+inline uint8_t marshal_dec_bin_core<INPUT>::decode_u8(uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	uint8_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a int8_t
+template<marshal_bin_input INPUT>
+inline int8_t marshal_dec_bin_core<INPUT>::decode_i8(uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	int8_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a uint16_t
+template<marshal_bin_input INPUT>
+inline uint16_t marshal_dec_bin_core<INPUT>::decode_u16(uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(uint16_t), false)) return decode_varint_as<uint16_t>();
+	uint16_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a int16_t
+template<marshal_bin_input INPUT>
+inline int16_t marshal_dec_bin_core<INPUT>::decode_i16(uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(int16_t), true)) return decode_varint_as<int16_t>();
+	int16_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a uint32_t
+template<marshal_bin_input INPUT>
+inline uint32_t marshal_dec_bin_core<INPUT>::decode_u32(uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(uint32_t), false)) return decode_varint_as<uint32_t>();
+	uint32_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a int32_t
+template<marshal_bin_input INPUT>
+inline int32_t marshal_dec_bin_core<INPUT>::decode_i32(uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(int32_t), true)) return decode_varint_as<int32_t>();
+	int32_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a uint64_t
+template<marshal_bin_input INPUT>
+inline uint64_t marshal_dec_bin_core<INPUT>::decode_u64(uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(uint64_t), false)) return decode_varint_as<uint64_t>();
+	uint64_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+// Decode a int64_t
+template<marshal_bin_input INPUT>
+inline int64_t marshal_dec_bin_core<INPUT>::decode_i64(uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(int64_t), true)) return decode_varint_as<int64_t>();
+	int64_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return value;
+}
+
+//  Decode a 64-bit floating point
+template<marshal_bin_input INPUT>
+inline double marshal_dec_bin_core<INPUT>::decode_f64(uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	int64_t value;
+	uint8_t encoded[sizeof(value)];
+	read_bytes(encoded, sizeof(value));
+	little_endian_to_native(encoded, value);
+	return unpack_f64(value);
+}
+
+
+// Decode a std::string (UTF-8)
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_string_utf8(std::string& value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	uint32_t length;
+	length = decode_u32(marshal_suggest_increasing);
+
+	read_string(value, length);
+}
+
+// Decode a std::u32string
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_u32string(std::u32string& value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+
+	uint32_t length;
+	length = decode_u32(marshal_suggest_increasing);
+	value.clear();
+
+	// The "length" parameter is the number of bytes. Since the the string
+	// is UTF-8 encoded, the value of "length" can be greater than the
+	// actual char32_t string. However, it is a safe value to prepare.
+	value.reserve(length);
+
+	// Read the string decoding UTF-8
+	uint8_t tmp_buf[UTF8_CHAR_MAX_LEN+1];
+	char32_t ch32;
+	uint8_t ch;
+	size_t i;
+	for (i=0; i<length; i++) {
+		read_bytes(&ch, 1);
+		size_t extra_chars = count_utf8_following_chars(ch);
+
+		if (extra_chars == 0) {
+			value.push_back((char32_t)ch);
+		}
+		else {
+			// If the length does not include enough characters, throw an exception
+			// It means that the UTF-8 string is badly formed. The first character
+			// has been already read, so only `length-i-1` are left.
+			if (extra_chars > length-i-1) {
+				DASTD_THROW(exception_marshal, "marshal_dec_bin::decode_u32string expected " << extra_chars << " characters to complete UTF-8, but only " << (length-i-1) << " were available according to length")
+			}
+			memset(tmp_buf, 0, sizeof(tmp_buf));
+			tmp_buf[0] = ch;
+			read_bytes(tmp_buf+1, extra_chars);
+			//tmp_buf[extra_chars+1] = '\0';
+			DASTD_DEBUG(size_t debug_size = )read_utf8_asciiz(tmp_buf, ch32);
+			assert(debug_size == ((size_t)(extra_chars+1)));
+			value.push_back(ch32);
+
+			i += extra_chars;
+		}
+	}
+}
+
+// Start Decoding a structure
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_struct_begin(bool extensible, const marshal_label_info_t* field_infos, size_t fields_infos_count)
+{
+	if (!m_stack.empty()) {
+		if (m_stack.top().m_element_type == marshal_bin_element_type::STRUCT) DASTD_THROW(exception_marshal, "Invoked decode_struct_begin inside a STRUCT; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::ARRAY) DASTD_THROW(exception_marshal, "Invoked decode_struct_begin inside an ARRAY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY) DASTD_THROW(exception_marshal, "Invoked decode_struct_begin inside a DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+	}
+
+	size_t length = 0;
+	if (extensible) length = decode_patched_size_indicator();
+
+	// marshal_bin_element_type element_type, bool extensible, size_t element_offset, size_t element_size, const marshal_label_id_t* field_ids, size_t fields_count
+	m_stack.emplace(marshal_bin_element_type::STRUCT, extensible, m_offset+length, field_infos, fields_infos_count);
+}
+
+// Terminate Decoding a structure
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_struct_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_struct_end without being inside a STRUCT (stack empty)");
+
+	const stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::STRUCT) DASTD_THROW(exception_marshal, "Invoked decode_struct_end without being inside a STRUCT but inside a " << cur_stack.m_element_type);
+
+	// If the structure is extensible, we must skip the remaining data
+	if (cur_stack.m_extensible) {
+		if (m_offset < cur_stack.m_end_offset) skip_bytes(cur_stack.m_end_offset - m_offset);
+		else if (m_offset > cur_stack.m_end_offset) DASTD_THROW(exception_marshal, "Too many bytes read invoking decode_struct_end; end expected at " << cur_stack.m_end_offset << " but current offset is " << m_offset);
+	}
+
+	m_stack.pop();
+}
+
+// Start decoding a field within a structure
+template<marshal_bin_input INPUT>
+inline marshal_label_id_t marshal_dec_bin_core<INPUT>::decode_struct_field_begin(bool* optional_present)
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_struct_field_begin without being inside a struct (stack empty)");
+	if (m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) DASTD_THROW(exception_marshal, "Invoked decode_struct_field_begin without being inside a STRUCT but inside a " << m_stack.top().m_element_type);
+
+	stack_element& cur_stack = m_stack.top();
+
+	// Make sure we are no reading too many fields
+	if (cur_stack.m_field_pos >= cur_stack.m_fields_count) {
+		//DASTD_THROW(exception_marshal, "Invoked decode_struct_field_end too many times");
+		return marshal_label_id_INVALID;
+	}
+
+	// If the structure is extensible and we ran out of data, it
+	// means that the code is expecting more fields than the data provides.
+	// This might mean that the data has been produced with an older version
+	// of the code.
+	if (cur_stack.m_extensible) {
+		if (cur_stack.m_end_offset == m_offset) return marshal_label_id_INVALID;
+		if (cur_stack.m_end_offset < m_offset) DASTD_THROW(exception_marshal, "Invoking decode_struct_field_end, m_end_offset (" << cur_stack.m_end_offset << ") is less than m_offset (" << m_offset << ")");
+	}
+
+	marshal_label_info_t label_info = cur_stack.m_field_infos[cur_stack.m_field_pos];
+	marshal_label_id_t label_id = marshal_label_info_to_id(label_info);
+	bool is_optional = marshal_label_info_is_optional(label_info);
+	cur_stack.m_field_pos++;
+
+	m_stack.emplace(marshal_bin_element_type::FIELD);
+
+	// If marked as optional, decode the boolean telling whether the field is present or not
+	if (is_optional) {
+		assert(optional_present != nullptr);
+		(*optional_present) = decode_bool();
+	}
+	else if (optional_present) (*optional_present)=true;
+
+	return label_id;
+}
+
+// Terminate decoding a field within a structure
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_struct_field_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_struct_field_end without being inside a FIELD (stack empty)");
+	if (m_stack.top().m_element_type != marshal_bin_element_type::FIELD) DASTD_THROW(exception_marshal, "Invoked decode_struct_field_end without being inside a FIELD but inside a " << m_stack.top().m_element_type);
+
+	const stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::FIELD) DASTD_THROW(exception_marshal, "Invoked decode_struct_field_end without being inside a FIELD but inside a " << cur_stack.m_element_type);
+
+	m_stack.pop();
+}
+
+// Start decoding an array
+template<marshal_bin_input INPUT>
+inline size_t marshal_dec_bin_core<INPUT>::decode_array_begin()
+{
+	if (!m_stack.empty()) {
+		if (m_stack.top().m_element_type == marshal_bin_element_type::STRUCT) DASTD_THROW(exception_marshal, "Invoked decode_array_begin inside a STRUCT; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::ARRAY) DASTD_THROW(exception_marshal, "Invoked decode_array_begin inside an ARRAY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY) DASTD_THROW(exception_marshal, "Invoked decode_array_begin inside a DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+	}
+
+	// Get the number of elements
+	size_t no_of_elements = decode_size_indicator();
+
+	m_stack.emplace(marshal_bin_element_type::ARRAY, no_of_elements);
+
+	return 0;
+}
+
+// Terminate decoding an array
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_array_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_array_end without being inside a ARRAY (stack empty)");
+
+	const stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::ARRAY) DASTD_THROW(exception_marshal, "Invoked decode_array_end without being inside a ARRAY but inside a " << cur_stack.m_element_type);
+	if (cur_stack.m_field_pos != cur_stack.m_fields_count) DASTD_THROW(exception_marshal, "Invoked decode_array_end with " << cur_stack.m_field_pos << " fields exttracted out of " << cur_stack.m_fields_count);
+
+	m_stack.pop();
+}
+
+// Start decoding an array element
+template<marshal_bin_input INPUT>
+inline bool marshal_dec_bin_core<INPUT>::decode_array_element_begin()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_array_element_begin without being inside a ARRAY (stack empty)");
+
+	stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::ARRAY) DASTD_THROW(exception_marshal, "Invoked decode_array_element_begin without being inside a ARRAY but inside a " << cur_stack.m_element_type);
+	if (cur_stack.m_field_pos >= cur_stack.m_fields_count) return false;
+	cur_stack.m_field_pos++;
+	m_stack.emplace(marshal_bin_element_type::ARRAY_ELEMENT);
+	return true;
+}
+
+// Terminate decoding an array element
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_array_element_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_array_element_end without being inside a ARRAY_ELEMENT (stack empty)");
+	if (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY_ELEMENT) DASTD_THROW(exception_marshal, "Invoked decode_array_element_end without being inside a ARRAY_ELEMENT but inside a " << m_stack.top().m_element_type);
+	m_stack.pop();
+}
+
+// Decode a whole array of numbers
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions)
+{
+	decode_array_begin();
+	size_t count = m_stack.top().m_fields_count;
+	marshal_array_item_dispatch(item, [&](auto* tag) {
+		using ITEM = std::remove_pointer_t<decltype(tag)>;
+		constexpr size_t block_count = 65536/sizeof(ITEM);
+		target.resize(0);
+		for (size_t i=0; i<count; i+=block_count) {
+			size_t n = std::min(block_count, count-i);
+			uint8_t* ptr = (uint8_t*)target.resize(i+n)+i*sizeof(ITEM);
+
+			// Varints must be decoded one by one
+			if constexpr (std::is_integral_v<ITEM> && (sizeof(ITEM) > 1)) {
+				if (use_varint(suggestions, sizeof(ITEM), std::is_signed_v<ITEM>)) {
+					for (size_t j=0; j<n; j++) {
+						ITEM value = decode<ITEM>(suggestions);
+						memcpy(ptr+j*sizeof(ITEM), &value, sizeof(ITEM));
+					}
+					continue;
+				}
+			}
+
+			read_bytes(ptr, n*sizeof(ITEM));
+
+			// The in-memory representation is already the encoded one
+			#ifdef DASTD_LITTLE_ENDIAN
+			if constexpr (std::is_integral_v<ITEM> || std::numeric_limits<ITEM>::is_iec559) continue;
+			#endif
+
+			for (size_t j=0; j<n; j++) {
+				if constexpr (std::is_same_v<ITEM, double>) {
+					int64_t packed;
+					little_endian_to_native(ptr+j*sizeof(ITEM), packed);
+					double value = unpack_f64(packed);
+					memcpy(ptr+j*sizeof(ITEM), &value, sizeof(ITEM));
+				}
+				else {
+					ITEM value;
+					little_endian_to_native(ptr+j*sizeof(ITEM), value);
+					memcpy(ptr+j*sizeof(ITEM), &value, sizeof(ITEM));
+				}
+			}
+		}
+	});
+	m_stack.top().m_field_pos = count;
+	decode_array_end();
+}
+
+// Start decoding an dictionary
+template<marshal_bin_input INPUT>
+inline size_t marshal_dec_bin_core<INPUT>::decode_dictionary_begin()
+{
+	if (!m_stack.empty()) {
+		if (m_stack.top().m_element_type == marshal_bin_element_type::STRUCT) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_begin inside a STRUCT; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::ARRAY) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_begin inside an AR RAY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_begin inside a DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+	}
+
+	// Get the number of elements
+	size_t no_of_elements = decode_size_indicator();
+
+	m_stack.emplace(marshal_bin_element_type::DICTIONARY, no_of_elements);
+
+	return 0;
+}
+
+// Terminate decoding an dictionary
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_dictionary_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_end without being inside a DICTIONARY (stack empty)");
+
+	const stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::DICTIONARY) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_end without being inside a DICTIONARY but inside a " << cur_stack.m_element_type);
+	if (cur_stack.m_field_pos != cur_stack.m_fields_count) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_end with " << cur_stack.m_field_pos << " fields exttracted out of " << cur_stack.m_fields_count);
+
+	m_stack.pop();
+}
+
+// Start decoding an dictionary element
+template<marshal_bin_input INPUT>
+inline bool marshal_dec_bin_core<INPUT>::decode_dictionary_element_begin(std::string& key)
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_element_begin without being inside a DICTIONARY (stack empty)");
+
+	stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::DICTIONARY) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_element_begin without being inside a DICTIONARY but inside a " << cur_stack.m_element_type);
+	if (cur_stack.m_field_pos >= cur_stack.m_fields_count) return false;
+	cur_stack.m_field_pos++;
+	decode_string_utf8(key);
+	m_stack.emplace(marshal_bin_element_type::DICTIONARY_ELEMENT);
+	return true;
+}
+
+// Terminate decoding an dictionary element
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_dictionary_element_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_element_end without being inside a DICTIONARY_ELEMENT (stack empty)");
+	if (m_stack.top().m_element_type != marshal_bin_element_type::DICTIONARY_ELEMENT) DASTD_THROW(exception_marshal, "Invoked decode_dictionary_element_end without being inside a DICTIONARY_ELEMENT but inside a " << m_stack.top().m_element_type);
+	m_stack.pop();
+}
+
+
+// Start decoding a typed object
+template<marshal_bin_input INPUT>
+inline marshal_label_id_t marshal_dec_bin_core<INPUT>::decode_typed_begin(bool extensible)
+{
+	if (!m_stack.empty()) {
+		if (m_stack.top().m_element_type == marshal_bin_element_type::STRUCT) DASTD_THROW(exception_marshal, "Invoked decode_typed_begin inside a STRUCT; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::ARRAY) DASTD_THROW(exception_marshal, "Invoked decode_typed_begin inside an ARRAY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+		if (m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY) DASTD_THROW(exception_marshal, "Invoked decode_typed_begin inside a DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED");
+	}
+
+	marshal_label_id_t type_id = decode_u32();
+	size_t length = 0;
+
+	if (extensible) length = decode_patched_size_indicator();
+
+	// marshal_bin_element_type element_type, bool extensible, size_t element_offset, size_t element_size, const marshal_label_id_t* field_ids, size_t fields_count
+	m_stack.emplace(marshal_bin_element_type::TYPED, extensible, m_offset+length);
+
+	return type_id;
+}
+
+// Skip the object without decoding it
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_typed_end_skip()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_typed_end_skip without being inside a TYPED (stack empty)");
+
+	const stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::TYPED) DASTD_THROW(exception_marshal, "Invoked decode_typed_end_skip without being inside a TYPED but inside a " << cur_stack.m_element_type);
+	if (!cur_stack.m_extensible) DASTD_THROW(exception_marshal, "Invoked decode_typed_end_skip on a TYPED not declared as 'extensible'");
+
+	if (m_offset < cur_stack.m_end_offset) skip_bytes(cur_stack.m_end_offset - m_offset);
+	else if (m_offset > cur_stack.m_end_offset) DASTD_THROW(exception_marshal, "Too many bytes read invoking decode_struct_end; end expected at " << cur_stack.m_end_offset << " but current offset is " << m_offset);
+
+	m_stack.pop();
+}
+
+// Terminate decoding a typed object
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_typed_end()
+{
+	if (m_stack.empty()) DASTD_THROW(exception_marshal, "Invoked decode_typed_end without being inside a TYPED (stack empty)");
+
+	const stack_element& cur_stack = m_stack.top();
+	if (cur_stack.m_element_type != marshal_bin_element_type::TYPED) DASTD_THROW(exception_marshal, "Invoked decode_typed_end without being inside a TYPED but inside a " << cur_stack.m_element_type);
+
+	if (cur_stack.m_extensible) {
+		if (cur_stack.m_end_offset != m_offset) DASTD_THROW(exception_marshal, "In decode_typed_end, invalid offset; expected " << cur_stack.m_end_offset << ", got " << m_offset);
+	}
+
+	m_stack.pop();
+}
+
+// Decode raw binary data of a known and fixed length
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_binary(void* buffer, size_t length, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	read_bytes(buffer, length);
+}
+
+// Decode raw binary data of a variable length
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_varsize_binary(std::string& value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	size_t length = decode_u32(marshal_suggest_increasing);
+	read_string(value, length);
+}
+
+
+// Read the format header and switch to the indicated format
+template<marshal_bin_input INPUT>
+inline void marshal_dec_bin_core<INPUT>::decode_format_header()
+{
+	char magic[sizeof(marshal_bin_FORMAT_MAGIC)];
+	read_bytes(magic, sizeof(magic));
+	if (memcmp(magic, marshal_bin_FORMAT_MAGIC, sizeof(magic)) != 0) DASTD_THROW(exception_marshal, "marshal_dec_bin::decode_format_header: invalid format header");
+	uint8_t format = decode_u8();
+	if (format > (uint8_t)marshal_bin_format::COMPACT) DASTD_THROW(exception_marshal, "marshal_dec_bin::decode_format_header: unknown format " << (uint32_t)format);
+	set_format((marshal_bin_format)format);
+}
+
+// Decode a LEB128 varint
+template<marshal_bin_input INPUT>
+inline uint64_t marshal_dec_bin_core<INPUT>::decode_varint()
+{
+	uint64_t value = 0;
+	for (unsigned shift=0; shift<64; shift+=7) {
+		uint8_t byte;
+		read_bytes(&byte, 1);
+		if ((shift == 63) && (byte > 1)) break;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return value;
+	}
+	DASTD_THROW(exception_marshal, "marshal_dec_bin::decode_varint: value exceeding 64 bits");
+}
+
+// Decode a varint checking that it fits the given type
+template<marshal_bin_input INPUT>
+template<class TYPE>
+inline TYPE marshal_dec_bin_core<INPUT>::decode_varint_as()
+{
+	if constexpr (std::is_signed_v<TYPE>) {
+		int64_t value = marshal_bin_zigzag_decode(decode_varint());
+		if ((value < std::numeric_limits<TYPE>::min()) || (value > std::numeric_limits<TYPE>::max())) DASTD_THROW(exception_marshal, "marshal_dec_bin::decode_varint: value " << value << " out of range for a " << (sizeof(TYPE)*8) << "-bit integer");
+		return (TYPE)value;
+	}
+	else {
+		uint64_t value = decode_varint();
+		if (value > std::numeric_limits<TYPE>::max()) DASTD_THROW(exception_marshal, "marshal_dec_bin::decode_varint: value " << value << " out of range for a " << (sizeof(TYPE)*8) << "-bit unsigned integer");
+		return (TYPE)value;
+	}
+}
+
+// Read the required amount of bytes
+inline void marshal_bin_input_istream::read(void* target, size_t length)
+{
+	m_input.read((char*)target, length);
+	if (m_input.gcount() != (std::streamsize)length) {
+		DASTD_THROW(exception_marshal, "marshal_bin_input_istream::read failed reading " << length << " bytes; read only " << m_input.gcount())
+	}
+}
+
+// Skip the required amount of bytes
+inline void marshal_bin_input_istream::skip(size_t length)
+{
+	// Short skips are extracted from the stream buffer, that a seek would discard
+	if (length <= SHORT_SKIP_LENGTH) {
+		m_input.ignore((std::streamsize)length);
+		if (m_input.gcount() != (std::streamsize)length) {
+			DASTD_THROW(exception_marshal, "marshal_bin_input_istream::skip failed skipping " << length << " bytes; skipped only " << m_input.gcount())
+		}
+		return;
+	}
+
+	// Seekable streams: seekg would succeed even past the end, so the
+	// remaining length is checked against the end of the stream, located once
+	std::streampos pos = m_input.tellg();
+	if (pos != std::streampos(-1)) {
+		std::streambuf* buf = m_input.rdbuf();
+		if (!m_end_known) {
+			m_end = buf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+			m_end_known = true;
+		}
+		if (m_end != std::streampos(-1)) {
+			std::streamoff available = m_end - pos;
+			if ((available < 0) || ((uint64_t)available < length)) {
+				m_input.setstate(std::ios_base::eofbit);
+				DASTD_THROW(exception_marshal, "marshal_bin_input_istream::skip failed skipping " << length << " bytes; skipped only " << available)
+			}
+			if (buf->pubseekpos(pos + (std::streamoff)length, std::ios_base::in) == std::streampos(-1)) {
+				m_input.setstate(std::ios_base::failbit);
+				DASTD_THROW(exception_marshal, "marshal_bin_input_istream::skip failed moving the position by " << length << " bytes")
+			}
+			return;
+		}
+	}
+
+	// Not seekable: extract the data
+	m_input.clear();
+	m_input.ignore((std::streamsize)length);
+	if (m_input.gcount() != (std::streamsize)length) {
+		DASTD_THROW(exception_marshal, "marshal_bin_input_istream::skip failed skipping " << length << " bytes; skipped only " << m_input.gcount())
+	}
+}
+
+// Read the required amount of bytes
+template<concept_integral_8bit CHARTYPE>
+void marshal_bin_input_source<CHARTYPE>::read(void* target, size_t length)
+{
+		size_t bytesRead = m_input.tentative_read((CHARTYPE*)target, length);
+		if (bytesRead != length) {
+				DASTD_THROW(exception_marshal, "marshal_bin_input_source::read failed reading " << length << " bytes; read only " << bytesRead)
+		}
+}
+
+// Skip the required amount of bytes
+template<concept_integral_8bit CHARTYPE>
+void marshal_bin_input_source<CHARTYPE>::skip(size_t length)
+{
+		size_t bytesSkipped = m_input.tentative_discard(length);
+		if (bytesSkipped != length) {
+				DASTD_THROW(exception_marshal, "marshal_bin_input_source::skip failed skipping " << length << " bytes; skipped only " << bytesSkipped)
+		}
+}
+
+// Read the required amount of bytes into a string
+template<concept_integral_8bit CHARTYPE>
+void marshal_bin_input_source<CHARTYPE>::read_string(std::string& target, size_t length)
+{
+		size_t window_size;
+		const CHARTYPE* window = m_input.tentative_window(length, window_size);
+		if (window_size < length) {
+				// Not (entirely) available in memory
+				target.resize(length);
+				read(target.data(), length);
+				return;
+		}
+		target.assign((const char*)window, length);
+		m_input.tentative_discard(length);
+}
+
+} // namespace dastd
+
+#endif
@@ -13,6 +13,7 @@
 #include "ostream_string.hpp"
 #include <stack>
 #include <map>
+#include <unordered_map>
 
 namespace dastd {
 
@@ -29,6 +30,11 @@ namespace dastd {
 /// @tparam DECOPRINTER  Type used to format a `string_or_vector<CHARTYPE, DECOPRINTER>`
 ///                      when printed with `<<` on a `std::ostream`, usually
 ///                      to report errors.
+///
+/// The unknown fields and the objects skipped by `decode_struct_end` and
+/// `decode_typed_end_skip` are not decoded: only the strings, the comments and
+/// the number of open brackets are tracked to find their end. So malformed
+/// content inside them, like `{ [ }`, is not reported as an error.
 /// 
 /// 
 /// Example:
@@ -47,6 +53,9 @@ class marshal_dec_json: public marshal_dec {
 			/// @brief Remembers the number of items already encoded for arrays and structures
 			size_t m_items_count = 0;
 
+			/// @brief Lookup table of the fields declared for structures (`nullptr` if none)
+			marshal_field_table* m_field_table = nullptr;
+
 			/// @brief Constructor
 			stack_element(marshal_json_element_type element_type): m_element_type(element_type) {}
 
@@ -60,6 +69,23 @@ class marshal_dec_json: public marshal_dec {
 		/// @brief Map mapping the decoded label id with the field name (for error reporting)
 		std::map<marshal_label_id_t, dastd::char32string> m_fields_map;
 
+		/// @brief Lookup tables of the declared fields, by `field_infos` pointer
+		std::unordered_map<const marshal_label_info_t*, marshal_field_table> m_field_tables;
+
+		/// @brief Return the lookup table of the declared fields
+		/// @param field_infos Declared fields
+		/// @param field_infos_count Number of elements in `field_infos`
+		/// @return Returns the table, building it if needed, or `nullptr` if no fields are declared
+		marshal_field_table* get_field_table(const marshal_label_info_t* field_infos, size_t field_infos_count);
+
+		/// @brief Calculate the label-id of the current string token
+		marshal_label_id_t hash_string_token() const;
+
+		/// @brief Save the text of the current field name for `get_field_name`
+		/// @param label_id Label-id of the field name
+		/// @param field_table Declared fields of the structure being decoded (can be `nullptr`)
+		void save_field_name(marshal_label_id_t label_id, marshal_field_table* field_table);
+
 		/// @brief Internal JSON decoder
 		json_tokenizer_sourced<CHARTYPE> m_tokenizer;
 
@@ -87,7 +113,9 @@ class marshal_dec_json: public marshal_dec {
 	  ///
 	  /// This function expects to be right after a "{" or "[" and skips the
 	  /// entire substructure until matched the corresponding "}" or "]".
-	  /// It stops at the first unbalanced "}" or "]" which is left in the buffer.
+	  /// It stops at the first unbalanced "}" or "]", which becomes the last token.
+	  /// The content is skipped with `json_tokenizer_sourced::skip_until_close`,
+	  /// with no decoding.
 	  void skip_substructure();
 
 	public:
@@ -97,7 +125,14 @@ class marshal_dec_json: public marshal_dec {
 		/// @param polymorphic_encoding   See @ref marshal_json_polymorphic_encoding
 		/// @param typed_field            Name of the field in case of `TYPEID_AS_STRUCT_FIELD`; see @ref marshal_json_polymorphic_encoding
 		marshal_dec_json(source_with_peek<CHARTYPE>& source, marshal_json_polymorphic_encoding polymorphic_encoding=marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME, const std::string& typed_field="$type"):
-			m_tokenizer(source), m_polymorphic_encoding(polymorphic_encoding), m_typed_field(typed_field) {}
+			m_tokenizer(source, json_tokenizer_sourced<CHARTYPE>::STRING_VIEWS), m_polymorphic_encoding(polymorphic_encoding), m_typed_field(typed_field) {}
+
+		/// @brief Walk a structural index of the source data
+		///
+		/// See `json_tokenizer_sourced::set_structural_index`.
+		///
+		/// @param index Index, that must stay available while decoding
+		void set_structural_index(const json_structural_index* index) requires std::is_same_v<CHARTYPE,char> {m_tokenizer.set_structural_index(index);}
 
 		/// @brief Decode a bool
 		/// @return Return the decoded data
@@ -169,6 +204,8 @@ class marshal_dec_json: public marshal_dec {
 
 		/// @brief Terminate Decoding a structure
 		///
+		/// The remaining unknown fields are skipped with no validation of their content.
+		///
 		/// See @link marshaling_structs documentation for details and examples.
 		virtual void decode_struct_end() override;
 
@@ -269,6 +306,7 @@ class marshal_dec_json: public marshal_dec {
 		/// This method will skip the object without decoding. It can be invoked only if
 		/// the `extensible` parameter is `true`. Useful when the encoding data comes from
 		/// a newer version that has new object types unknown to this version.
+		/// The content of the skipped object is not validated.
 		///
 		/// See @link marshaling_typeds documentation for details and examples.
 		virtual void decode_typed_end_skip() override;
@@ -295,6 +333,16 @@ class marshal_dec_json: public marshal_dec {
 		/// @param value Receives the raw decoded data
 		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
 		virtual void internal_decode_varsize_binary(std::string& value, uint32_t suggestions=0) override;
+
+		/// @brief Decode a whole array of numbers
+		///
+		/// The elements are read in a tight loop without going through
+		/// the decoding stack.
+		///
+		/// @param target Vector receiving the elements
+		/// @param item Type of the elements
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		virtual void internal_decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions) override;
 };
 
 
@@ -310,6 +358,53 @@ bool marshal_dec_json<CHARTYPE, DECOPRINTER>::get_field_name(marshal_label_id_t
 	return false;
 }
 
+// (brief) Return the lookup table of the declared fields
+//
+// The tables are cached by `field_infos` pointer; since the same pointer
+// could be reused for different fields, the content is verified as well.
+template<class CHARTYPE, class DECOPRINTER>
+marshal_field_table* marshal_dec_json<CHARTYPE, DECOPRINTER>::get_field_table(const marshal_label_info_t* field_infos, size_t field_infos_count)
+{
+	if ((field_infos == nullptr) || (field_infos_count == 0)) return nullptr;
+	auto iter = m_field_tables.find(field_infos);
+	if (iter == m_field_tables.end()) {
+		iter = m_field_tables.emplace(field_infos, marshal_field_table(field_infos, field_infos_count)).first;
+	}
+	else if (!iter->second.same_fields(field_infos, field_infos_count)) {
+		iter->second = marshal_field_table(field_infos, field_infos_count);
+	}
+	return &iter->second;
+}
+
+// (brief) Calculate the label-id of the current string token
+//
+// Strings returned by the tokenizer as views are hashed in place.
+template<class CHARTYPE, class DECOPRINTER>
+inline marshal_label_id_t marshal_dec_json<CHARTYPE, DECOPRINTER>::hash_string_token() const
+{
+	size_t length;
+	const CHARTYPE* view = m_tokenizer.get_string_view(length);
+	if (view != nullptr) return marshal_label::hash(view, length);
+	const char32string& text = m_tokenizer.get_string();
+	return marshal_label::hash(text.data(), text.length());
+}
+
+// (brief) Save the text of the current field name for `get_field_name`
+//
+// The declared fields are saved only the first time they are met, so
+// the map is accessed only for the unknown ones.
+template<class CHARTYPE, class DECOPRINTER>
+inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::save_field_name(marshal_label_id_t label_id, marshal_field_table* field_table)
+{
+	if (field_table != nullptr) {
+		size_t index = field_table->find(label_id);
+		if ((index != marshal_field_table::npos) && !field_table->mark_seen(index)) return;
+	}
+	if (!m_fields_map.contains(label_id)) {
+		m_fields_map.insert({label_id, m_tokenizer.get_string()});
+	}
+}
+
 // Parse the string until a new token has been detected
 template<class CHARTYPE, class DECOPRINTER>
 inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::fetch_token()
@@ -449,7 +544,7 @@ inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_string_utf8(std::str
 	assert(!m_is_typed);
 	fetch_token();
 	if (m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_string_utf8: expected a string, got result " << m_tokenizer.get_last_process_ret());
-	value = m_tokenizer.get_string().get_utf8();
+	m_tokenizer.get_string_utf8(value);
 }
 
 // Decode raw binary data of a known and fixed length
@@ -496,8 +591,6 @@ template<class CHARTYPE, class DECOPRINTER>
 inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_struct_begin(bool extensible, const marshal_label_info_t* field_infos, size_t fields_infos_count)
 {
 	DASTD_NOWARN_UNUSED(extensible);
-	DASTD_NOWARN_UNUSED(field_infos);
-	DASTD_NOWARN_UNUSED(fields_infos_count);
 
 	// If `m_is_typed` is set, it means that the structure has been already opened and partially
 	// parsed by the `decode_typed_begin` call to retrieve the internal field that contains
@@ -516,6 +609,7 @@ inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_struct_begin(bool ex
 		m_stack.emplace(marshal_json_element_type::STRUCT);
 	}
 	else m_is_typed=false;
+	m_stack.top().m_field_table = get_field_table(field_infos, fields_infos_count);
 }
 
 // Terminate Decoding a structure
@@ -560,13 +654,11 @@ marshal_label_id_t marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_struct_field_
 	cur_stack.m_items_count++;
 
 	// The current element must be the field name
-	if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string().length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_struct_field_begin: expected field name but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
-	marshal_label_id_t label_id = marshal_label::hash(m_tokenizer.get_string().get_utf8());
+	if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string_length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_struct_field_begin: expected field name but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
+	marshal_label_id_t label_id = hash_string_token();
 
 	// Save the label text in case it will be needed
-	if (!m_fields_map.contains(label_id)) {
-		m_fields_map.insert({label_id, m_tokenizer.get_string()});
-	}
+	save_field_name(label_id, cur_stack.m_field_table);
 
 	// The following field must be a ":"
 	fetch_token();
@@ -622,6 +714,42 @@ size_t marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_array_begin()
 	return dastd::marshal_array_SIZE_UNKNOWN;
 }
 
+// Decode a whole array of numbers
+template<class CHARTYPE, class DECOPRINTER>
+void marshal_dec_json<CHARTYPE, DECOPRINTER>::internal_decode_array_of(const marshal_array_target& target, marshal_array_item item, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	decode_array_begin();
+	marshal_array_item_dispatch(item, [&](auto* tag) {
+		using ITEM = std::remove_pointer_t<decltype(tag)>;
+		size_t capacity = 16;
+		uint8_t* ptr = (uint8_t*)target.resize(capacity);
+		size_t count = 0;
+		for(;;) {
+			// It could be a ']', which means that no more elements are following
+			fetch_token();
+			if (m_tokenizer.get_last_process_ret() == json_tokenizer_ret::C_BRACKET_CLOSE) break;
+
+			// If this is not the first element, there must be a comma
+			if (count > 0) {
+				if (m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_COMMA) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_array_of: expected ',' but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
+				fetch_token();
+			}
+
+			auto pair = m_tokenizer.get_multinum().template get<ITEM>();
+			if (!pair.second) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_array_of: expected a number fitting " << sizeof(ITEM) << " bytes, got " << DECOPRINTER(m_tokenizer.get_raw_token()));
+			if (count == capacity) {
+				capacity *= 2;
+				ptr = (uint8_t*)target.resize(capacity);
+			}
+			memcpy(ptr+count*sizeof(ITEM), &pair.first, sizeof(ITEM));
+			count++;
+		}
+		target.resize(count);
+	});
+	decode_array_end();
+}
+
 // Terminate decoding an array
 template<class CHARTYPE, class DECOPRINTER>
 inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_array_end()
@@ -730,8 +858,8 @@ bool marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_dictionary_element_begin(st
 	cur_stack.m_items_count++;
 
 	// The current element must be the field key
-	if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string().length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_dictionary_field_begin: expected key string but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
-	key = m_tokenizer.get_string().get_utf8();
+	if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string_length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_dictionary_field_begin: expected key string but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
+	m_tokenizer.get_string_utf8(key);
 
 	// The following field must be a ":"
 	fetch_token();
@@ -783,9 +911,9 @@ marshal_label_id_t marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_typed_begin(b
 		case marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME: {
 			// At this point there must be the type name
 			fetch_token();
-			if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string().length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected type name but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
+			if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string_length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected type name but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
 			
-			type_id = marshal_label::hash(m_tokenizer.get_string().get_utf8());
+			type_id = hash_string_token();
 
 			// The following field must be a ":"
 			fetch_token();
@@ -802,8 +930,10 @@ marshal_label_id_t marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_typed_begin(b
 		case marshal_json_polymorphic_encoding::TYPEID_AS_STRUCT_FIELD: {
 			// At this point there must be the field named `m_typed_field`
 			fetch_token();
-			if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string().length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected field name  " << fmt_cq(m_typed_field) << " but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
-			if (m_tokenizer.get_string().get_utf8() != m_typed_field) {
+			if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string_length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected field name  " << fmt_cq(m_typed_field) << " but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
+			std::string field_name;
+			m_tokenizer.get_string_utf8(field_name);
+			if (field_name != m_typed_field) {
 				DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected field named " << fmt_cq(m_typed_field) << " but got " << fmt_cq(m_tokenizer.get_string()));
 			}
 
@@ -813,8 +943,8 @@ marshal_label_id_t marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_typed_begin(b
 
 			// Now there must be a string with the type name
 			fetch_token();
-			if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string().length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected type name but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
-			type_id = marshal_label::hash(m_tokenizer.get_string().get_utf8());
+			if ((m_tokenizer.get_last_process_ret() != json_tokenizer_ret::C_STRING) || (m_tokenizer.get_string_length() == 0)) DASTD_THROW(exception_marshal, "marshal_dec_json::decode_typed_begin: expected type name but got result " << m_tokenizer.get_last_process_ret() << " " << DECOPRINTER(m_tokenizer.get_raw_token()));
+			type_id = hash_string_token();
 
 			// Signal that we are processing a typed entry
 			m_is_typed = true;
@@ -893,30 +1023,23 @@ inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::decode_typed_end()
 template<class CHARTYPE, class DECOPRINTER>
 inline void marshal_dec_json<CHARTYPE, DECOPRINTER>::skip_substructure()
 {
-	std::stack<char> stk;
-	bool do_loop = true;
-	while(do_loop) {
-		fetch_token();
-
+	// A resubmitted token has not been consumed yet
+	size_t depth = 1;
+	if (m_resubmit_prev_token) {
+		m_resubmit_prev_token = false;
 		switch(m_tokenizer.get_last_process_ret()) {
-			case json_tokenizer_ret::C_BRACKET_OPEN: stk.emplace('['); break;
-			case json_tokenizer_ret::C_BRACE_OPEN: stk.emplace('{'); break;
-
-			case json_tokenizer_ret::C_BRACKET_CLOSE: {
-				if (stk.empty() || (stk.top() != '[')) do_loop=false;
-				else stk.pop();
-				break;
-			}
-			case json_tokenizer_ret::C_BRACE_CLOSE: {
-				if (stk.empty() || (stk.top() != '{')) do_loop=false;
-				else stk.pop();
-				break;
-			}
+			case json_tokenizer_ret::C_BRACKET_OPEN:
+			case json_tokenizer_ret::C_BRACE_OPEN: depth++; break;
+			case json_tokenizer_ret::C_BRACKET_CLOSE:
+			case json_tokenizer_ret::C_BRACE_CLOSE:
 			case json_tokenizer_ret::C_NOTHING_MORE:
-			case json_tokenizer_ret::C_ERROR: do_loop=false; break;
+			case json_tokenizer_ret::C_ERROR: return;
 			default:;
 		}
 	}
+
+	// The skipped content is not decoded: only brackets, strings and comments are tracked
+	m_tokenizer.skip_until_close(depth);
 }
 
 } // namespace dastd
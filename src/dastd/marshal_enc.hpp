@@ -160,6 +160,19 @@ namespace dastd {
 			/// See @link marshaling_arrays documentation for details and examples.
 			virtual void encode_array_element_end() = 0;
 
+			/// @brief Encode a whole array of numbers
+			/// @param values Elements to be encoded
+			/// @param suggestions Encoding suggestions applied to each element; see @link marshaling_suggestions documentation @endlink.
+			///
+			/// The encoding is the same produced by encoding each element within
+			/// `encode_array_begin` and `encode_array_end`, but the encoders can
+			/// write it in bulk.
+			/// See @link marshaling_arrays documentation for details and examples.
+			template<marshal_array_item_types TYPE>
+			void encode_array_of(std::span<const TYPE> values, uint32_t suggestions=0) {
+				internal_encode_array_of(values.data(), values.size(), marshal_array_item_of<TYPE>(), suggestions);
+			}
+
 			/// @brief Start encoding a dictionary
 			/// @param count Number of elements that will be encoded
 			///
@@ -208,8 +221,36 @@ namespace dastd {
 			/// @note The encoder must encode the data in way that allows the decoder do deduce its length at runtime.
 			///       This includes a length field, some kind of terminator in the encoding or anything else suitable.
 			virtual void internal_encode_varsize_binary(const void* data, size_t length, uint32_t suggestions=0) = 0;
+
+			/// @brief Encode a whole array of numbers
+			/// @param data Pointer to the first element
+			/// @param count Number of elements
+			/// @param item Type of the elements
+			/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+			///
+			/// The default implementation encodes the elements one by one.
+			virtual void internal_encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions);
 	};
 
+	// Encode a whole array of numbers one element at a time
+	inline void marshal_enc::internal_encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions)
+	{
+		marshal_array_item_dispatch(item, [&](auto* tag) {
+			using ITEM = std::remove_pointer_t<decltype(tag)>;
+			const uint8_t* ptr = (const uint8_t*)data;
+			encode_array_begin(count);
+			for (size_t i=0; i<count; i++) {
+				ITEM value;
+				memcpy(&value, ptr+i*sizeof(ITEM), sizeof(ITEM));
+				encode_array_element_begin();
+				if constexpr (std::is_same_v<ITEM, double>) encode_f64(value, suggestions);
+				else encode<ITEM>(value, suggestions);
+				encode_array_element_end();
+			}
+			encode_array_end();
+		});
+	}
+
 	// Template for encoding integral types
 	template<marshal_integral_types TYPE>
 	void marshal_enc::encode(TYPE value, uint32_t suggestions)
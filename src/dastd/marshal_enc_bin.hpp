@@ -4,199 +4,181 @@
 * @date 23-AUG-2023
 **/
 #pragma once
-#include "marshal_enc.hpp"
-#include "marshal_bin.hpp"
-#include "endian_aware.hpp"
-#include "utf8.hpp"
-#include "float.hpp"
-#include <stack>
+#include "marshal_enc_bin_core.hpp"
 
 namespace dastd {
-/// @brief Binary little-endian marshaling encoder
+/// @brief Binary little-endian marshaling encoder exposing the `marshal_enc` interface
 ///
-/// Encodes binary data using the binary little-endian encoding.
-/// See @link marshaling_bin_format "Marshaling binary format" @endlink
-/// for details on the binary encoding format.
-template<class STREAMPOS>
-class marshal_enc_bin: public marshal_enc {
-	private:
-		/// @brief Stack element
-		struct stack_element {
-			marshal_bin_element_type m_element_type;
+/// Thin adapter forwarding the virtual methods of `marshal_enc` to a
+/// `marshal_enc_bin_core` instance, so it can be used where a `marshal_enc&`
+/// is required. Each `encode_xxx` costs one virtual call; the
+/// output policy is still invoked with no further virtual calls.
+///
+/// @tparam OUTPUT Output policy; see `marshal_bin_output`
+template<marshal_bin_output OUTPUT>
+class marshal_enc_bin_adapter: public marshal_enc {
+	public:
+		/// @brief Constructor
+		/// @param args Arguments passed to the constructor of the output policy
+		template<class... ARGS>
+		explicit marshal_enc_bin_adapter(ARGS&&... args): m_core(std::forward<ARGS>(args)...) {}
 
-			/// @brief Position where the element starts
-			STREAMPOS m_pos;
+		/// @brief Access the underlying non-virtual encoder
+		marshal_enc_bin_core<OUTPUT>& core() {return m_core;}
 
-			/// @brief True if marked as extensible
-			bool m_extensible = false;
+		/// @brief Access the output policy
+		std::remove_reference_t<OUTPUT>& output() {return m_core.output();}
 
-			/// @brief Constructor
-			stack_element(marshal_bin_element_type element_type, STREAMPOS pos, bool extensible=false):
-				m_element_type(element_type), m_pos(pos), m_extensible(extensible) {}
+		/// @brief Access the output policy
+		const std::remove_reference_t<OUTPUT>& output() const {return m_core.output();}
 
-			/// @brief Constructor
-			stack_element() {}
-		};
+		/// @brief Select the encoding format; see `marshal_enc_bin_core::set_format`
+		void set_format(marshal_bin_format format) {m_core.set_format(format);}
 
-		/// @brief Internal encoding stack
-		std::stack<stack_element> m_stack;
+		/// @brief Return the current encoding format
+		marshal_bin_format get_format() const {return m_core.get_format();}
+
+		/// @brief Write the format header; see `marshal_enc_bin_core::encode_format_header`
+		void encode_format_header() {m_core.encode_format_header();}
 
-	public:
 		/// @brief Encode a bool
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_bool(bool value, uint32_t suggestions=0) override;
+		virtual void encode_bool(bool value, uint32_t suggestions=0) override {m_core.encode_bool(value, suggestions);}
 
 		/// @brief Encode a uint8_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_u8(uint8_t value, uint32_t suggestions=0) override;
+		virtual void encode_u8(uint8_t value, uint32_t suggestions=0) override {m_core.encode_u8(value, suggestions);}
 
 		/// @brief Encode a int8_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_i8(int8_t value, uint32_t suggestions=0) override;
+		virtual void encode_i8(int8_t value, uint32_t suggestions=0) override {m_core.encode_i8(value, suggestions);}
 
 		/// @brief Encode a uint16_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_u16(uint16_t value, uint32_t suggestions=0) override;
+		virtual void encode_u16(uint16_t value, uint32_t suggestions=0) override {m_core.encode_u16(value, suggestions);}
 
 		/// @brief Encode a int16_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_i16(int16_t value, uint32_t suggestions=0) override;
+		virtual void encode_i16(int16_t value, uint32_t suggestions=0) override {m_core.encode_i16(value, suggestions);}
 
 		/// @brief Encode a uint32_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_u32(uint32_t value, uint32_t suggestions=0) override;
+		virtual void encode_u32(uint32_t value, uint32_t suggestions=0) override {m_core.encode_u32(value, suggestions);}
 
 		/// @brief Encode a int32_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_i32(int32_t value, uint32_t suggestions=0) override;
+		virtual void encode_i32(int32_t value, uint32_t suggestions=0) override {m_core.encode_i32(value, suggestions);}
 
 		/// @brief Encode a uint64_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_u64(uint64_t value, uint32_t suggestions=0) override;
+		virtual void encode_u64(uint64_t value, uint32_t suggestions=0) override {m_core.encode_u64(value, suggestions);}
 
 		/// @brief Encode a int64_t
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_i64(int64_t value, uint32_t suggestions=0) override;
+		virtual void encode_i64(int64_t value, uint32_t suggestions=0) override {m_core.encode_i64(value, suggestions);}
 
 		/// @brief Encode a 64-bit floating point
-		/// @return Return the decoded data
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_f64(double value, uint32_t suggestions=0) override;
+		virtual void encode_f64(double value, uint32_t suggestions=0) override {m_core.encode_f64(value, suggestions);}
 
 		/// @brief Encode a std::string (UTF-8)
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_string_utf8(const std::string& value, uint32_t suggestions=0) override;
+		virtual void encode_string_utf8(const std::string& value, uint32_t suggestions=0) override {m_core.encode_string_utf8(value, suggestions);}
 
 		/// @brief Encode a std::u32string
-		/// @param value Value to be encoded.
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void encode_u32string(const std::u32string& value, uint32_t suggestions=0) override;
+		virtual void encode_u32string(const std::u32string& value, uint32_t suggestions=0) override {m_core.encode_u32string(value, suggestions);}
 
 		/// @brief Start encoding a structure
-		/// @param extensible If true, the structure will be encoded so more or less fields can be expected.
-		///
-		/// See @link marshaling_structs documentation for details and examples.
-		virtual void encode_struct_begin(bool extensible) override;
+		virtual void encode_struct_begin(bool extensible) override {m_core.encode_struct_begin(extensible);}
 
 		/// @brief Terminate encoding a structure
-		///
-		/// See @link marshaling_structs documentation for details and examples.
-		virtual void encode_struct_end() override;
+		virtual void encode_struct_end() override {m_core.encode_struct_end();}
 
 		/// @brief Start encoding a field within a structure
-		/// @param label Contains the name of the field and its label-id
-		///
-		/// This must be invoked inside a `encode_struct_begin` and `encode_struct_end` pair.
-		/// See @link marshaling_structs documentation for details and examples.
-		virtual void encode_struct_field_begin(marshal_label label, marshal_optional_field opt=marshal_optional_field::MANDATORY) override;
+		virtual void encode_struct_field_begin(marshal_label label, marshal_optional_field opt=marshal_optional_field::MANDATORY) override {m_core.encode_struct_field_begin(label, opt);}
 
 		/// @brief Terminate encoding a field within a structure
-		///
-		/// This must be invoked inside a `encode_struct_begin` and `encode_struct_end` pair.
-		/// See @link marshaling_structs documentation for details and examples.
-		virtual void encode_struct_field_end() override;
+		virtual void encode_struct_field_end() override {m_core.encode_struct_field_end();}
 
 		/// @brief Start encoding an array
-		/// @param count Number of elements that will be encoded
-		///
-		/// See @link marshaling_arrays documentation for details and examples.
-		virtual void encode_array_begin(size_t count) override;
+		virtual void encode_array_begin(size_t count) override {m_core.encode_array_begin(count);}
 
 		/// @brief Terminate encoding an array
-		///
-		/// See @link marshaling_arrays documentation for details and examples.
-		virtual void encode_array_end() override;
+		virtual void encode_array_end() override {m_core.encode_array_end();}
 
 		/// @brief Start encoding an array element
-		/// @param count Number of elements that will be encoded
-		///
-		/// See @link marshaling_arrays documentation for details and examples.
-		virtual void encode_array_element_begin() override;
+		virtual void encode_array_element_begin() override {m_core.encode_array_element_begin();}
 
 		/// @brief Terminate encoding an array element
-		///
-		/// See @link marshaling_arrays documentation for details and examples.
-		virtual void encode_array_element_end() override;
+		virtual void encode_array_element_end() override {m_core.encode_array_element_end();}
 
 		/// @brief Start encoding a dictionary
-		/// @param count Number of elements that will be encoded
-		///
-		/// See @link marshaling_dictionaries documentation for details and examples.
-		virtual void encode_dictionary_begin(size_t count) override;
+		virtual void encode_dictionary_begin(size_t count) override {m_core.encode_dictionary_begin(count);}
 
 		/// @brief Terminate encoding a dictionary
-		///
-		/// See @link marshaling_dictionaries documentation for details and examples.
-		virtual void encode_dictionary_end() override;
+		virtual void encode_dictionary_end() override {m_core.encode_dictionary_end();}
 
 		/// @brief Start encoding a dictionary element
-		/// @param key UTF-8 encoded string key that will be encoded along with the object
-		///
-		/// See @link marshaling_dictionaries documentation for details and examples.
-		virtual void encode_dictionary_element_begin(const std::string& key) override;
+		virtual void encode_dictionary_element_begin(const std::string& key) override {m_core.encode_dictionary_element_begin(key);}
 
 		/// @brief Terminate encoding a dictionary element
-		///
-		/// See @link marshaling_dictionaries documentation for details and examples.
-		virtual void encode_dictionary_element_end() override;
+		virtual void encode_dictionary_element_end() override {m_core.encode_dictionary_element_end();}
 
 		/// @brief Start encoding a typed object
-		/// @param label Contains the name of the type and its label-id
-		/// @param extensible If true, the object is encoded in way that allows skipping it during decoding.
-		///
-		/// See @link marshaling_typeds documentation for details and examples.
-		virtual void encode_typed_begin(marshal_label label, bool extensible) override;
+		virtual void encode_typed_begin(marshal_label label, bool extensible) override {m_core.encode_typed_begin(label, extensible);}
 
 		/// @brief Terminate encoding a typed object
-		///
-		/// See @link marshaling_typeds documentation for details and examples.
-		virtual void encode_typed_end() override;
+		virtual void encode_typed_end() override {m_core.encode_typed_end();}
 
 	protected:
 		/// @brief Encode fixed-size, known in advance, raw binary data
-		/// @param data Raw data
-		/// @param length Length of the raw data
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		virtual void internal_encode_binary(const void* data, size_t length, uint32_t suggestions=0) override;
+		virtual void internal_encode_binary(const void* data, size_t length, uint32_t suggestions=0) override {m_core.encode_binary(data, length, suggestions);}
 
 		/// @brief Encode variably sized, raw binary data
-		/// @param data Raw data
-		/// @param length Length of the raw data
-		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
-		/// @note The encoder must encode the data in way that allows the decoder do deduce its length at runtime.
-		///       This includes a length field, some kind of terminator in the encoding or anything else suitable.
-		virtual void internal_encode_varsize_binary(const void* data, size_t length, uint32_t suggestions=0) override;
+		virtual void internal_encode_varsize_binary(const void* data, size_t length, uint32_t suggestions=0) override {m_core.encode_varsize_binary(data, length, suggestions);}
+
+		/// @brief Encode a whole array of numbers
+		virtual void internal_encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions) override {m_core.encode_array_of(data, count, item, suggestions);}
+
+	private:
+		/// @brief Encoder doing the actual job
+		marshal_enc_bin_core<OUTPUT> m_core;
+};
+
+template<class STREAMPOS> class marshal_enc_bin;
+
+/// @brief Output policy calling the virtual methods of `marshal_enc_bin`
+template<class STREAMPOS>
+class marshal_bin_output_virtual {
+	public:
+		/// @brief Constructor
+		/// @param encoder Encoder implementing the virtual output methods
+		marshal_bin_output_virtual(marshal_enc_bin<STREAMPOS>* encoder): m_encoder(encoder) {}
+
+		/// @brief Write the required amount of bytes
+		void write(const void* source, size_t length) {m_encoder->write_bytes(source, length);}
+
+		/// @brief Get the current position into the output stream
+		STREAMPOS get_pos() const {return m_encoder->get_curr_pos();}
+
+		/// @brief Set the current position into the output stream
+		void set_pos(STREAMPOS pos) {m_encoder->set_curr_pos(pos);}
+
+		/// @brief Calculate the difference in bytes between two positions
+		size_t pos_diff(STREAMPOS p1, STREAMPOS p2) const {return m_encoder->pos_diff(p1, p2);}
+
+	private:
+		/// @brief Encoder implementing the virtual output methods
+		marshal_enc_bin<STREAMPOS>* m_encoder;
+};
+
+/// @brief Binary little-endian marshaling encoder
+///
+/// Encodes binary data using the binary little-endian encoding.
+/// See @link marshaling_bin_format "Marshaling binary format" @endlink
+/// for details on the binary encoding format.
+///
+/// The output is implemented by the derived classes through virtual
+/// methods. Where the output is known at compile time, prefer
+/// `marshal_enc_bin_core` (or `marshal_enc_bin_adapter`) with an output policy.
+template<class STREAMPOS>
+class marshal_enc_bin: public marshal_enc_bin_adapter<marshal_bin_output_virtual<STREAMPOS>> {
+	friend class marshal_bin_output_virtual<STREAMPOS>;
 
+	public:
+		/// @brief Constructor
+		marshal_enc_bin(): marshal_enc_bin_adapter<marshal_bin_output_virtual<STREAMPOS>>(this) {}
+
+	protected:
 		/// @brief Write the required amount of bytes
 		///
 		/// Attempts to write the indicated number of bytes. If it fails, it
@@ -223,10 +205,6 @@ class marshal_enc_bin: public marshal_enc {
 		/// @param p2 Highest position value
 		/// @return Returns the difference in bytes
 		virtual size_t pos_diff(STREAMPOS p1, STREAMPOS p2) const = 0;
-
-	private:
-		/// @brief Encode a size indicaotr
-		void encode_size_indicator(size_t size) {encode_u32((uint32_t)size);}
 };
 
 /// @brief Binary little-endian marshaling encoder
@@ -274,315 +252,41 @@ class marshal_enc_bin_ostream: public marshal_enc_bin<std::streampos> {
 		std::ostream& m_output;
 };
 
-// Encode a bool
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_bool(bool value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t v = (value ? 1 : 0);
-	write_bytes((const char*)&v, 1);
-}
-
-// Encode a uint8_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_u8(uint8_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	write_bytes((const char*)&value, 1);
-}
-
-// Encode a int8_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_i8(int8_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	write_bytes((const char*)&value, 1);
-}
-
-// Encode a uint16_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_u16(uint16_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[sizeof(value)];
-	native_to_little_endian(value, encoded);
-	write_bytes(encoded, sizeof(value));
-}
-
-// Encode a int16_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_i16(int16_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[sizeof(value)];
-	native_to_little_endian(value, encoded);
-	write_bytes(encoded, sizeof(value));
-}
-
-// Encode a uint32_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_u32(uint32_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[sizeof(value)];
-	native_to_little_endian(value, encoded);
-	write_bytes(encoded, sizeof(value));
-}
-
-// Encode a int32_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_i32(int32_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[sizeof(value)];
-	native_to_little_endian(value, encoded);
-	write_bytes(encoded, sizeof(value));
-}
-
-// Encode a uint64_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_u64(uint64_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[sizeof(value)];
-	native_to_little_endian(value, encoded);
-	write_bytes(encoded, sizeof(value));
-}
-
-// Encode a int64_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_i64(int64_t value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[sizeof(value)];
-	native_to_little_endian(value, encoded);
-	write_bytes(encoded, sizeof(value));
-}
-
-// Encode a int64_t
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_f64(double value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	uint8_t encoded[8];
-	native_to_little_endian(pack_f64(value), encoded);
-	write_bytes(encoded, 8);
-}
-
-// Encode a std::string (UTF-8)
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_string_utf8(const std::string& value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	encode_u32((uint32_t)value.size(), marshal_suggest_increasing);
-	write_bytes(value.c_str(), value.size());
-}
-
-// Encode a std::u32string
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_u32string(const std::u32string& value, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	size_t len = calc_utf8_length(value.c_str(), value.length());
-	encode_u32((uint32_t)len, marshal_suggest_increasing);
-
-	size_t i;
-	char buf[UTF8_CHAR_MAX_LEN];
-	for (i=0; i<value.length(); i++) {
-		len = write_utf8_asciiz(buf, value[i]);
-		write_bytes(buf, len);
-	}
-}
-
-// (brief) Encode fixed-size, known in advance, raw binary data
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::internal_encode_binary(const void* data, size_t length, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	write_bytes(data, length);
-}
-
-// (brief) Encode variably sized, raw binary data
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::internal_encode_varsize_binary(const void* data, size_t length, uint32_t suggestions)
-{
-	DASTD_NOWARN_UNUSED(suggestions);
-	assert(length <= std::numeric_limits<uint32_t>::max());
-	encode_u32((uint32_t)length, marshal_suggest_increasing);
-	write_bytes(data, length);
-}
-
-// Start encoding a structure
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_struct_begin(bool extensible)
-{
-	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
-	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY)));
-
-	m_stack.emplace(marshal_bin_element_type::STRUCT, get_curr_pos(), extensible);
-
-	// Prepare the space for the size indicator
-	if (extensible) encode_size_indicator(0);
-}
-
-// Terminate encoding a structure
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_struct_end()
-{
-	// Invoked encode_struct_end without being inside a STRUCT (stack empty)
-	assert(!m_stack.empty());
-	assert (m_stack.top().m_element_type == marshal_bin_element_type::STRUCT);
-
-	if (m_stack.top().m_extensible) {
-		STREAMPOS currpos = get_curr_pos();
-		size_t size = pos_diff(m_stack.top().m_pos, currpos);
-		set_curr_pos(m_stack.top().m_pos);
-		encode_size_indicator(size-4);
-		set_curr_pos(currpos);
-	}
-	m_stack.pop();
-}
-
-// Start encoding a field within a structure
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_struct_field_begin(marshal_label label, marshal_optional_field opt)
-{
-	DASTD_NOWARN_UNUSED(label);
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::STRUCT);
-	switch(opt) {
-		case marshal_optional_field::MANDATORY: m_stack.emplace(marshal_bin_element_type::FIELD, get_curr_pos(), false); break;
-		case marshal_optional_field::OPTIONAL_MISSING: {
-			encode_bool(false);
-			m_stack.emplace(marshal_bin_element_type::FIELD_MISSING, get_curr_pos(), false);
-			break;
-		}
-		case marshal_optional_field::OPTIONAL_PRESENT: {
-			encode_bool(true);
-			m_stack.emplace(marshal_bin_element_type::FIELD, get_curr_pos(), false);
-			break;
-		}
-	}
-
-}
-
-// Terminate encoding a field within a structure
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_struct_field_end()
-{
-	assert(!m_stack.empty());
-	assert((m_stack.top().m_element_type == marshal_bin_element_type::FIELD) || (m_stack.top().m_element_type == marshal_bin_element_type::FIELD_MISSING));
-	m_stack.pop();
-}
-
-// Start encoding an array
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_array_begin(size_t count)
-{
-	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
-	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY)));
-	encode_size_indicator(count);
-	m_stack.emplace(marshal_bin_element_type::ARRAY, get_curr_pos(), false);
-}
-
-// Terminate encoding an array
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_array_end()
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::ARRAY);
-	m_stack.pop();
-}
-
-// Start encoding an array element
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_array_element_begin()
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::ARRAY);
-	m_stack.emplace(marshal_bin_element_type::ARRAY_ELEMENT, get_curr_pos(), false);
-}
-
-// Terminate encoding an array element
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_array_element_end()
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::ARRAY_ELEMENT);
-	m_stack.pop();
-}
-
-// Start encoding an dictionary
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_dictionary_begin(size_t count)
-{
-	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, DICTIONARY_ELEMENT TYPED
-	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::DICTIONARY)));
-	encode_size_indicator(count);
-	m_stack.emplace(marshal_bin_element_type::DICTIONARY, get_curr_pos(), false);
-}
-
-// Terminate encoding an dictionary
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_dictionary_end()
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY);
-	m_stack.pop();
-}
-
-// Start encoding an dictionary element
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_dictionary_element_begin(const std::string& key)
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY);
-	m_stack.emplace(marshal_bin_element_type::DICTIONARY_ELEMENT, get_curr_pos(), false);
-	encode_string_utf8(key);
-}
-
-// Terminate encoding an dictionary element
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_dictionary_element_end()
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY_ELEMENT);
-	m_stack.pop();
-}
+/// @brief Binary little-endian marshaling encoder
+///
+/// Encodes binary data using the binary little-endian encoding.
+/// Operates by writing into a contiguous memory buffer: either an internal
+/// growable one or a fixed-size one provided by the caller.
+///
+/// The size indicators are back-patched in place, so no seekable output
+/// is needed: once the encoding is complete, `data()` and `size()` can be
+/// handed to a file, a pipe or a socket with a single write.
+/// Call `clear()` to reuse the same buffer for the next message.
+class marshal_enc_bin_membuf: public marshal_enc_bin_adapter<marshal_bin_output_membuf> {
+	public:
+		/// @brief Constructor using an internal growable buffer
+		/// @param initial_capacity Initial size of the internal buffer
+		marshal_enc_bin_membuf(size_t initial_capacity=256): marshal_enc_bin_adapter(initial_capacity) {}
 
-// Start encoding a typed object
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_typed_begin(marshal_label label, bool extensible)
-{
-	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
-	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY)));
+		/// @brief Constructor using a caller-provided buffer
+		/// @param buffer   Buffer receiving the encoded data; it must outlive this object
+		/// @param capacity Size of `buffer`; exceeding it throws `exception_marshal`
+		marshal_enc_bin_membuf(void* buffer, size_t capacity): marshal_enc_bin_adapter(buffer, capacity) {}
 
-	// Encode the type identifier
-	encode_u32(label.m_label_id);
+		/// @brief Pointer to the encoded data
+		const char* data() const {return output().data();}
 
-	// Add the element on the stack with the position where the size indicator would
-	// be if enabled.
-	m_stack.emplace(marshal_bin_element_type::TYPED, get_curr_pos(), extensible);
+		/// @brief Size of the encoded data
+		size_t size() const {return output().size();}
 
-	// If required, prepare the space for the size indicator
-	if (extensible) encode_size_indicator(0);
-}
+		/// @brief Return a copy of the encoded data
+		std::string str() const {return output().str();}
 
-// Terminate encoding a typed object
-template<class STREAMPOS>
-inline void marshal_enc_bin<STREAMPOS>::encode_typed_end()
-{
-	assert(!m_stack.empty());
-	assert(m_stack.top().m_element_type == marshal_bin_element_type::TYPED);
-	if (m_stack.top().m_extensible) {
-		STREAMPOS currpos = get_curr_pos();
-		size_t size = pos_diff(m_stack.top().m_pos, currpos);
-		set_curr_pos(m_stack.top().m_pos);
-		encode_size_indicator(size-4);
-		set_curr_pos(currpos);
-	}
-	m_stack.pop();
-}
+		/// @brief Discard the encoded data keeping the allocated buffer
+		///
+		/// It must not be called in the middle of the encoding of an element.
+		void clear() {output().clear();}
+};
 
 // Write the required amount of bytes
 inline void marshal_enc_bin_ostream::write_bytes(const void* source, size_t length)
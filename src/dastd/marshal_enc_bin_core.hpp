@@ -0,0 +1,894 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "marshal_enc.hpp"
+#include "marshal_bin.hpp"
+#include "endian_aware.hpp"
+#include "utf8.hpp"
+#include "float.hpp"
+#include <limits>
+#include <span>
+#include <stack>
+
+namespace dastd {
+/// @brief Output policy of `marshal_enc_bin_core`
+///
+/// The policy writes the encoded bytes (`write`), returns the current
+/// position (`get_pos`) and moves back to a position previously returned
+/// by `get_pos` (`set_pos`) to back-patch the size indicators.
+/// Optionally, it can provide `pos_diff(p1, p2)` if the difference between
+/// two positions is not simply `p2-p1`.
+///
+/// `sink_fd` fulfills this concept, as well as `marshal_bin_output_membuf`
+/// and `marshal_bin_output_ostream` below.
+template<class OUTPUT>
+concept marshal_bin_output = requires(OUTPUT& output, const void* data, size_t length) {
+	output.write(data, length);
+	output.set_pos(output.get_pos());
+};
+
+/// @brief Binary little-endian marshaling encoder with no virtual methods
+///
+/// Encodes binary data using the binary little-endian encoding, exactly
+/// like `marshal_enc_bin`, but the output is a policy class known at compile
+/// time instead of a set of virtual methods. This way, the whole encoding path
+/// from `encode_u32` down to the `memcpy` into the output buffer can be inlined
+/// by the compiler, which matters when encoding many small messages.
+///
+/// Since this class does not derive from `marshal_enc`, it can not be passed
+/// to functions expecting a `marshal_enc&`: use `marshal_enc_bin_adapter`
+/// for that, or write the encoding functions as templates.
+///
+/// Example:
+///
+///     dastd::marshal_enc_bin_core<dastd::marshal_bin_output_membuf> enc;
+///     enc.encode_u32(1234);
+///     send(sock, enc.output().data(), enc.output().size(), 0);
+///
+/// @tparam OUTPUT Output policy; it can be a reference type (e.g. `sink_fd&`)
+template<marshal_bin_output OUTPUT>
+class marshal_enc_bin_core {
+	private:
+		/// @brief Type of the positions returned by the output policy
+		using pos_t = std::remove_cvref_t<decltype(std::declval<OUTPUT&>().get_pos())>;
+
+		/// @brief Stack element
+		struct stack_element {
+			marshal_bin_element_type m_element_type;
+
+			/// @brief Position where the element starts
+			pos_t m_pos;
+
+			/// @brief True if marked as extensible
+			bool m_extensible = false;
+
+			/// @brief Constructor
+			stack_element(marshal_bin_element_type element_type, pos_t pos, bool extensible=false):
+				m_element_type(element_type), m_pos(pos), m_extensible(extensible) {}
+
+			/// @brief Constructor
+			stack_element() {}
+		};
+
+		/// @brief Output policy
+		OUTPUT m_output;
+
+		/// @brief Internal encoding stack
+		std::stack<stack_element> m_stack;
+
+	public:
+		/// @brief Constructor
+		/// @param args Arguments passed to the constructor of the output policy
+		template<class... ARGS>
+		explicit marshal_enc_bin_core(ARGS&&... args): m_output(std::forward<ARGS>(args)...) {}
+
+		/// @brief Copy not allowed
+		marshal_enc_bin_core(const marshal_enc_bin_core&) = delete;
+
+		/// @brief Copy not allowed
+		marshal_enc_bin_core& operator=(const marshal_enc_bin_core&) = delete;
+
+		/// @brief Access the output policy
+		std::remove_reference_t<OUTPUT>& output() {return m_output;}
+
+		/// @brief Access the output policy
+		const std::remove_reference_t<OUTPUT>& output() const {return m_output;}
+
+		/// @brief Template for encoding integral types
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		template<marshal_integral_types TYPE>
+		void encode(TYPE value, uint32_t suggestions=0);
+
+		/// @brief Encode a bool
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_bool(bool value, uint32_t suggestions=0);
+
+		/// @brief Encode a uint8_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_u8(uint8_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a int8_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_i8(int8_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a uint16_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_u16(uint16_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a int16_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_i16(int16_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a uint32_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_u32(uint32_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a int32_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_i32(int32_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a uint64_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_u64(uint64_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a int64_t
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_i64(int64_t value, uint32_t suggestions=0);
+
+		/// @brief Encode a 64-bit floating point
+		/// @return Return the decoded data
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_f64(double value, uint32_t suggestions=0);
+
+		/// @brief Encode a std::string (UTF-8)
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_string_utf8(const std::string& value, uint32_t suggestions=0);
+
+		/// @brief Encode a std::u32string
+		/// @param value Value to be encoded.
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_u32string(const std::u32string& value, uint32_t suggestions=0);
+
+		/// @brief Start encoding a structure
+		/// @param extensible If true, the structure will be encoded so more or less fields can be expected.
+		///
+		/// See @link marshaling_structs documentation for details and examples.
+		void encode_struct_begin(bool extensible);
+
+		/// @brief Terminate encoding a structure
+		///
+		/// See @link marshaling_structs documentation for details and examples.
+		void encode_struct_end();
+
+		/// @brief Start encoding a field within a structure
+		/// @param label Contains the name of the field and its label-id
+		///
+		/// This must be invoked inside a `encode_struct_begin` and `encode_struct_end` pair.
+		/// See @link marshaling_structs documentation for details and examples.
+		void encode_struct_field_begin(marshal_label label, marshal_optional_field opt=marshal_optional_field::MANDATORY);
+
+		/// @brief Terminate encoding a field within a structure
+		///
+		/// This must be invoked inside a `encode_struct_begin` and `encode_struct_end` pair.
+		/// See @link marshaling_structs documentation for details and examples.
+		void encode_struct_field_end();
+
+		/// @brief Start encoding an array
+		/// @param count Number of elements that will be encoded
+		///
+		/// See @link marshaling_arrays documentation for details and examples.
+		void encode_array_begin(size_t count);
+
+		/// @brief Terminate encoding an array
+		///
+		/// See @link marshaling_arrays documentation for details and examples.
+		void encode_array_end();
+
+		/// @brief Start encoding an array element
+		/// @param count Number of elements that will be encoded
+		///
+		/// See @link marshaling_arrays documentation for details and examples.
+		void encode_array_element_begin();
+
+		/// @brief Terminate encoding an array element
+		///
+		/// See @link marshaling_arrays documentation for details and examples.
+		void encode_array_element_end();
+
+		/// @brief Encode a whole array of numbers
+		/// @param values Elements to be encoded
+		/// @param suggestions Encoding suggestions applied to each element; see @link marshaling_suggestions documentation @endlink.
+		///
+		/// See @link marshaling_arrays documentation for details and examples.
+		template<marshal_array_item_types TYPE>
+		void encode_array_of(std::span<const TYPE> values, uint32_t suggestions=0) {encode_array_of(values.data(), values.size(), marshal_array_item_of<TYPE>(), suggestions);}
+
+		/// @brief Encode a whole array of numbers
+		///
+		/// The encoding is the same produced by `encode_array_begin`, one
+		/// encoding per element and `encode_array_end`. On little-endian
+		/// hosts, unless the elements are encoded as varint, the elements
+		/// are written with a single `write` on the output.
+		///
+		/// @param data Pointer to the first element
+		/// @param count Number of elements
+		/// @param item Type of the elements
+		/// @param suggestions Encoding suggestions applied to each element; see @link marshaling_suggestions documentation @endlink.
+		void encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions=0);
+
+		/// @brief Start encoding a dictionary
+		/// @param count Number of elements that will be encoded
+		///
+		/// See @link marshaling_dictionaries documentation for details and examples.
+		void encode_dictionary_begin(size_t count);
+
+		/// @brief Terminate encoding a dictionary
+		///
+		/// See @link marshaling_dictionaries documentation for details and examples.
+		void encode_dictionary_end();
+
+		/// @brief Start encoding a dictionary element
+		/// @param key UTF-8 encoded string key that will be encoded along with the object
+		///
+		/// See @link marshaling_dictionaries documentation for details and examples.
+		void encode_dictionary_element_begin(const std::string& key);
+
+		/// @brief Terminate encoding a dictionary element
+		///
+		/// See @link marshaling_dictionaries documentation for details and examples.
+		void encode_dictionary_element_end();
+
+		/// @brief Start encoding a typed object
+		/// @param label Contains the name of the type and its label-id
+		/// @param extensible If true, the object is encoded in way that allows skipping it during decoding.
+		///
+		/// See @link marshaling_typeds documentation for details and examples.
+		void encode_typed_begin(marshal_label label, bool extensible);
+
+		/// @brief Terminate encoding a typed object
+		///
+		/// See @link marshaling_typeds documentation for details and examples.
+		void encode_typed_end();
+
+		/// @brief Encode fixed-size, known in advance, raw binary data
+		/// @param data Raw data
+		/// @param length Length of the raw data
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_binary(const void* data, size_t length, uint32_t suggestions=0);
+
+		/// @brief Encode fixed-size, known in advance, raw binary data
+		/// @param value Raw data
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_binary(const std::string& value, uint32_t suggestions=0) {encode_binary(value.c_str(), value.length(), suggestions);}
+
+		/// @brief Encode variably sized, raw binary data
+		/// @param data Raw data
+		/// @param length Length of the raw data
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_varsize_binary(const void* data, size_t length, uint32_t suggestions=0);
+
+		/// @brief Encode variably sized, raw binary data
+		/// @param value Raw data
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		void encode_varsize_binary(const std::string& value, uint32_t suggestions=0) {encode_varsize_binary(value.c_str(), value.length(), suggestions);}
+
+		/// @brief Select the encoding format
+		///
+		/// The format can be changed only between two root elements.
+		///
+		/// @param format Format used for the following elements
+		void set_format(marshal_bin_format format) {assert(m_stack.empty()); m_format = format;}
+
+		/// @brief Return the current encoding format
+		marshal_bin_format get_format() const {return m_format;}
+
+		/// @brief Write the format header
+		///
+		/// The header allows `marshal_dec_bin_core::decode_format_header` to
+		/// select the format used by this encoder.
+		void encode_format_header();
+
+	private:
+		/// @brief Encoding format
+		marshal_bin_format m_format = marshal_bin_format::FIXED;
+
+		/// @brief Tells whether an integer must be encoded as varint
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		/// @param type_size Size in bytes of the integral type
+		/// @param is_signed True if the integral type is signed
+		bool use_varint(uint32_t suggestions, size_t type_size, bool is_signed) const {return (m_format == marshal_bin_format::COMPACT) && marshal_bin_varint_suggested(suggestions, type_size, is_signed);}
+
+		/// @brief Encode a LEB128 varint
+		void encode_varint(uint64_t value) {
+			uint8_t encoded[marshal_bin_VARINT_MAX_LEN];
+			m_output.write(encoded, marshal_bin_varint_write(encoded, value));
+		}
+
+		/// @brief Encode a size indicaotr
+		void encode_size_indicator(size_t size) {
+			if (m_format == marshal_bin_format::COMPACT) encode_varint(size);
+			else encode_u32((uint32_t)size);
+		}
+
+		/// @brief Encode a size indicator that will be back-patched
+		///
+		/// It is always a fixed-size u32, so it can be overwritten once the
+		/// size is known.
+		void encode_patched_size_indicator(size_t size) {encode_u32((uint32_t)size);}
+
+		/// @brief Calculate the difference in bytes between two positions
+		/// @param p1 Lowest position value
+		/// @param p2 Highest position value
+		/// @return Returns the difference in bytes
+		size_t pos_diff(pos_t p1, pos_t p2) const {
+			if constexpr (requires {m_output.pos_diff(p1, p2);}) return m_output.pos_diff(p1, p2);
+			else return (size_t)(p2-p1);
+		}
+};
+
+/// @brief Output policy writing into a contiguous memory buffer
+///
+/// The buffer is either an internal growable one or a fixed-size one
+/// provided by the caller. The size indicators are back-patched in place.
+class marshal_bin_output_membuf {
+	public:
+		/// @brief Constructor using an internal growable buffer
+		/// @param initial_capacity Initial size of the internal buffer
+		marshal_bin_output_membuf(size_t initial_capacity=256) {m_storage.resize(initial_capacity); m_data=m_storage.data(); m_capacity=initial_capacity;}
+
+		/// @brief Constructor using a caller-provided buffer
+		/// @param buffer   Buffer receiving the encoded data; it must outlive this object
+		/// @param capacity Size of `buffer`; exceeding it throws `exception_marshal`
+		marshal_bin_output_membuf(void* buffer, size_t capacity): m_data((char*)buffer), m_capacity(capacity), m_growable(false) {}
+
+		/// @brief Copy not allowed
+		marshal_bin_output_membuf(const marshal_bin_output_membuf&) = delete;
+
+		/// @brief Copy not allowed
+		marshal_bin_output_membuf& operator=(const marshal_bin_output_membuf&) = delete;
+
+		/// @brief Pointer to the encoded data
+		const char* data() const {return m_data;}
+
+		/// @brief Size of the encoded data
+		size_t size() const {return m_size;}
+
+		/// @brief Return a copy of the encoded data
+		std::string str() const {return std::string(m_data, m_size);}
+
+		/// @brief Discard the encoded data keeping the allocated buffer
+		///
+		/// It must not be called in the middle of the encoding of an element.
+		void clear() {m_pos = m_size = 0;}
+
+		/// @brief Write the required amount of bytes
+		/// @param source The source buffer where to take the data to be written
+		/// @param length The required number of bytes
+		/// @throw dastd::exception_marshal if the caller-provided buffer is full
+		void write(const void* source, size_t length) {
+			if (m_pos + length > m_capacity) grow(m_pos + length);
+			memcpy(m_data + m_pos, source, length);
+			m_pos += length;
+			if (m_pos > m_size) m_size = m_pos;
+		}
+
+		/// @brief Get the current position into the buffer
+		size_t get_pos() const {return m_pos;}
+
+		/// @brief Set the current position into the buffer
+		/// @param pos Position previously returned by `get_pos()`
+		void set_pos(size_t pos) {assert(pos <= m_size); m_pos = pos;}
+
+	private:
+		/// @brief Enlarge the buffer
+		/// @param required Minimum required capacity
+		/// @throw dastd::exception_marshal if the buffer was provided by the caller
+		void grow(size_t required);
+
+		/// @brief Internal buffer (used only if growable)
+		std::string m_storage;
+
+		/// @brief Pointer to the buffer in use
+		char* m_data = nullptr;
+
+		/// @brief Size of the buffer in use
+		size_t m_capacity = 0;
+
+		/// @brief Current writing position
+		size_t m_pos = 0;
+
+		/// @brief Number of bytes written in the buffer
+		size_t m_size = 0;
+
+		/// @brief True if the buffer is the internal one
+		bool m_growable = true;
+};
+
+/// @brief Output policy writing on a std::ostream
+///
+/// The stream must be seekable if extensible elements are encoded.
+class marshal_bin_output_ostream {
+	public:
+		/// @brief Constructor
+		/// @param output Binary output stream; make sure it does no ASCII transaltions.
+		marshal_bin_output_ostream(std::ostream& output): m_output(output) {}
+
+		/// @brief Write the required amount of bytes
+		/// @param source The source buffer where to take the data to be written
+		/// @param length The required number of bytes
+		/// @throw dastd::exception_marshal
+		void write(const void* source, size_t length);
+
+		/// @brief Get the current position into the output stream
+		/// @throw dastd::exception_marshal
+		std::streampos get_pos() const;
+
+		/// @brief Set the current position into the output stream
+		/// @param pos Position previously returned by `get_pos()`
+		/// @throw dastd::exception_marshal
+		void set_pos(std::streampos pos);
+
+	private:
+		/// @brief Binary output stream
+		std::ostream& m_output;
+};
+
+// Template for encoding integral types
+template<marshal_bin_output OUTPUT>
+template<marshal_integral_types TYPE>
+inline void marshal_enc_bin_core<OUTPUT>::encode(TYPE value, uint32_t suggestions)
+{
+	if constexpr (std::is_same_v<TYPE, bool>) {
+		encode_bool(static_cast<bool>(value), suggestions);
+	}
+	else if constexpr (std::is_signed_v<TYPE>) {
+		if constexpr (sizeof(TYPE) == 1) encode_i8(static_cast<int8_t>(value), suggestions);
+		else if constexpr (sizeof(TYPE) == 2) encode_i16(static_cast<int16_t>(value), suggestions);
+		else if constexpr (sizeof(TYPE) == 4) encode_i32(static_cast<int32_t>(value), suggestions);
+		else if constexpr (sizeof(TYPE) == 8) encode_i64(static_cast<int64_t>(value), suggestions);
+	}
+	else {
+		if constexpr (sizeof(TYPE) == 1) encode_u8(static_cast<uint8_t>(value), suggestions);
+		else if constexpr (sizeof(TYPE) == 2) encode_u16(static_cast<uint16_t>(value), suggestions);
+		else if constexpr (sizeof(TYPE) == 4) encode_u32(static_cast<uint32_t>(value), suggestions);
+		else if constexpr (sizeof(TYPE) == 8) encode_u64(static_cast<uint64_t>(value), suggestions);
+	}
+}
+
+// Encode a bool
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_bool(bool value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	uint8_t v = (value ? 1 : 0);
+	m_output.write((const char*)&v, 1);
+}
+
+// Encode a uint8_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_u8(uint8_t value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	m_output.write((const char*)&value, 1);
+}
+
+// Encode a int8_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_i8(int8_t value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	m_output.write((const char*)&value, 1);
+}
+
+// Encode a uint16_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_u16(uint16_t value, uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(value), false)) {
+		encode_varint(value);
+		return;
+	}
+	uint8_t encoded[sizeof(value)];
+	native_to_little_endian(value, encoded);
+	m_output.write(encoded, sizeof(value));
+}
+
+// Encode a int16_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_i16(int16_t value, uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(value), true)) {
+		encode_varint(marshal_bin_zigzag_encode(value));
+		return;
+	}
+	uint8_t encoded[sizeof(value)];
+	native_to_little_endian(value, encoded);
+	m_output.write(encoded, sizeof(value));
+}
+
+// Encode a uint32_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_u32(uint32_t value, uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(value), false)) {
+		encode_varint(value);
+		return;
+	}
+	uint8_t encoded[sizeof(value)];
+	native_to_little_endian(value, encoded);
+	m_output.write(encoded, sizeof(value));
+}
+
+// Encode a int32_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_i32(int32_t value, uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(value), true)) {
+		encode_varint(marshal_bin_zigzag_encode(value));
+		return;
+	}
+	uint8_t encoded[sizeof(value)];
+	native_to_little_endian(value, encoded);
+	m_output.write(encoded, sizeof(value));
+}
+
+// Encode a uint64_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_u64(uint64_t value, uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(value), false)) {
+		encode_varint(value);
+		return;
+	}
+	uint8_t encoded[sizeof(value)];
+	native_to_little_endian(value, encoded);
+	m_output.write(encoded, sizeof(value));
+}
+
+// Encode a int64_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_i64(int64_t value, uint32_t suggestions)
+{
+	if (use_varint(suggestions, sizeof(value), true)) {
+		encode_varint(marshal_bin_zigzag_encode(value));
+		return;
+	}
+	uint8_t encoded[sizeof(value)];
+	native_to_little_endian(value, encoded);
+	m_output.write(encoded, sizeof(value));
+}
+
+// Encode a int64_t
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_f64(double value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	uint8_t encoded[8];
+	native_to_little_endian(pack_f64(value), encoded);
+	m_output.write(encoded, 8);
+}
+
+// Encode a std::string (UTF-8)
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_string_utf8(const std::string& value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	encode_u32((uint32_t)value.size(), marshal_suggest_increasing);
+	m_output.write(value.c_str(), value.size());
+}
+
+// Encode a std::u32string
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_u32string(const std::u32string& value, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	size_t len = calc_utf8_length(value.c_str(), value.length());
+	encode_u32((uint32_t)len, marshal_suggest_increasing);
+
+	size_t i;
+	char buf[UTF8_CHAR_MAX_LEN];
+	for (i=0; i<value.length(); i++) {
+		len = write_utf8_asciiz(buf, value[i]);
+		m_output.write(buf, len);
+	}
+}
+
+// (brief) Encode fixed-size, known in advance, raw binary data
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_binary(const void* data, size_t length, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	m_output.write(data, length);
+}
+
+// (brief) Encode variably sized, raw binary data
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_varsize_binary(const void* data, size_t length, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	assert(length <= std::numeric_limits<uint32_t>::max());
+	encode_u32((uint32_t)length, marshal_suggest_increasing);
+	m_output.write(data, length);
+}
+
+// Start encoding a structure
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_struct_begin(bool extensible)
+{
+	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
+	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY)));
+
+	m_stack.emplace(marshal_bin_element_type::STRUCT, m_output.get_pos(), extensible);
+
+	// Prepare the space for the size indicator
+	if (extensible) encode_patched_size_indicator(0);
+}
+
+// Terminate encoding a structure
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_struct_end()
+{
+	// Invoked encode_struct_end without being inside a STRUCT (stack empty)
+	assert(!m_stack.empty());
+	assert (m_stack.top().m_element_type == marshal_bin_element_type::STRUCT);
+
+	if (m_stack.top().m_extensible) {
+		pos_t currpos = m_output.get_pos();
+		size_t size = pos_diff(m_stack.top().m_pos, currpos);
+		m_output.set_pos(m_stack.top().m_pos);
+		encode_patched_size_indicator(size-4);
+		m_output.set_pos(currpos);
+	}
+	m_stack.pop();
+}
+
+// Start encoding a field within a structure
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_struct_field_begin(marshal_label label, marshal_optional_field opt)
+{
+	DASTD_NOWARN_UNUSED(label);
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::STRUCT);
+	switch(opt) {
+		case marshal_optional_field::MANDATORY: m_stack.emplace(marshal_bin_element_type::FIELD, m_output.get_pos(), false); break;
+		case marshal_optional_field::OPTIONAL_MISSING: {
+			encode_bool(false);
+			m_stack.emplace(marshal_bin_element_type::FIELD_MISSING, m_output.get_pos(), false);
+			break;
+		}
+		case marshal_optional_field::OPTIONAL_PRESENT: {
+			encode_bool(true);
+			m_stack.emplace(marshal_bin_element_type::FIELD, m_output.get_pos(), false);
+			break;
+		}
+	}
+
+}
+
+// Terminate encoding a field within a structure
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_struct_field_end()
+{
+	assert(!m_stack.empty());
+	assert((m_stack.top().m_element_type == marshal_bin_element_type::FIELD) || (m_stack.top().m_element_type == marshal_bin_element_type::FIELD_MISSING));
+	m_stack.pop();
+}
+
+// Start encoding an array
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_array_begin(size_t count)
+{
+	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
+	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY)));
+	encode_size_indicator(count);
+	m_stack.emplace(marshal_bin_element_type::ARRAY, m_output.get_pos(), false);
+}
+
+// Terminate encoding an array
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_array_end()
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::ARRAY);
+	m_stack.pop();
+}
+
+// Start encoding an array element
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_array_element_begin()
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::ARRAY);
+	m_stack.emplace(marshal_bin_element_type::ARRAY_ELEMENT, m_output.get_pos(), false);
+}
+
+// Terminate encoding an array element
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_array_element_end()
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::ARRAY_ELEMENT);
+	m_stack.pop();
+}
+
+// Encode a whole array of numbers
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions)
+{
+	encode_array_begin(count);
+	marshal_array_item_dispatch(item, [&](auto* tag) {
+		using ITEM = std::remove_pointer_t<decltype(tag)>;
+		const uint8_t* ptr = (const uint8_t*)data;
+
+		// Varints must be encoded one by one
+		if constexpr (std::is_integral_v<ITEM> && (sizeof(ITEM) > 1)) {
+			if (use_varint(suggestions, sizeof(ITEM), std::is_signed_v<ITEM>)) {
+				for (size_t i=0; i<count; i++) {
+					ITEM value;
+					memcpy(&value, ptr+i*sizeof(ITEM), sizeof(ITEM));
+					encode<ITEM>(value, suggestions);
+				}
+				return;
+			}
+		}
+
+		// The in-memory representation is already the encoded one
+		#ifdef DASTD_LITTLE_ENDIAN
+		if constexpr (std::is_integral_v<ITEM> || std::numeric_limits<ITEM>::is_iec559) {
+			if (count > 0) m_output.write(data, count*sizeof(ITEM));
+			return;
+		}
+		#endif
+
+		// Convert the elements in blocks
+		uint8_t encoded[4096];
+		constexpr size_t block_count = sizeof(encoded)/sizeof(ITEM);
+		for (size_t i=0; i<count; i+=block_count) {
+			size_t n = std::min(block_count, count-i);
+			for (size_t j=0; j<n; j++) {
+				ITEM value;
+				memcpy(&value, ptr+(i+j)*sizeof(ITEM), sizeof(ITEM));
+				if constexpr (std::is_same_v<ITEM, double>) native_to_little_endian(pack_f64(value), encoded+j*sizeof(ITEM));
+				else native_to_little_endian(value, encoded+j*sizeof(ITEM));
+			}
+			m_output.write(encoded, n*sizeof(ITEM));
+		}
+	});
+	encode_array_end();
+}
+
+// Start encoding an dictionary
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_dictionary_begin(size_t count)
+{
+	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, DICTIONARY_ELEMENT TYPED
+	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::DICTIONARY)));
+	encode_size_indicator(count);
+	m_stack.emplace(marshal_bin_element_type::DICTIONARY, m_output.get_pos(), false);
+}
+
+// Terminate encoding an dictionary
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_dictionary_end()
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY);
+	m_stack.pop();
+}
+
+// Start encoding an dictionary element
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_dictionary_element_begin(const std::string& key)
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY);
+	m_stack.emplace(marshal_bin_element_type::DICTIONARY_ELEMENT, m_output.get_pos(), false);
+	encode_string_utf8(key);
+}
+
+// Terminate encoding an dictionary element
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_dictionary_element_end()
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::DICTIONARY_ELEMENT);
+	m_stack.pop();
+}
+
+// Start encoding a typed object
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_typed_begin(marshal_label label, bool extensible)
+{
+	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
+	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_bin_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_bin_element_type::ARRAY)));
+
+	// Encode the type identifier
+	encode_u32(label.m_label_id);
+
+	// Add the element on the stack with the position where the size indicator would
+	// be if enabled.
+	m_stack.emplace(marshal_bin_element_type::TYPED, m_output.get_pos(), extensible);
+
+	// If required, prepare the space for the size indicator
+	if (extensible) encode_patched_size_indicator(0);
+}
+
+// Terminate encoding a typed object
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_typed_end()
+{
+	assert(!m_stack.empty());
+	assert(m_stack.top().m_element_type == marshal_bin_element_type::TYPED);
+	if (m_stack.top().m_extensible) {
+		pos_t currpos = m_output.get_pos();
+		size_t size = pos_diff(m_stack.top().m_pos, currpos);
+		m_output.set_pos(m_stack.top().m_pos);
+		encode_patched_size_indicator(size-4);
+		m_output.set_pos(currpos);
+	}
+	m_stack.pop();
+}
+
+// Write the format header
+template<marshal_bin_output OUTPUT>
+inline void marshal_enc_bin_core<OUTPUT>::encode_format_header()
+{
+	m_output.write(marshal_bin_FORMAT_MAGIC, sizeof(marshal_bin_FORMAT_MAGIC));
+	encode_u8((uint8_t)m_format);
+}
+
+// Enlarge the buffer
+inline void marshal_bin_output_membuf::grow(size_t required)
+{
+	if (!m_growable) {
+		DASTD_THROW(exception_marshal, "marshal_bin_output_membuf::write exceeded the buffer capacity of " << m_capacity << " bytes; required " << required)
+	}
+	size_t new_capacity = std::max(required, m_capacity*2);
+	m_storage.resize(new_capacity);
+	m_data = m_storage.data();
+	m_capacity = new_capacity;
+}
+
+// Write the required amount of bytes
+inline void marshal_bin_output_ostream::write(const void* source, size_t length)
+{
+	m_output.write((const char*)source, length);
+	if (m_output.bad() || m_output.fail()) {
+		DASTD_THROW(exception_marshal, "marshal_bin_output_ostream::write failed writing " << length << " bytes")
+	}
+}
+
+// Get the current position into the output stream
+inline std::streampos marshal_bin_output_ostream::get_pos() const
+{
+	std::streampos pos = m_output.tellp();
+	if (m_output.bad() || m_output.fail()) {
+		DASTD_THROW(exception_marshal, "marshal_bin_output_ostream::get_pos")
+	}
+	return pos;
+}
+
+// Set the current position into the output stream
+inline void marshal_bin_output_ostream::set_pos(std::streampos pos)
+{
+	m_output.seekp(pos);
+	if (m_output.bad() || m_output.fail()) {
+		DASTD_THROW(exception_marshal, "marshal_bin_output_ostream::set_pos")
+	}
+}
+
+} // namespace dastd
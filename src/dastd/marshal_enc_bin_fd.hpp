@@ -0,0 +1,35 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "marshal_enc_bin.hpp"
+#include "sink_fd.hpp"
+
+#ifdef DASTD_UNIX
+
+namespace dastd {
+
+/// @brief Binary little-endian marshaling encoder
+///
+/// Encodes binary data using the binary little-endian encoding.
+/// Operates by writing on a `sink_fd`, bypassing the std::ostream machinery.
+///
+/// Note: if an extensible element (struct or typed) does not fit in the
+/// `sink_fd` buffer, its size indicator is written by moving back the
+/// file position, so the file descriptor must be seekable.
+///
+/// All the encoding methods are inlined down to `sink_fd::write`; use
+/// `marshal_enc_bin_core<sink_fd&>` directly to avoid the virtual
+/// calls of the `marshal_enc` interface as well.
+class marshal_enc_bin_fd: public marshal_enc_bin_adapter<sink_fd&> {
+	public:
+		/// @brief Constructor
+		/// @param output Target sink
+		marshal_enc_bin_fd(sink_fd& output): marshal_enc_bin_adapter(output) {}
+};
+
+} // namespace dastd
+
+#endif // DASTD_UNIX
@@ -6,23 +6,46 @@
 #pragma once
 #include "marshal_enc.hpp"
 #include "json_encoder.hpp"
+#include "fmt.hpp"
 #include "char32string.hpp"
 #include "base64.hpp"
 #include "istream_membuf.hpp"
 #include "marshal_json.hpp"
+#include "float.hpp"
+#include "fd_io.hpp"
+#include <cstring>
+#include <memory>
 #include <stack>
-#include <iomanip>
 #include <iostream>
 #include <limits>
 
 namespace dastd {
-/// @brief Binary little-endian marshaling encoder
+/// @brief JSON marshaling encoder
 ///
-/// Encodes binary data using the binary little-endian encoding.
-/// See @link marshaling_json_format "Marshaling binary format" @endlink
-/// for details on the binary encoding format.
+/// The JSON text is formatted directly in a character buffer, numbers
+/// included, and written to the target in large chunks. The target can be:
+///
+/// - a `std::ostream`: the buffer is written at the end of each root value,
+///   when `flush` is called and by the destructor;
+/// - a `std::string`: the text is appended growing the string as needed;
+///   the string is trimmed to the actual length at the end of each root value,
+///   when `flush` is called and by the destructor;
+/// - a fixed buffer provided by the caller: `exception_marshal` is thrown
+///   if it is not large enough; `get_length` returns the length of the text;
+/// - a POSIX file descriptor: the buffer is written when full, when `flush`
+///   is called and by the destructor.
+///
+/// The destructor ignores the write errors: call `flush` explicitly to be
+/// notified of them.
 class marshal_enc_json: public marshal_enc {
+	public:
+		/// @brief Size of the internal buffer for the `std::ostream` and file descriptor targets
+		static constexpr size_t BUFFER_SIZE = 64*1024;
+
 	private:
+		/// @brief Where the JSON text is written
+		enum class target_t: uint8_t {OSTREAM, STRING, BUFFER, FD};
+
 		/// @brief Stack element
 		struct stack_element {
 			/// @brief Type of the element on the stack
@@ -57,13 +80,175 @@ class marshal_enc_json: public marshal_enc {
 		///        of TYPEID_AS_STRUCT_FIELD
 		marshal_label m_type_id;
 
+		/// @brief Where the JSON text is written
+		target_t m_target;
+
+		/// @brief Target stream for `target_t::OSTREAM`
+		std::ostream* m_out_stream = nullptr;
+
+		/// @brief Target string for `target_t::STRING`
+		std::string* m_out_string = nullptr;
+
+		/// @brief Length of `m_out_string` before the beginning of `m_buf`
+		size_t m_out_string_base = 0;
+
+		/// @brief Target file descriptor for `target_t::FD`
+		int m_fd = -1;
+
+		/// @brief Internal buffer for `target_t::OSTREAM` and `target_t::FD`
+		std::unique_ptr<char[]> m_own_buffer;
+
+		/// @brief Buffer where the text is formatted
+		char* m_buf = nullptr;
+
+		/// @brief Size of `m_buf`
+		size_t m_buf_size = 0;
+
+		/// @brief Characters of `m_buf` in use
+		size_t m_used = 0;
+
+		/// @brief Constructor
+		marshal_enc_json(target_t target, marshal_json_polymorphic_encoding polymorphic_encoding, const std::string& typed_field):
+			m_polymorphic_encoding(polymorphic_encoding), m_typed_field(typed_field), m_target(target) {}
+
+		/// @brief Make room in the buffer for at least `length` more characters
+		/// @param length Number of characters
+		/// @throw Throws `exception_marshal` if the caller buffer is full
+		void make_room(size_t length);
+
+		/// @brief Write data not fitting in the buffer
+		/// @param data Data to be written
+		/// @param length Number of characters
+		void put_slow(const char* data, size_t length);
+
+		/// @brief Write one character
+		/// @param ch Character to be written
+		void put(char ch) {
+			if (m_used == m_buf_size) make_room(1);
+			m_buf[m_used++] = ch;
+		}
+
+		/// @brief Write a sequence of characters
+		/// @param data Data to be written
+		/// @param length Number of characters
+		void put(const char* data, size_t length) {
+			if (length <= m_buf_size - m_used) {
+				memcpy(m_buf+m_used, data, length);
+				m_used += length;
+			}
+			else put_slow(data, length);
+		}
+
+		/// @brief Write a string literal
+		template<size_t N>
+		void put(const char (&literal)[N]) {put(literal, N-1);}
+
+		/// @brief Write text formatted by a function directly in the buffer
+		///
+		/// If the buffer has not room for `MAX_LENGTH` characters, the text
+		/// is formatted in a temporary buffer and then written.
+		///
+		/// @tparam MAX_LENGTH Maximum number of characters written by `format`
+		/// @param format Function `size_t format(char* p)` writing the text and returning its length
+		template<size_t MAX_LENGTH, class FORMAT>
+		void put_formatted(FORMAT&& format) {
+			if (m_buf_size - m_used >= MAX_LENGTH) {
+				m_used += format(m_buf+m_used);
+			}
+			else {
+				char temp[MAX_LENGTH];
+				put(temp, format(temp));
+			}
+		}
+
+		/// @brief Write an integer
+		template<class INTTYPE>
+		void put_integer(INTTYPE value) {
+			put_formatted<std::numeric_limits<INTTYPE>::digits10+2>([&](char* p) {
+				return fmt_integral(p, value);
+			});
+		}
+
+		/// @brief Write binary data encoded base-64 between double quotes
+		/// @param data Raw data
+		/// @param length Length of the raw data
+		void encode_base64(const void* data, size_t length);
+
+		/// @brief Invoked at the end of each value: completes the output at the end of a root value
+		void end_of_value() {
+			if (m_stack.empty() && ((m_target == target_t::OSTREAM) || (m_target == target_t::STRING))) flush();
+		}
+
 	public:
 		/// @brief Constructor
 		/// @param out Stream where the JSON data will be written
 		/// @param polymorphic_encoding   See @ref marshal_json_polymorphic_encoding
 		/// @param typed_field            Name of the field in case of `TYPEID_AS_STRUCT_FIELD`; see @ref marshal_json_polymorphic_encoding
 		marshal_enc_json(std::ostream &out, marshal_json_polymorphic_encoding polymorphic_encoding=marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME, const std::string& typed_field="$type"):
-			m_polymorphic_encoding(polymorphic_encoding), m_typed_field(typed_field), m_out(out) {}
+			marshal_enc_json(target_t::OSTREAM, polymorphic_encoding, typed_field) {
+			m_out_stream = &out;
+			m_own_buffer.reset(new char[BUFFER_SIZE]);
+			m_buf = m_own_buffer.get();
+			m_buf_size = BUFFER_SIZE;
+		}
+
+		/// @brief Constructor
+		/// @param out String where the JSON data will be appended
+		/// @param polymorphic_encoding   See @ref marshal_json_polymorphic_encoding
+		/// @param typed_field            Name of the field in case of `TYPEID_AS_STRUCT_FIELD`; see @ref marshal_json_polymorphic_encoding
+		marshal_enc_json(std::string &out, marshal_json_polymorphic_encoding polymorphic_encoding=marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME, const std::string& typed_field="$type"):
+			marshal_enc_json(target_t::STRING, polymorphic_encoding, typed_field) {
+			m_out_string = &out;
+			m_out_string_base = out.size();
+			m_buf = out.data() + m_out_string_base;
+		}
+
+		/// @brief Constructor
+		/// @param buffer Buffer where the JSON data will be written; it is not NUL-terminated
+		/// @param size   Size of the buffer
+		/// @param polymorphic_encoding   See @ref marshal_json_polymorphic_encoding
+		/// @param typed_field            Name of the field in case of `TYPEID_AS_STRUCT_FIELD`; see @ref marshal_json_polymorphic_encoding
+		marshal_enc_json(char* buffer, size_t size, marshal_json_polymorphic_encoding polymorphic_encoding=marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME, const std::string& typed_field="$type"):
+			marshal_enc_json(target_t::BUFFER, polymorphic_encoding, typed_field) {
+			m_buf = buffer;
+			m_buf_size = size;
+		}
+
+		#ifdef DASTD_UNIX
+		/// @brief Constructor
+		/// @param fd File descriptor open for writing; it is not closed by the destructor
+		/// @param polymorphic_encoding   See @ref marshal_json_polymorphic_encoding
+		/// @param typed_field            Name of the field in case of `TYPEID_AS_STRUCT_FIELD`; see @ref marshal_json_polymorphic_encoding
+		marshal_enc_json(int fd, marshal_json_polymorphic_encoding polymorphic_encoding=marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME, const std::string& typed_field="$type"):
+			marshal_enc_json(target_t::FD, polymorphic_encoding, typed_field) {
+			m_fd = fd;
+			m_own_buffer.reset(new char[BUFFER_SIZE]);
+			m_buf = m_own_buffer.get();
+			m_buf_size = BUFFER_SIZE;
+		}
+		#endif
+
+		/// @brief Destructor
+		virtual ~marshal_enc_json() {try {flush();} catch(...) {}}
+
+		/// @brief Copy not allowed
+		marshal_enc_json(const marshal_enc_json&) = delete;
+
+		/// @brief Copy not allowed
+		marshal_enc_json& operator=(const marshal_enc_json&) = delete;
+
+		/// @brief Write the buffered text to the target
+		///
+		/// For the `std::string` target, it trims the string to the actual length.
+		/// It does nothing for the caller buffer target.
+		///
+		/// @throw Throws `exception_fd` in case of I/O error on the file descriptor
+		void flush();
+
+		/// @brief Return the number of characters in the buffer
+		///
+		/// For the caller buffer target, it is the length of the JSON text written so far.
+		size_t get_length() const {return m_used;}
 
 		/// @brief Encode a bool
 		/// @param value Value to be encoded.
@@ -220,16 +405,109 @@ class marshal_enc_json: public marshal_enc {
 		///       This includes a length field, some kind of terminator in the encoding or anything else suitable.
 		virtual void internal_encode_varsize_binary(const void* data, size_t length, uint32_t suggestions=0) override;
 
-		/// @brief Output stream
-		std::ostream &m_out;
+		/// @brief Encode a whole array of numbers
+		///
+		/// The elements are written in a tight loop without going through
+		/// the encoding stack; the integers are formatted in a local buffer
+		/// that is written to the stream in blocks.
+		///
+		/// @param data Pointer to the first element
+		/// @param count Number of elements
+		/// @param item Type of the elements
+		/// @param suggestions Encoding suggestions; see @link marshaling_suggestions documentation @endlink.
+		virtual void internal_encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions) override;
 };
 
+//------------------------------------------------------------------------------
+// (brief) Write the buffered text to the target
+//------------------------------------------------------------------------------
+inline void marshal_enc_json::flush()
+{
+	switch(m_target) {
+		case target_t::OSTREAM: {
+			if (m_used > 0) m_out_stream->write(m_buf, (std::streamsize)m_used);
+			m_used = 0;
+			break;
+		}
+		case target_t::STRING: {
+			// The string has been resized ahead; trim it to the text written
+			m_out_string_base += m_used;
+			m_out_string->resize(m_out_string_base);
+			m_buf = m_out_string->data() + m_out_string_base;
+			m_buf_size = 0;
+			m_used = 0;
+			break;
+		}
+		case target_t::BUFFER: break;
+		case target_t::FD: {
+			#ifdef DASTD_UNIX
+			if (m_used > 0) fd_write_all(m_fd, m_buf, m_used);
+			#endif
+			m_used = 0;
+			break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Make room in the buffer for at least `length` more characters
+// (param) length Number of characters
+//------------------------------------------------------------------------------
+inline void marshal_enc_json::make_room(size_t length)
+{
+	switch(m_target) {
+		case target_t::OSTREAM:
+		case target_t::FD: {
+			assert(length <= m_buf_size);
+			flush();
+			break;
+		}
+		case target_t::STRING: {
+			// Use all the capacity already allocated, growing geometrically
+			size_t new_size = std::max({m_used + length, m_buf_size * 2, (size_t)256});
+			new_size = std::max(new_size, m_out_string->capacity() - m_out_string_base);
+			m_out_string->resize(m_out_string_base + new_size);
+			m_buf = m_out_string->data() + m_out_string_base;
+			m_buf_size = new_size;
+			break;
+		}
+		case target_t::BUFFER: {
+			DASTD_THROW(exception_marshal, "marshal_enc_json: the output buffer of " << m_buf_size << " characters is full");
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Write data not fitting in the buffer
+// (param) data Data to be written
+// (param) length Number of characters
+//------------------------------------------------------------------------------
+inline void marshal_enc_json::put_slow(const char* data, size_t length)
+{
+	if ((m_target == target_t::OSTREAM) || (m_target == target_t::FD)) {
+		flush();
+		// Large blocks bypass the buffer
+		if (length >= m_buf_size) {
+			if (m_target == target_t::OSTREAM) m_out_stream->write(data, (std::streamsize)length);
+			#ifdef DASTD_UNIX
+			else fd_write_all(m_fd, data, length);
+			#endif
+			return;
+		}
+	}
+	else make_room(length);
+	memcpy(m_buf+m_used, data, length);
+	m_used += length;
+}
+
 // Encode a bool
 inline void marshal_enc_json::encode_bool(bool value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << (value ? "true" : "false");
+	if (value) put("true");
+	else put("false");
+	end_of_value();
 }
 
 // Encode a uint8_t
@@ -237,7 +515,8 @@ inline void marshal_enc_json::encode_u8(uint8_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << (unsigned)value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a int8_t
@@ -245,7 +524,8 @@ inline void marshal_enc_json::encode_i8(int8_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << (int)value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a uint16_t
@@ -253,7 +533,8 @@ inline void marshal_enc_json::encode_u16(uint16_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a int16_t
@@ -261,7 +542,8 @@ inline void marshal_enc_json::encode_i16(int16_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a uint32_t
@@ -269,7 +551,8 @@ inline void marshal_enc_json::encode_u32(uint32_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a int32_t
@@ -277,7 +560,8 @@ inline void marshal_enc_json::encode_i32(int32_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a uint64_t
@@ -285,7 +569,8 @@ inline void marshal_enc_json::encode_u64(uint64_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a int64_t
@@ -293,7 +578,8 @@ inline void marshal_enc_json::encode_i64(int64_t value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << value;
+	put_integer(value);
+	end_of_value();
 }
 
 // Encode a 64-bit floating point
@@ -301,7 +587,8 @@ inline void marshal_enc_json::encode_f64(double value, uint32_t suggestions)
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << std::fixed << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+	put_formatted<WRITE_DOUBLE_MAX_LENGTH>([&](char* p) {return write_double(p, value);});
+	end_of_value();
 }
 
 // Encode a std::string (UTF-8)
@@ -309,11 +596,12 @@ inline void marshal_enc_json::encode_string_utf8(const std::string& value, uint3
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << '"';
-	if (!json_encode_string_from_UTF8(m_out, value)) {
+	put('"');
+	if (!json_encode_string_from_UTF8_with(value.data(), value.size(), [this](const char* data, size_t length) {put(data, length);})) {
 		DASTD_THROW(exception_marshal, "marshal_enc_json::encode_string_utf8 Error decoding UTF-8 string");
 	}
-	m_out << '"';
+	put('"');
+	end_of_value();
 }
 
 // Encode a std::u32string
@@ -321,9 +609,30 @@ inline void marshal_enc_json::encode_u32string(const std::u32string& value, uint
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	m_out << '"';
-	json_encode_string(m_out, value);
-	m_out << '"';
+	put('"');
+	for(auto ch32: value) {
+		put_formatted<JSON_ENCODE_CHAR_MAX_LENGTH>([&](char* p) {return json_encode_char(p, ch32);});
+	}
+	put('"');
+	end_of_value();
+}
+
+//------------------------------------------------------------------------------
+// (brief) Write binary data encoded base-64 between double quotes
+// (param) data Raw data
+// (param) length Length of the raw data
+//------------------------------------------------------------------------------
+inline void marshal_enc_json::encode_base64(const void* data, size_t length)
+{
+	// Blocks of a multiple of 3 bytes, so that only the last one is padded
+	constexpr size_t block_len = 3*256;
+	const uint8_t* ptr = (const uint8_t*)data;
+	put('"');
+	for (size_t offs=0; offs<length; offs+=block_len) {
+		size_t len = std::min(block_len, length-offs);
+		put_formatted<base64_encoded_length(block_len)>([&](char* p) {return base64_encode(ptr+offs, len, p);});
+	}
+	put('"');
 }
 
 // (brief) Encode fixed-size, known in advance, raw binary data
@@ -331,10 +640,8 @@ inline void marshal_enc_json::internal_encode_binary(const void* data, size_t le
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	istream_membuf inp(data, length);
-	m_out << '"';
-	base64_encode(inp, m_out);
-	m_out << '"';
+	encode_base64(data, length);
+	end_of_value();
 }
 
 // (brief) Encode variably sized, raw binary data
@@ -342,10 +649,38 @@ inline void marshal_enc_json::internal_encode_varsize_binary(const void* data, s
 {
 	DASTD_NOWARN_UNUSED(suggestions);
 	assert(!m_is_typed);
-	istream_membuf inp(data, length);
-	m_out << '"';
-	base64_encode(inp, m_out);
-	m_out << '"';
+	encode_base64(data, length);
+	end_of_value();
+}
+
+// (brief) Encode a whole array of numbers
+inline void marshal_enc_json::internal_encode_array_of(const void* data, size_t count, marshal_array_item item, uint32_t suggestions)
+{
+	DASTD_NOWARN_UNUSED(suggestions);
+	assert(!m_is_typed);
+	// Invoked encode_array_of inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
+	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_json_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_json_element_type::ARRAY) && (m_stack.top().m_element_type != marshal_json_element_type::DICTIONARY)));
+
+	marshal_array_item_dispatch(item, [&](auto* tag) {
+		using ITEM = std::remove_pointer_t<decltype(tag)>;
+		const uint8_t* ptr = (const uint8_t*)data;
+		put('[');
+		// Room for a separator and the longest number
+		constexpr size_t max_item_len = 1 + (std::is_same_v<ITEM, double> ? WRITE_DOUBLE_MAX_LENGTH : std::numeric_limits<ITEM>::digits10+2);
+		for (size_t i=0; i<count; i++) {
+			ITEM value;
+			memcpy(&value, ptr+i*sizeof(ITEM), sizeof(ITEM));
+			put_formatted<max_item_len>([&](char* p) {
+				size_t len = 0;
+				if (i > 0) p[len++] = ',';
+				if constexpr (std::is_same_v<ITEM, double>) len += write_double(p+len, value);
+				else len += fmt_integral(p+len, value);
+				return len;
+			});
+		}
+		put(']');
+	});
+	end_of_value();
 }
 
 // Start encoding a structure
@@ -356,14 +691,14 @@ inline void marshal_enc_json::encode_struct_begin(bool extensible)
 	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_json_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_json_element_type::ARRAY) && (m_stack.top().m_element_type != marshal_json_element_type::DICTIONARY)));
 
 	m_stack.emplace(marshal_json_element_type::STRUCT);
-	m_out << '{';
+	put('{');
 
 	if (m_is_typed) {
 		m_is_typed = false;
 		assert(m_stack.top().m_items_count == 0);
 		m_stack.top().m_items_count++;
 		encode_string_utf8(m_typed_field);
-	  m_out << ':';
+	  put(':');
 		encode_string_utf8(m_type_id.m_label_text);
 	}
 }
@@ -375,8 +710,9 @@ inline void marshal_enc_json::encode_struct_end()
 	assert(!m_stack.empty());
 	assert (m_stack.top().m_element_type == marshal_json_element_type::STRUCT);
 	assert(!m_is_typed);
-	m_out << '}';
+	put('}');
 	m_stack.pop();
+	end_of_value();
 }
 
 // Start encoding a field within a structure
@@ -386,14 +722,14 @@ inline void marshal_enc_json::encode_struct_field_begin(marshal_label label, mar
 	assert(!m_stack.empty());
 	assert(m_stack.top().m_element_type == marshal_json_element_type::STRUCT);
 	if (m_stack.top().m_items_count > 0) {
-		m_out << ',';
+		put(',');
 	}
 	m_stack.top().m_items_count++;
 	m_stack.emplace(marshal_json_element_type::FIELD);
 
 	encode_string_utf8(label.m_label_text);
-	m_out << ':';
-	if (opt == marshal_optional_field::OPTIONAL_MISSING) m_out << "null";
+	put(':');
+	if (opt == marshal_optional_field::OPTIONAL_MISSING) put("null");
 }
 
 // Terminate encoding a field within a structure
@@ -413,7 +749,7 @@ inline void marshal_enc_json::encode_array_begin(size_t count)
 	// Invoked encode_struct_begin inside a STRUCT, ARRAY or DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, ARRAY_ELEMENT, DICTRIONARY_ELEMENT or TYPED
 	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_json_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_json_element_type::ARRAY) && (m_stack.top().m_element_type != marshal_json_element_type::DICTIONARY)));
 	m_stack.emplace(marshal_json_element_type::ARRAY);
-	m_out << '[';
+	put('[');
 }
 
 // Terminate encoding an array
@@ -423,7 +759,8 @@ inline void marshal_enc_json::encode_array_end()
 	assert(m_stack.top().m_element_type == marshal_json_element_type::ARRAY);
 	assert(!m_is_typed);
 	m_stack.pop();
-	m_out << ']';
+	put(']');
+	end_of_value();
 }
 
 // Start encoding an array element
@@ -433,7 +770,7 @@ inline void marshal_enc_json::encode_array_element_begin()
 	assert(m_stack.top().m_element_type == marshal_json_element_type::ARRAY);
 	assert(!m_is_typed);
 	if (m_stack.top().m_items_count > 0) {
-		m_out << ',';
+		put(',');
 	}
 	m_stack.top().m_items_count++;
 	m_stack.emplace(marshal_json_element_type::ARRAY_ELEMENT);
@@ -456,7 +793,7 @@ inline void marshal_enc_json::encode_dictionary_begin(size_t count)
 	// Invoked encode_struct_begin inside a STRUCT o DICTIONARY; it should be at root or inside a STRUCT_ELEMENT, DICTIONARY_ELEMENT TYPED
 	assert(m_stack.empty() || ((m_stack.top().m_element_type != marshal_json_element_type::STRUCT) && (m_stack.top().m_element_type != marshal_json_element_type::DICTIONARY) && (m_stack.top().m_element_type != marshal_json_element_type::DICTIONARY)));
 	m_stack.emplace(marshal_json_element_type::DICTIONARY);
-	m_out << '{';
+	put('{');
 }
 
 // Terminate encoding a dictionary
@@ -466,7 +803,8 @@ inline void marshal_enc_json::encode_dictionary_end()
 	assert(m_stack.top().m_element_type == marshal_json_element_type::DICTIONARY);
 	assert(!m_is_typed);
 	m_stack.pop();
-	m_out << '}';
+	put('}');
+	end_of_value();
 }
 
 // Start encoding a dictionary element
@@ -476,10 +814,10 @@ inline void marshal_enc_json::encode_dictionary_element_begin(const std::string&
 	assert(m_stack.top().m_element_type == marshal_json_element_type::DICTIONARY);
 	assert(!m_is_typed);
 	if (m_stack.top().m_items_count > 0) {
-		m_out << ',';
+		put(',');
 	}
 	encode_string_utf8(key);
-	m_out << ':';
+	put(':');
 	m_stack.top().m_items_count++;
 	m_stack.emplace(marshal_json_element_type::DICTIONARY_ELEMENT);
 }
@@ -504,10 +842,10 @@ inline void marshal_enc_json::encode_typed_begin(marshal_label label, bool exten
 
 	switch(m_polymorphic_encoding) {
 		case marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME: {
-			m_out << '{';
+			put('{');
 			// Encode the type identifier
 			encode_string_utf8(label.m_label_text);
-			m_out << ':';
+			put(':');
 			break;
 		}
 		case marshal_json_polymorphic_encoding::TYPEID_AS_STRUCT_FIELD: {
@@ -530,7 +868,7 @@ inline void marshal_enc_json::encode_typed_end()
 	assert(!m_is_typed);
 	switch(m_polymorphic_encoding) {
 		case marshal_json_polymorphic_encoding::TYPEID_AS_FIELD_NAME: {
-		  m_out << '}';
+		  put('}');
 			break;
 		}
 		case marshal_json_polymorphic_encoding::TYPEID_AS_STRUCT_FIELD: {
@@ -538,6 +876,7 @@ inline void marshal_enc_json::encode_typed_end()
 		}
 	}
 	m_stack.pop();
+	end_of_value();
 }
 
 } // namespace dastd
@@ -6,9 +6,11 @@
 #pragma once
 #include "defs.hpp"
 #include <iostream>
+#include <charconv>
 #include <cmath>
 #include "string_tools.hpp"
 #include "strtointegral.hpp"
+#include "float.hpp"
 namespace dastd {
 
 /// @brief Container able to manage a number in multiple forms
@@ -17,6 +19,13 @@ namespace dastd {
 /// and made available under multiple forms.
 /// The number is rendered as `double` and, if suitabile, as an
 /// integral type of any kind up to `uint64_t`.
+///
+/// The plain decimal notation (for example `-12`, `3.25` or `1e-5`) is
+/// parsed in a single pass with no memory allocation: the integer value
+/// is computed while scanning the digits and the double value is obtained
+/// with `std::from_chars`, that is correctly rounded. The other notations
+/// accepted by `std::stod` (hexadecimal, `inf`, `nan`, etc.) go through
+/// a slower path.
 class multinum {
 	private:
 		/// @brief Double value
@@ -47,7 +56,25 @@ class multinum {
 		/// @brief Decoding level
 		level_t m_level = level_t::INVALID;
 
+		/// @brief Max length of a number in the decimal notation made of characters other than `char`
+		///
+		/// Such numbers are copied in a local buffer to be passed to `std::from_chars`;
+		/// the longer ones go through the slower path.
+		static constexpr size_t MAX_WIDE_DECIMAL_LENGTH = 128;
+
+		/// @brief Parse the plain decimal notation in a single pass
+		/// @tparam CHARTYPE Type of the character
+		/// @param str       Pointer to the string begin
+		/// @param len       Length of the string
+		/// @return Returns `false` if the text is not in the plain decimal notation
+		///         and it must go through `internal_parse`; in that case, the object
+		///         is left cleared.
+		template<class CHARTYPE>
+		bool parse_decimal(const CHARTYPE* str, size_t len);
+
 		/// @brief Internal parsing code. Relies on a temporary std::string provided by the caller
+		///
+		/// Used for the notations not handled by `parse_decimal`.
 		void internal_parse(std::string& text);
 
 		/// @brief Set the double value and, if suitable, the integers
@@ -120,7 +147,7 @@ inline void multinum::print(std::ostream& o) const
 {
 	switch(m_level) {
 		case level_t::INVALID: o << "INVALID"; break;
-		case level_t::DOUBLE_ONLY: o << m_value_double; break;
+		case level_t::DOUBLE_ONLY: write_double(o, m_value_double); break;
 		case level_t::INT64: o << m_value_integral.i64; break;
 		case level_t::UINT64: o << m_value_integral.u64; break;
 	}
@@ -145,6 +172,8 @@ template<class CHARTYPE>
 void multinum::parse(const CHARTYPE* str, size_t len)
 {
 	clear();
+	if (parse_decimal(str, len)) return;
+
 	std::string tmpstr;
 	size_t i;
 	tmpstr.reserve(len);
@@ -163,15 +192,121 @@ void multinum::parse(const CHARTYPE* str, size_t len)
 template<class STRTYPE>
 void multinum::parse(const STRTYPE& str)
 {
-	clear();
-	std::string tmpstr;
-	for(auto ch: str) {
-		char32_t ch32 = cast_to_unsigned<char32_t>(ch);
-		// If out of range characters are found, don't decode
-		if ((ch32 < 32) || (ch32 > 126)) return;
-		tmpstr.push_back((char)ch32);
+	// Contiguous strings can go through the fast path
+	if constexpr (requires {str.data(); str.size();}) {
+		parse(str.data(), str.size());
 	}
-	internal_parse(tmpstr);
+	else {
+		clear();
+		std::string tmpstr;
+		for(auto ch: str) {
+			char32_t ch32 = cast_to_unsigned<char32_t>(ch);
+			// If out of range characters are found, don't decode
+			if ((ch32 < 32) || (ch32 > 126)) return;
+			tmpstr.push_back((char)ch32);
+		}
+		internal_parse(tmpstr);
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Parse the plain decimal notation in a single pass
+// (param) str Pointer to the string begin
+// (param) len Length of the string
+// (return) Returns `false` if the text is not in the plain decimal notation
+//
+// The accepted notation is the one of JSON, with an optional leading '+'
+// and optionally surrounded by spaces. The leading zeros are decimal.
+// While scanning, the integral digits are accumulated in a `uint64_t`:
+// if the number has no fraction and no exponent and it fits, the double
+// value is obtained by conversion (correctly rounded) and `std::from_chars`
+// is not even invoked.
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+bool multinum::parse_decimal(const CHARTYPE* str, size_t len)
+{
+	auto char_at = [str](size_t pos) {return cast_to_unsigned<char32_t, CHARTYPE>(str[pos]);};
+	auto digit_at = [&char_at](size_t pos) {return (uint32_t)(char_at(pos) - U'0');};
+
+	// Skip the leading and trailing spaces
+	size_t begin = 0, end = len;
+	while ((begin < end) && (char_at(begin) == ' ')) begin++;
+	while ((end > begin) && (char_at(end-1) == ' ')) end--;
+	if (begin == end) return false;
+
+	// Sign; `std::from_chars` does not accept the '+'
+	bool negative = (char_at(begin) == '-');
+	if (negative || (char_at(begin) == '+')) begin++;
+	size_t i = begin;
+
+	// Integral part
+	uint64_t mantissa = 0;
+	bool overflow = false;
+	size_t digits = 0;
+	for (; (i < end) && (digit_at(i) <= 9); i++, digits++) {
+		uint32_t digit = digit_at(i);
+		if (mantissa > (UINT64_MAX - digit) / 10) overflow = true;
+		else mantissa = mantissa*10 + digit;
+	}
+
+	// Fraction and exponent
+	bool integral = true;
+	if ((i < end) && (char_at(i) == '.')) {
+		integral = false;
+		for (i++; (i < end) && (digit_at(i) <= 9); i++) digits++;
+	}
+	if (digits == 0) return false;
+	if ((i < end) && ((char_at(i) == 'e') || (char_at(i) == 'E'))) {
+		integral = false;
+		i++;
+		if ((i < end) && ((char_at(i) == '+') || (char_at(i) == '-'))) i++;
+		size_t exp_begin = i;
+		while ((i < end) && (digit_at(i) <= 9)) i++;
+		if (i == exp_begin) return false;
+	}
+	if (i != end) return false;
+
+	// Integer numbers fitting 64 bits
+	if (integral && !overflow) {
+		m_value_double = (negative ? -(double)mantissa : (double)mantissa);
+		m_level = level_t::DOUBLE_ONLY;
+		if (!negative) {
+			if (mantissa <= (uint64_t)INT64_MAX) {
+				m_value_integral.i64 = (int64_t)mantissa;
+				m_level = level_t::INT64;
+			}
+			else {
+				m_value_integral.u64 = mantissa;
+				m_level = level_t::UINT64;
+			}
+		}
+		else if (mantissa <= (uint64_t)INT64_MAX + 1) {
+			m_value_integral.i64 = (int64_t)(0 - mantissa);
+			m_level = level_t::INT64;
+		}
+		return true;
+	}
+
+	// All the other numbers go through `std::from_chars`
+	const char* first;
+	char buffer[MAX_WIDE_DECIMAL_LENGTH];
+	size_t length = end - begin + (negative ? 1 : 0);
+	if constexpr (sizeof(CHARTYPE) == 1) {
+		first = (const char*)str + begin - (negative ? 1 : 0);
+	}
+	else {
+		if (length > sizeof(buffer)) return false;
+		// The characters have been validated above: they are all ASCII
+		for (size_t j=0; j<length; j++) buffer[j] = (char)char_at(end - length + j);
+		first = buffer;
+	}
+	double value;
+	auto result = std::from_chars(first, first+length, value);
+	if ((result.ec == std::errc()) && (result.ptr == first+length)) {
+		set_double(value);
+	}
+	// Out of range values are invalid
+	return true;
 }
 
 //------------------------------------------------------------------------------
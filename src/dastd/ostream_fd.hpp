@@ -0,0 +1,57 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "ostream_basic.hpp"
+#include "sink_fd.hpp"
+
+#ifdef DASTD_UNIX
+
+namespace dastd {
+
+/// @brief Implementation of a `ostream` writing to a POSIX file descriptor
+///
+/// The characters are collected by a `sink_fd` and written with large
+/// `write()` calls. Call `flush()` (or `std::flush`) to force the writing;
+/// in any case, the data is written when the object is destroyed.
+class ostream_fd: public ostream_basic {
+	public:
+		/// @brief Constructor
+		/// @param fd          File descriptor open for writing
+		/// @param owned       If true, the file descriptor will be closed by the destructor
+		/// @param buffer_size Size of the internal buffer
+		ostream_fd(int fd, bool owned=false, size_t buffer_size=FD_IO_DEFAULT_BUFFER_SIZE): m_sink(fd, owned, buffer_size) {}
+
+		/// @brief Constructor
+		/// @param filename    Name of the file to be created (or truncated)
+		/// @param buffer_size Size of the internal buffer
+		/// @throw Throws `exception_fd` if the file can not be opened
+		ostream_fd(const std::string& filename, size_t buffer_size=FD_IO_DEFAULT_BUFFER_SIZE): m_sink(filename, buffer_size) {}
+
+		/// @brief Access the underlying sink
+		sink_fd& sink() {return m_sink;}
+
+	protected:
+		/// @brief Write one character to the target stream
+		virtual void write_char(char_type c) override {m_sink.write_char(c);}
+
+		/// @brief Write multiple characters to the target stream
+		virtual void write_chars(const char_type* s, std::streamsize n) override {m_sink.write(s, (size_t)n);}
+
+		/// @brief Implementation of the "flush" action
+		/// @return Return `false` in case of error, `true` if ok.
+		virtual bool sync() override {
+			try {m_sink.flush();}
+			catch(const exception_fd&) {return false;}
+			return true;
+		}
+
+		/// @brief Target sink
+		sink_fd m_sink;
+};
+
+} // namespace dastd
+
+#endif // DASTD_UNIX
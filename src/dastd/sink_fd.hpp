@@ -0,0 +1,196 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "fd_io.hpp"
+
+#ifdef DASTD_UNIX
+
+namespace dastd {
+
+/// @brief Buffered binary sink writing to a POSIX file descriptor
+///
+/// The data is collected in an internal page-aligned buffer and written
+/// with large `write()` calls, bypassing the std::ostream machinery.
+///
+/// The sink supports repositioning (`set_pos`) as required by
+/// `marshal_enc_bin` to back-patch the size indicators. Moving
+/// within the data still in the buffer is free and works on any
+/// kind of file descriptor; moving before the beginning of the
+/// buffer requires a seekable file descriptor.
+///
+/// The destructor flushes the buffer, ignoring errors: call `flush`
+/// explicitly to be notified of them.
+class sink_fd {
+	private:
+		/// @brief File descriptor
+		int m_fd;
+
+		/// @brief If true, the file descriptor is closed by the destructor
+		bool m_owned;
+
+		/// @brief Internal buffer
+		fd_io_buffer m_buf;
+
+		/// @brief Position in the file of the first byte of the buffer
+		uint64_t m_buf_pos = 0;
+
+		/// @brief Current position in the buffer
+		size_t m_cursor = 0;
+
+		/// @brief Number of bytes of the buffer that have been written
+		///
+		/// It can be greater than `m_cursor` after moving back with `set_pos`.
+		size_t m_used = 0;
+
+		/// @brief Current position of the file descriptor
+		uint64_t m_fd_pos = 0;
+
+		/// @brief Write data positioned at m_buf_pos bypassing the buffer
+		/// @param data   Data to be written
+		/// @param length Number of bytes to be written
+		void write_at_buf_pos(const void* data, size_t length);
+
+	public:
+		/// @brief Constructor
+		/// @param fd          File descriptor open for writing
+		/// @param owned       If true, the file descriptor will be closed by the destructor
+		/// @param buffer_size Size of the internal buffer
+		sink_fd(int fd, bool owned=false, size_t buffer_size=FD_IO_DEFAULT_BUFFER_SIZE);
+
+		/// @brief Constructor
+		/// @param filename    Name of the file to be created (or truncated)
+		/// @param buffer_size Size of the internal buffer
+		/// @throw Throws `exception_fd` if the file can not be opened
+		sink_fd(const std::string& filename, size_t buffer_size=FD_IO_DEFAULT_BUFFER_SIZE):
+			sink_fd(fd_open_write(filename), true, buffer_size) {}
+
+		/// @brief Destructor
+		~sink_fd();
+
+		/// @brief Copy not allowed
+		sink_fd(const sink_fd&) = delete;
+
+		/// @brief Copy not allowed
+		sink_fd& operator=(const sink_fd&) = delete;
+
+		/// @brief Return the associated file descriptor
+		int get_fd() const {return m_fd;}
+
+		/// @brief Write data
+		/// @param data   Data to be written
+		/// @param length Number of bytes to be written
+		/// @throw Throws `exception_fd` in case of I/O error
+		void write(const void* data, size_t length) {
+			if (m_cursor + length <= m_buf.size()) {
+				memcpy(m_buf.data()+m_cursor, data, length);
+				m_cursor += length;
+				if (m_cursor > m_used) m_used = m_cursor;
+			}
+			else write_slow(data, length);
+		}
+
+		/// @brief Write one character
+		/// @param ch Character to be written
+		/// @throw Throws `exception_fd` in case of I/O error
+		void write_char(char ch) {write(&ch, 1);}
+
+		/// @brief Write data not fitting in the buffer
+		/// @param data   Data to be written
+		/// @param length Number of bytes to be written
+		/// @throw Throws `exception_fd` in case of I/O error
+		void write_slow(const void* data, size_t length);
+
+		/// @brief Return the current position
+		uint64_t get_pos() const {return m_buf_pos + m_cursor;}
+
+		/// @brief Move the current position
+		/// @param pos New position; it must not be beyond the data written so far
+		/// @throw Throws `exception_fd` if the file descriptor is not seekable
+		void set_pos(uint64_t pos);
+
+		/// @brief Write the buffered data to the file descriptor
+		/// @throw Throws `exception_fd` in case of I/O error
+		void flush();
+};
+
+//------------------------------------------------------------------------------
+// (brief) Constructor
+// (param) fd          File descriptor open for writing
+// (param) owned       If true, the file descriptor will be closed by the destructor
+// (param) buffer_size Size of the internal buffer
+//------------------------------------------------------------------------------
+inline sink_fd::sink_fd(int fd, bool owned, size_t buffer_size): m_fd(fd), m_owned(owned), m_buf(buffer_size)
+{
+	// Positions are relative to the current one if the descriptor is not seekable
+	off_t pos = ::lseek(m_fd, 0, SEEK_CUR);
+	if (pos > 0) m_buf_pos = m_fd_pos = (uint64_t)pos;
+	fd_advise_sequential(m_fd);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Destructor
+//------------------------------------------------------------------------------
+inline sink_fd::~sink_fd()
+{
+	try {flush();} catch(...) {}
+	if (m_owned) ::close(m_fd);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Write data positioned at m_buf_pos bypassing the buffer
+//------------------------------------------------------------------------------
+inline void sink_fd::write_at_buf_pos(const void* data, size_t length)
+{
+	if (m_fd_pos != m_buf_pos) {
+		if (::lseek(m_fd, (off_t)m_buf_pos, SEEK_SET) < 0) DASTD_THROW(exception_fd, "Unable to move to position " << m_buf_pos << " on file descriptor " << m_fd << "; errno=" << errno);
+	}
+	fd_write_all(m_fd, data, length);
+	m_fd_pos = m_buf_pos + length;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Write the buffered data to the file descriptor
+//
+// After flushing, the buffer starts at the current position.
+//------------------------------------------------------------------------------
+inline void sink_fd::flush()
+{
+	if (m_used > 0) write_at_buf_pos(m_buf.data(), m_used);
+	m_buf_pos += m_cursor;
+	m_cursor = m_used = 0;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Write data not fitting in the buffer
+//------------------------------------------------------------------------------
+inline void sink_fd::write_slow(const void* data, size_t length)
+{
+	flush();
+	if (length >= m_buf.size()) {
+		write_at_buf_pos(data, length);
+		m_buf_pos += length;
+	}
+	else write(data, length);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Move the current position
+// (param) pos New position
+//------------------------------------------------------------------------------
+inline void sink_fd::set_pos(uint64_t pos)
+{
+	// Inside the buffered data: no I/O needed
+	if ((pos >= m_buf_pos) && (pos <= m_buf_pos + m_used)) {
+		m_cursor = (size_t)(pos - m_buf_pos);
+		return;
+	}
+	flush();
+	m_buf_pos = pos;
+}
+
+} // namespace dastd
+
+#endif // DASTD_UNIX
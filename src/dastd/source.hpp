@@ -62,6 +62,30 @@ class source {
 		/// Default implementation calls `tentative_read` in a dummy buffer.
 		/// Other implementations can optimize this.
 		virtual size_t tentative_discard(size_t data_size);
+
+		/// @brief Borrow the characters already available in memory without copying them
+		///
+		/// Sources holding their data in a contiguous memory area (entirely or
+		/// in an internal buffer) can expose it directly, so that consumers can
+		/// scan it with a plain pointer rather than copying it through
+		/// `tentative_read` or reading it one character at a time.
+		/// The data is not extracted: call `tentative_discard` to consume the
+		/// characters actually used.
+		/// The returned pointer is valid until the next non-const call on the source;
+		/// discarding up to `count` characters with `tentative_discard` does not
+		/// invalidate it.
+		///
+		/// Buffered sources might use `max_count` as a hint to fill their buffer,
+		/// but `count` can be lower than `max_count` even if the source is not
+		/// at its end.
+		///
+		/// @param max_count Max amount of characters the caller is interested in
+		/// @param count     Receives the number of characters available at the returned
+		///                  pointer; it is never greater than `max_count`
+		/// @return          Returns the pointer to the characters or `nullptr` (with `count`
+		///                  set to zero) if the source does not support this method
+		/// @throw           It can throw a std::exception or one of its derivatives
+		virtual const CHARTYPE* tentative_window(size_t max_count, size_t& count) {DASTD_NOWARN_UNUSED(max_count); count=0; return nullptr;}
 };
 
 //------------------------------------------------------------------------------
@@ -111,7 +135,7 @@ size_t source<CHARTYPE>::tentative_discard(size_t data_size)
 	CHARTYPE buf[BUFSIZE];
 	size_t totsize = 0;
 	while (totsize < data_size) {
-		size_t reqsize = std::min(data_size, BUFSIZE);
+		size_t reqsize = std::min(data_size - totsize, BUFSIZE);
 		size_t readsize = tentative_read(buf, reqsize);
 		totsize += readsize;
 		if (reqsize > readsize) break;
@@ -134,6 +158,14 @@ size_t source<CHARTYPE>::tentative_discard(size_t data_size)
 template<concept_integral CHARTYPE>
 size_t source<CHARTYPE>::tentative_read(std::basic_string<CHARTYPE>& data, size_t data_size)
 {
+	// Append directly from memory if the source allows it
+	size_t window_size;
+	const CHARTYPE* window = tentative_window(data_size, window_size);
+	if (window_size > 0) {
+		data.append(window, window_size);
+		return tentative_discard(window_size);
+	}
+
 	size_t offset = data.size();
 	data.resize(offset + data_size);
 	// Try to read the number of characters returned by "tentative_count".
@@ -0,0 +1,248 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "source_with_peek.hpp"
+#include "fd_io.hpp"
+
+#ifdef DASTD_UNIX
+
+namespace dastd {
+
+/// @brief Binary data source reading a POSIX file descriptor
+///
+/// The data is read with large `read()` calls into an internal
+/// page-aligned buffer, bypassing the std::istream machinery.
+/// The buffered data can be accessed with no copy through `tentative_window`.
+///
+/// Works with regular files as well as with pipes and sockets; in the
+/// latter case, the calls block until the data is available.
+class source_fd: public source_with_peek<char> {
+	private:
+		/// @brief File descriptor
+		int m_fd;
+
+		/// @brief If true, the file descriptor is closed by the destructor
+		bool m_owned;
+
+		/// @brief Internal buffer
+		fd_io_buffer m_buf;
+
+		/// @brief Offset of the first valid character in the buffer
+		size_t m_begin = 0;
+
+		/// @brief Offset past the last valid character in the buffer
+		size_t m_end = 0;
+
+		/// @brief True when `read()` reported the end of file
+		bool m_eof = false;
+
+		/// @brief Number of characters available in the buffer
+		size_t buffered() const {return m_end - m_begin;}
+
+		/// @brief Read more data from the file descriptor
+		///
+		/// The unread data is moved at the beginning of the buffer and the
+		/// remaining space is filled with a single `read()` call.
+		///
+		/// @return Returns `false` if no more data is available
+		bool fill();
+
+	public:
+		/// @brief Constructor
+		/// @param fd          File descriptor open for reading
+		/// @param owned       If true, the file descriptor will be closed by the destructor
+		/// @param buffer_size Size of the internal buffer
+		source_fd(int fd, bool owned=false, size_t buffer_size=FD_IO_DEFAULT_BUFFER_SIZE);
+
+		/// @brief Constructor
+		/// @param filename    Name of the file to be read
+		/// @param buffer_size Size of the internal buffer
+		/// @throw Throws `exception_fd` if the file can not be opened
+		source_fd(const std::string& filename, size_t buffer_size=FD_IO_DEFAULT_BUFFER_SIZE):
+			source_fd(fd_open_read(filename), true, buffer_size) {}
+
+		/// @brief Destructor
+		virtual ~source_fd() {if (m_owned) ::close(m_fd);}
+
+		/// @brief Copy not allowed
+		source_fd(const source_fd&) = delete;
+
+		/// @brief Copy not allowed
+		source_fd& operator=(const source_fd&) = delete;
+
+		/// @brief Return the associated file descriptor
+		int get_fd() const {return m_fd;}
+
+		/// @brief Fetch one byte
+		/// @param data   Character read from the stream
+		/// @return       Returns `true` if one character has been fetched; returns `false` if no
+		///               more characters are available and `data` is not valid
+		/// @throw        Throws `exception_fd` in case of I/O error
+		virtual bool tentative_read_char(char& data) override {
+			if ((m_begin == m_end) && !fill()) return false;
+			data = m_buf.data()[m_begin++];
+			return true;
+		}
+
+		/// @brief Read data from the source
+		///
+		/// This method reads `data_size` characters, blocking if necessary.
+		/// Less characters are returned only when reaching the end of file.
+		///
+		/// @param data      Pointer to the buffer that will host the data read
+		/// @param data_size Max amount of characters it should try to read
+		/// @return          Returns the number of characters actually read. It can be zero.
+		/// @throw           Throws `exception_fd` in case of I/O error
+		virtual size_t tentative_read(char* data, size_t data_size) override;
+
+		/// @brief Return the number of characters currently available in the buffer
+		virtual size_t tentative_count() const override {return buffered();}
+
+		/// @brief Read data from the source without extracting it
+		///
+		/// This method will attempt to read up to `data_size` characters. The
+		/// amount of characters that can be peeked is limited by the size of
+		/// the internal buffer.
+		/// The data will not be extracted from the buffer so the
+		/// next time the same data will be returned again.
+		/// Call `tentative_discard` to discard the data that has been actually used.
+		///
+		/// @param data      Pointer to the buffer that will host the data read
+		/// @param data_size Max amount of characters it should try to read
+		/// @return          Returns the number of characters actually read. It can be zero.
+		/// @throw           Throws `exception_fd` in case of I/O error
+		virtual size_t tentative_peek(char* data, size_t data_size) override;
+
+		/// @brief Fetch one byte without extracting it
+		/// @param data   Character read from the stream
+		/// @return       Returns `true` if one character has been fetched; returns `false` if no
+		///               more characters are available and `data` is not valid
+		/// @throw        Throws `exception_fd` in case of I/O error
+		virtual bool tentative_peek_char(char& data) override {
+			if ((m_begin == m_end) && !fill()) return false;
+			data = m_buf.data()[m_begin];
+			return true;
+		}
+
+		/// @brief Discard data from the source
+		/// @param data_size Max amount of characters it should try to discard
+		/// @return          Returns the number of characters actually discarded. It can be zero.
+		/// @throw           Throws `exception_fd` in case of I/O error
+		virtual size_t tentative_discard(size_t data_size) override;
+
+		/// @brief Borrow the buffered characters without copying them
+		///
+		/// If less than `max_count` characters are buffered and the buffer is
+		/// running low, it is refilled first.
+		///
+		/// @param max_count Max amount of characters the caller is interested in
+		/// @param count     Receives the number of characters available at the returned pointer
+		/// @return          Returns the pointer to the buffered characters
+		/// @throw           Throws `exception_fd` in case of I/O error
+		virtual const char* tentative_window(size_t max_count, size_t& count) override;
+};
+
+//------------------------------------------------------------------------------
+// (brief) Constructor
+// (param) fd          File descriptor open for reading
+// (param) owned       If true, the file descriptor will be closed by the destructor
+// (param) buffer_size Size of the internal buffer
+//------------------------------------------------------------------------------
+inline source_fd::source_fd(int fd, bool owned, size_t buffer_size): m_fd(fd), m_owned(owned), m_buf(buffer_size)
+{
+	fd_advise_sequential(m_fd);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Read more data from the file descriptor
+// (return) Returns `false` if no more data is available
+//------------------------------------------------------------------------------
+inline bool source_fd::fill()
+{
+	if (m_eof) return false;
+	if (m_begin > 0) {
+		memmove(m_buf.data(), m_buf.data()+m_begin, buffered());
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+	if (m_end == m_buf.size()) return true;
+	size_t bytes_read = fd_read(m_fd, m_buf.data()+m_end, m_buf.size()-m_end);
+	if (bytes_read == 0) {m_eof = true; return (m_end > 0);}
+	m_end += bytes_read;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Read data from the source
+//------------------------------------------------------------------------------
+inline size_t source_fd::tentative_read(char* data, size_t data_size)
+{
+	size_t totsize = 0;
+	while (totsize < data_size) {
+		if (m_begin == m_end) {
+			// Large requests are read directly into the target
+			if ((data_size - totsize >= m_buf.size()) && !m_eof) {
+				size_t bytes_read = fd_read(m_fd, data+totsize, data_size-totsize);
+				if (bytes_read == 0) {m_eof = true; break;}
+				totsize += bytes_read;
+				continue;
+			}
+			if (!fill()) break;
+		}
+		size_t chunk = std::min(data_size - totsize, buffered());
+		memcpy(data+totsize, m_buf.data()+m_begin, chunk);
+		m_begin += chunk;
+		totsize += chunk;
+	}
+	return totsize;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Read data from the source without extracting it
+//------------------------------------------------------------------------------
+inline size_t source_fd::tentative_peek(char* data, size_t data_size)
+{
+	if (data_size > m_buf.size()) data_size = m_buf.size();
+	while (buffered() < data_size) {
+		size_t prev = buffered();
+		if (!fill() || (buffered() == prev)) break;
+	}
+	if (data_size > buffered()) data_size = buffered();
+	memcpy(data, m_buf.data()+m_begin, data_size);
+	return data_size;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Discard data from the source
+//------------------------------------------------------------------------------
+inline size_t source_fd::tentative_discard(size_t data_size)
+{
+	size_t totsize = 0;
+	while (totsize < data_size) {
+		if ((m_begin == m_end) && !fill()) break;
+		size_t chunk = std::min(data_size - totsize, buffered());
+		m_begin += chunk;
+		totsize += chunk;
+	}
+	return totsize;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Borrow the buffered characters without copying them
+//
+// The buffer is refilled only if it is running low (less than a quarter
+// of its size), so the cost of moving the unread data is kept low.
+//------------------------------------------------------------------------------
+inline const char* source_fd::tentative_window(size_t max_count, size_t& count)
+{
+	if ((buffered() < max_count) && (buffered() < m_buf.size()/4)) fill();
+	count = std::min(max_count, buffered());
+	return m_buf.data()+m_begin;
+}
+
+} // namespace dastd
+
+#endif // DASTD_UNIX
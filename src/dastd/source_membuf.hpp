@@ -71,6 +71,20 @@ class source_membuf: public source_with_peek<CHARTYPE> {
 		/// @throw           It can throw a std::exception or one of its derivatives
 		virtual size_t tentative_peek(CHARTYPE* data, size_t data_size) override;
 
+		/// @brief Borrow the characters available in memory without copying them
+		/// @param max_count Max amount of characters the caller is interested in
+		/// @param count     Receives the number of characters available at the returned pointer
+		/// @return          Returns the pointer to the remaining characters
+		virtual const CHARTYPE* tentative_window(size_t max_count, size_t& count) override {count=(max_count < m_remaining ? max_count : m_remaining); return m_buf;}
+
+		/// @brief Non-blocking method to discard data from the source
+		///
+		/// This method will discard up to `data_size` characters by just
+		/// moving the current position.
+		///
+		/// @param data_size Max amount of characters it should try to discard
+		/// @return          Returns the number of characters actually discarded. It can be zero.
+		virtual size_t tentative_discard(size_t data_size) override;
 };
 
 
@@ -132,4 +146,18 @@ size_t source_membuf<CHARTYPE>::tentative_peek(CHARTYPE* data, size_t data_size)
 	return data_size;
 }
 
+//------------------------------------------------------------------------------
+// (brief) Non-blocking method to discard data from the source
+// (param) data_size Max amount of characters it should try to discard
+// (return)          Returns the number of characters actually discarded. It can be zero.
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+size_t source_membuf<CHARTYPE>::tentative_discard(size_t data_size)
+{
+	if (data_size > m_remaining) data_size = m_remaining;
+	m_buf += data_size;
+	m_remaining -= data_size;
+	return data_size;
+}
+
 } // namespace dastd
@@ -0,0 +1,257 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "source_with_peek.hpp"
+#include "exception.hpp"
+
+#ifdef DASTD_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dastd {
+
+/// @brief Exception thrown by `source_mmap`
+DASTD_DEF_EXCEPTION(exception_source_mmap)
+
+/// @brief Binary data source reading a whole file mapped in memory
+///
+/// The file is mapped with `mmap` at construction time and unmapped
+/// by the destructor. The kernel is informed that the access is
+/// sequential and, while the reading proceeds, it is asked to load
+/// in advance the following `READAHEAD_SIZE` bytes.
+///
+/// Since the whole file is in the address space, the data can be
+/// accessed with no copy through `tentative_window`.
+class source_mmap: public source_with_peek<char> {
+	private:
+		/// @brief Beginning of the mapped file (nullptr if the file is empty)
+		const char* m_data = nullptr;
+
+		/// @brief Size of the file
+		size_t m_size = 0;
+
+		/// @brief Current reading offset
+		size_t m_offset = 0;
+
+		/// @brief Offset up to which the data has been requested with MADV_WILLNEED
+		size_t m_willneed_offset = 0;
+
+		/// @brief Move forward the current offset
+		/// @param length Number of characters to skip; it must not exceed the remaining ones
+		void advance(size_t length);
+
+		/// @brief Request the kernel to load the data following the current offset
+		void request_readahead();
+
+	public:
+		/// @brief Amount of bytes requested in advance with MADV_WILLNEED
+		static constexpr size_t READAHEAD_SIZE = 8*1024*1024;
+
+		/// @brief Constructor
+		/// @param filename Name of the file to be mapped
+		/// @throw Throws `exception_source_mmap` if the file can not be opened or mapped
+		source_mmap(const std::string& filename);
+
+		/// @brief Destructor
+		virtual ~source_mmap();
+
+		/// @brief Copy not allowed
+		source_mmap(const source_mmap&) = delete;
+
+		/// @brief Copy not allowed
+		source_mmap& operator=(const source_mmap&) = delete;
+
+		/// @brief Size of the whole file
+		size_t size() const {return m_size;}
+
+		/// @brief Pointer to the whole file content (`nullptr` if the file is empty)
+		const char* data() const {return m_data;}
+
+		/// @brief Fetch one byte
+		/// @param data   Character read from the stream
+		/// @return       Returns `true` if one character has been fetched; returns `false` if no
+		///               more characters are available and `data` is not valid
+		virtual bool tentative_read_char(char& data) override;
+
+		/// @brief Non-blocking method to read data from the source
+		///
+		/// This method will attempt to read up to `data_size` characters.
+		/// If less (or even zero) characters are available, it will read them
+		/// and return.
+		///
+		/// @param data      Pointer to the buffer that will host the data read
+		/// @param data_size Max amount of characters it should try to read
+		/// @return          Returns the number of characters actually read. It can be zero.
+		virtual size_t tentative_read(char* data, size_t data_size) override;
+
+		/// @brief Return the number of characters still to be read
+		virtual size_t tentative_count() const override {return m_size - m_offset;}
+
+		/// @brief Non-blocking method to read data from the source without extracting it
+		///
+		/// This method will attempt to read up to `data_size` characters.
+		/// If less (or even zero) characters are available, it will read them
+		/// and return. The data will not be extracted from the buffer so the
+		/// next time the same data will be returned again.
+		/// Call `tentative_discard` to discard the data that has been actually used.
+		///
+		/// @param data      Pointer to the buffer that will host the data read
+		/// @param data_size Max amount of characters it should try to read
+		/// @return          Returns the number of characters actually read. It can be zero.
+		virtual size_t tentative_peek(char* data, size_t data_size) override;
+
+		/// @brief Fetch one byte without extracting it
+		/// @param data   Character read from the stream
+		/// @return       Returns `true` if one character has been fetched; returns `false` if no
+		///               more characters are available and `data` is not valid
+		virtual bool tentative_peek_char(char& data) override;
+
+		/// @brief Non-blocking method to discard data from the source
+		///
+		/// This method will discard up to `data_size` characters by just
+		/// moving the current position.
+		///
+		/// @param data_size Max amount of characters it should try to discard
+		/// @return          Returns the number of characters actually discarded. It can be zero.
+		virtual size_t tentative_discard(size_t data_size) override;
+
+		/// @brief Borrow the characters available in memory without copying them
+		/// @param max_count Max amount of characters the caller is interested in
+		/// @param count     Receives the number of characters available at the returned pointer
+		/// @return          Returns the pointer to the remaining characters
+		virtual const char* tentative_window(size_t max_count, size_t& count) override {count=std::min(max_count, tentative_count()); return m_data+m_offset;}
+};
+
+//------------------------------------------------------------------------------
+// (brief) Constructor
+// (param) filename Name of the file to be mapped
+//------------------------------------------------------------------------------
+inline source_mmap::source_mmap(const std::string& filename)
+{
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) DASTD_THROW(exception_source_mmap, "Unable to open file '" << filename << "'; errno=" << errno);
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		int err = errno;
+		::close(fd);
+		DASTD_THROW(exception_source_mmap, "Unable to get the size of file '" << filename << "'; errno=" << err);
+	}
+	m_size = (size_t)st.st_size;
+
+	// Mapping an empty file is not allowed
+	if (m_size > 0) {
+		void* ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr == MAP_FAILED) {
+			int err = errno;
+			::close(fd);
+			DASTD_THROW(exception_source_mmap, "Unable to map file '" << filename << "' of " << m_size << " bytes; errno=" << err);
+		}
+		m_data = (const char*)ptr;
+		::madvise(ptr, m_size, MADV_SEQUENTIAL);
+	}
+
+	// The mapping stays valid after closing the descriptor
+	::close(fd);
+	request_readahead();
+}
+
+//------------------------------------------------------------------------------
+// (brief) Destructor
+//------------------------------------------------------------------------------
+inline source_mmap::~source_mmap()
+{
+	if (m_data != nullptr) ::munmap((void*)m_data, m_size);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Request the kernel to load the data following the current offset
+//
+// The request is issued when the current offset gets past the half of
+// the area previously requested, so that the kernel can load the next
+// block while the current one is being processed.
+//------------------------------------------------------------------------------
+inline void source_mmap::request_readahead()
+{
+	if (m_willneed_offset >= m_size) return;
+	if (m_offset + READAHEAD_SIZE/2 < m_willneed_offset) return;
+
+	// madvise requires page-aligned addresses
+	static const size_t page_size = (size_t)::sysconf(_SC_PAGESIZE);
+	size_t begin = m_willneed_offset & ~(page_size-1);
+	size_t end = std::min(m_offset + READAHEAD_SIZE, m_size);
+	if (end > begin) ::madvise((void*)(m_data+begin), end-begin, MADV_WILLNEED);
+	m_willneed_offset = end;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Move forward the current offset
+//------------------------------------------------------------------------------
+inline void source_mmap::advance(size_t length)
+{
+	m_offset += length;
+	request_readahead();
+}
+
+//------------------------------------------------------------------------------
+// (brief) Fetch one byte
+//------------------------------------------------------------------------------
+inline bool source_mmap::tentative_read_char(char& data)
+{
+	if (m_offset >= m_size) return false;
+	data = m_data[m_offset];
+	advance(1);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Non-blocking method to read data from the source
+//------------------------------------------------------------------------------
+inline size_t source_mmap::tentative_read(char* data, size_t data_size)
+{
+	size_t ret = tentative_peek(data, data_size);
+	advance(ret);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Non-blocking method to read data from the source without extracting it
+//------------------------------------------------------------------------------
+inline size_t source_mmap::tentative_peek(char* data, size_t data_size)
+{
+	size_t remaining = tentative_count();
+	if (data_size > remaining) data_size = remaining;
+	if (data_size > 0) memcpy(data, m_data+m_offset, data_size);
+	return data_size;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Fetch one byte without extracting it
+//------------------------------------------------------------------------------
+inline bool source_mmap::tentative_peek_char(char& data)
+{
+	if (m_offset >= m_size) return false;
+	data = m_data[m_offset];
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Non-blocking method to discard data from the source
+//------------------------------------------------------------------------------
+inline size_t source_mmap::tentative_discard(size_t data_size)
+{
+	size_t remaining = tentative_count();
+	if (data_size > remaining) data_size = remaining;
+	advance(data_size);
+	return data_size;
+}
+
+} // namespace dastd
+
+#endif // DASTD_UNIX
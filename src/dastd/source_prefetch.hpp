@@ -0,0 +1,329 @@
+/**
+* @author Davide Achilli
+* @copyright Apache 2.0 License
+* @date 15-OCT-2026
+**/
+#pragma once
+#include "source_with_peek.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dastd {
+
+/// @brief Source adapter reading another source in a background thread
+///
+/// Two buffers are used: while the consumer is reading one of them, a
+/// background thread fills the other one calling `tentative_read` on the
+/// input source. This way, the I/O latency of the input source overlaps
+/// with the processing done by the consumer.
+///
+/// The input source is accessed only by the background thread; a zero-length
+/// `tentative_read` is considered the end of the data. Exceptions thrown by the
+/// input source are re-thrown to the consumer when it reaches that point.
+///
+/// The buffered data can be accessed with no copy through `tentative_window`;
+/// note that the peek functions can not see past the end of the current buffer.
+///
+/// The destructor waits for the background thread to terminate, so it can
+/// block until the ongoing `tentative_read` on the input source returns.
+template<concept_integral CHARTYPE>
+class source_prefetch: public source_with_peek<CHARTYPE> {
+	private:
+		/// @brief Input source
+		source<CHARTYPE>& m_input;
+
+		/// @brief The two buffers
+		std::vector<CHARTYPE> m_buffers[2];
+
+		//--------------------------------------------------------
+		// CONSUMER SIDE
+		//--------------------------------------------------------
+		/// @brief Index of the buffer being read by the consumer
+		size_t m_curr = 0;
+
+		/// @brief Offset of the first valid character in the current buffer
+		size_t m_begin = 0;
+
+		/// @brief Offset past the last valid character in the current buffer
+		size_t m_end = 0;
+
+		/// @brief True when the consumer received the last buffer
+		bool m_eof = false;
+
+		/// @brief Number of times the consumer had to wait for the background thread
+		uint64_t m_stalls = 0;
+
+		//--------------------------------------------------------
+		// SHARED (protected by m_mutex)
+		//--------------------------------------------------------
+		/// @brief Mutex protecting the shared section
+		std::mutex m_mutex;
+
+		/// @brief Condition signaled on each change of the shared section
+		std::condition_variable m_cv;
+
+		/// @brief True if the other buffer has been filled and is ready for the consumer
+		bool m_filled = false;
+
+		/// @brief Number of characters in the filled buffer
+		size_t m_filled_size = 0;
+
+		/// @brief True if the input source reached its end
+		bool m_filled_eof = false;
+
+		/// @brief Exception thrown by the input source
+		std::exception_ptr m_error;
+
+		/// @brief Request to terminate the background thread
+		bool m_stop = false;
+
+		/// @brief Number of characters read from the input source
+		std::atomic<uint64_t> m_prefetched_count{0};
+
+		/// @brief Background thread
+		std::thread m_thread;
+
+		/// @brief Background thread body
+		void prefetch_loop();
+
+		/// @brief Switch to the buffer filled by the background thread
+		/// @return Returns `false` if there is no more data
+		bool next_buffer();
+
+		/// @brief Number of characters available in the current buffer
+		size_t buffered() const {return m_end - m_begin;}
+
+	public:
+		/// @brief Default size of each of the two buffers
+		static constexpr size_t DEFAULT_BUFFER_SIZE = 1024*1024;
+
+		/// @brief Constructor
+		///
+		/// The background thread is started immediately.
+		///
+		/// @param input       Source to be read in background
+		/// @param buffer_size Size (in characters) of each of the two buffers
+		source_prefetch(source<CHARTYPE>& input, size_t buffer_size=DEFAULT_BUFFER_SIZE);
+
+		/// @brief Destructor
+		virtual ~source_prefetch();
+
+		/// @brief Copy not allowed
+		source_prefetch(const source_prefetch&) = delete;
+
+		/// @brief Copy not allowed
+		source_prefetch& operator=(const source_prefetch&) = delete;
+
+		/// @brief Number of times the consumer had to wait for the background thread
+		uint64_t get_stalls() const {return m_stalls;}
+
+		/// @brief Number of characters read so far from the input source
+		uint64_t get_prefetched_count() const {return m_prefetched_count;}
+
+		/// @brief Fetch one byte
+		/// @param data   Character read from the stream
+		/// @return       Returns `true` if one character has been fetched; returns `false` if no
+		///               more characters are available and `data` is not valid
+		/// @throw        It re-throws the exceptions of the input source
+		virtual bool tentative_read_char(CHARTYPE& data) override {
+			if ((m_begin == m_end) && !next_buffer()) return false;
+			data = m_buffers[m_curr][m_begin++];
+			return true;
+		}
+
+		/// @brief Read data from the source
+		///
+		/// This method reads `data_size` characters, waiting for the background
+		/// thread if necessary. Less characters are returned only when reaching
+		/// the end of the data.
+		///
+		/// @param data      Pointer to the buffer that will host the data read
+		/// @param data_size Max amount of characters it should try to read
+		/// @return          Returns the number of characters actually read. It can be zero.
+		/// @throw           It re-throws the exceptions of the input source
+		virtual size_t tentative_read(CHARTYPE* data, size_t data_size) override;
+
+		/// @brief Return the number of characters available in the current buffer
+		virtual size_t tentative_count() const override {return buffered();}
+
+		/// @brief Read data from the source without extracting it
+		///
+		/// This method will attempt to read up to `data_size` characters, but
+		/// it can not see past the end of the current buffer.
+		/// Call `tentative_discard` to discard the data that has been actually used.
+		///
+		/// @param data      Pointer to the buffer that will host the data read
+		/// @param data_size Max amount of characters it should try to read
+		/// @return          Returns the number of characters actually read. It can be zero.
+		/// @throw           It re-throws the exceptions of the input source
+		virtual size_t tentative_peek(CHARTYPE* data, size_t data_size) override;
+
+		/// @brief Fetch one byte without extracting it
+		/// @param data   Character read from the stream
+		/// @return       Returns `true` if one character has been fetched; returns `false` if no
+		///               more characters are available and `data` is not valid
+		/// @throw        It re-throws the exceptions of the input source
+		virtual bool tentative_peek_char(CHARTYPE& data) override {
+			if ((m_begin == m_end) && !next_buffer()) return false;
+			data = m_buffers[m_curr][m_begin];
+			return true;
+		}
+
+		/// @brief Discard data from the source
+		/// @param data_size Max amount of characters it should try to discard
+		/// @return          Returns the number of characters actually discarded. It can be zero.
+		/// @throw           It re-throws the exceptions of the input source
+		virtual size_t tentative_discard(size_t data_size) override;
+
+		/// @brief Borrow the characters of the current buffer without copying them
+		/// @param max_count Max amount of characters the caller is interested in
+		/// @param count     Receives the number of characters available at the returned pointer
+		/// @return          Returns the pointer to the buffered characters
+		/// @throw           It re-throws the exceptions of the input source
+		virtual const CHARTYPE* tentative_window(size_t max_count, size_t& count) override {
+			if (m_begin == m_end) next_buffer();
+			count = std::min(max_count, buffered());
+			return m_buffers[m_curr].data()+m_begin;
+		}
+};
+
+//------------------------------------------------------------------------------
+// (brief) Constructor
+// (param) input       Source to be read in background
+// (param) buffer_size Size (in characters) of each of the two buffers
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+source_prefetch<CHARTYPE>::source_prefetch(source<CHARTYPE>& input, size_t buffer_size): m_input(input)
+{
+	if (buffer_size == 0) buffer_size = 1;
+	m_buffers[0].resize(buffer_size);
+	m_buffers[1].resize(buffer_size);
+	m_thread = std::thread(&source_prefetch<CHARTYPE>::prefetch_loop, this);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Destructor
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+source_prefetch<CHARTYPE>::~source_prefetch()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+}
+
+//------------------------------------------------------------------------------
+// (brief) Background thread body
+//
+// The thread fills the buffer not used by the consumer, then waits for
+// the consumer to take it and release the other one.
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+void source_prefetch<CHARTYPE>::prefetch_loop()
+{
+	// The consumer starts with buffer 0 (empty)
+	size_t fill_idx = 1;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for(;;) {
+		m_cv.wait(lock, [this]{return m_stop || !m_filled;});
+		if (m_stop) return;
+		lock.unlock();
+
+		std::vector<CHARTYPE>& buffer = m_buffers[fill_idx];
+		size_t size = 0;
+		std::exception_ptr error;
+		try {size = m_input.tentative_read(buffer.data(), buffer.size());}
+		catch(...) {error = std::current_exception();}
+		m_prefetched_count += size;
+
+		lock.lock();
+		m_filled = true;
+		m_filled_size = size;
+		m_filled_eof = ((size == 0) || error);
+		m_error = error;
+		m_cv.notify_all();
+		if (m_filled_eof) return;
+		fill_idx = 1 - fill_idx;
+	}
+}
+
+//------------------------------------------------------------------------------
+// (brief) Switch to the buffer filled by the background thread
+// (return) Returns `false` if there is no more data
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+bool source_prefetch<CHARTYPE>::next_buffer()
+{
+	if (m_eof) return false;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (!m_filled) {
+		m_stalls++;
+		m_cv.wait(lock, [this]{return m_filled;});
+	}
+	m_curr = 1 - m_curr;
+	m_begin = 0;
+	m_end = m_filled_size;
+	m_eof = m_filled_eof;
+	m_filled = false;
+	std::exception_ptr error = m_error;
+	m_error = nullptr;
+	lock.unlock();
+	m_cv.notify_all();
+
+	if (error) std::rethrow_exception(error);
+	return (m_end > 0);
+}
+
+//------------------------------------------------------------------------------
+// (brief) Read data from the source
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+size_t source_prefetch<CHARTYPE>::tentative_read(CHARTYPE* data, size_t data_size)
+{
+	size_t totsize = 0;
+	while (totsize < data_size) {
+		if ((m_begin == m_end) && !next_buffer()) break;
+		size_t chunk = std::min(data_size - totsize, buffered());
+		memcpy(data+totsize, m_buffers[m_curr].data()+m_begin, chunk*sizeof(CHARTYPE));
+		m_begin += chunk;
+		totsize += chunk;
+	}
+	return totsize;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Read data from the source without extracting it
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+size_t source_prefetch<CHARTYPE>::tentative_peek(CHARTYPE* data, size_t data_size)
+{
+	if ((m_begin == m_end) && !next_buffer()) return 0;
+	if (data_size > buffered()) data_size = buffered();
+	memcpy(data, m_buffers[m_curr].data()+m_begin, data_size*sizeof(CHARTYPE));
+	return data_size;
+}
+
+//------------------------------------------------------------------------------
+// (brief) Discard data from the source
+//------------------------------------------------------------------------------
+template<concept_integral CHARTYPE>
+size_t source_prefetch<CHARTYPE>::tentative_discard(size_t data_size)
+{
+	size_t totsize = 0;
+	while (totsize < data_size) {
+		if ((m_begin == m_end) && !next_buffer()) break;
+		size_t chunk = std::min(data_size - totsize, buffered());
+		m_begin += chunk;
+		totsize += chunk;
+	}
+	return totsize;
+}
+
+} // namespace dastd
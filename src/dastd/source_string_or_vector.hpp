@@ -69,6 +69,21 @@ class source_string_or_vector: public source_with_peek<CHARTYPE> {
 		///               more characters are available and `data` is not valid
 		/// @throw        It can throw a std::exception or one of its derivatives
 		virtual bool tentative_peek_char(CHARTYPE& data) {return (tentative_peek(&data, 1) == 1);}
+
+		/// @brief Borrow the characters available in memory without copying them
+		/// @param max_count Max amount of characters the caller is interested in
+		/// @param count     Receives the number of characters available at the returned pointer
+		/// @return          Returns the pointer to the remaining characters
+		virtual const CHARTYPE* tentative_window(size_t max_count, size_t& count) override {count=std::min(max_count, tentative_count()); return m_string.data()+m_offset;}
+
+		/// @brief Non-blocking method to discard data from the source
+		///
+		/// This method will discard up to `data_size` characters by just
+		/// moving the current position.
+		///
+		/// @param data_size Max amount of characters it should try to discard
+		/// @return          Returns the number of characters actually discarded. It can be zero.
+		virtual size_t tentative_discard(size_t data_size) override;
 };
 
 
@@ -116,4 +131,18 @@ size_t source_string_or_vector<CHARTYPE>::tentative_peek(CHARTYPE* data, size_t
 	return data_size;
 }
 
+//------------------------------------------------------------------------------
+// (brief) Non-blocking method to discard data from the source
+// (param) data_size Max amount of characters it should try to discard
+// (return)          Returns the number of characters actually discarded. It can be zero.
+//------------------------------------------------------------------------------
+template<class CHARTYPE>
+size_t source_string_or_vector<CHARTYPE>::tentative_discard(size_t data_size)
+{
+	size_t remaining = tentative_count();
+	if (data_size > remaining) data_size = remaining;
+	m_offset += data_size;
+	return data_size;
+}
+
 } // namespace dastd
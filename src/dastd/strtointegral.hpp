@@ -5,6 +5,8 @@
 **/
 #pragma once
 #include "defs.hpp"
+#include <bit>
+#include <cstring>
 #include <limits>
 #include <cctype>
 #include <vector>
@@ -160,6 +162,24 @@ class strtointegral_t: public strtointegral_constants {
 		///
 		/// @return Returns 'true' if ok, 'false' in case of error
 		bool add_char(CHARTYPE ch, conversion_state& state);
+
+		/// @brief True if `convert_decimal_blocks` can be used
+		static constexpr bool use_decimal_blocks = std::is_same_v<CHARTYPE,char> && (sizeof(NUMTYPE) >= 4) && (std::endian::native == std::endian::little);
+
+		/// @brief Parse blocks of 8 decimal digits at a time
+		///
+		/// Invoked in the state accepting digits with base 10, it loads 8 characters at a
+		/// time and converts them with SWAR (SIMD within a register) operations.
+		/// It stops at the first block not made only of digits or that would make the
+		/// value go out of range, leaving the remaining characters to `convert_step`.
+		///
+		/// @param str Input string
+		/// @param str_len Number of characters of str
+		/// @param i Offset of the first character to be analyzed
+		/// @param state Conversion state object
+		///
+		/// @return Returns the offset of the first character not processed
+		size_t convert_decimal_blocks(const char* str, size_t str_len, size_t i, const conversion_state& state);
 };
 
 
@@ -188,25 +208,53 @@ bool strtointegral_t<NUMTYPE,CHARTYPE>::add_char(CHARTYPE ch, conversion_state&
 	// Numerice value not expected in this base
 	if (number >= (NUMTYPE)m_base) {m_result=INVALID_CHAR; return false;}
 
-	NUMTYPE tmp_data;
-	if constexpr (std::is_signed<NUMTYPE>::value) {
-		tmp_data = m_data * m_base + (state.m_negative ? -number : number);
+	// Make sure it does not go out of the NUMTYPE range: m_data*base+number must
+	// not exceed the maximum (or m_data*base-number the minimum for negative numbers)
+	NUMTYPE base = (NUMTYPE)m_base;
+	if (state.m_negative) {
+		if constexpr (std::is_signed<NUMTYPE>::value) {
+			if (m_data < (NUMTYPE)((std::numeric_limits<NUMTYPE>::lowest() + number) / base)) {m_result=VALUE_OUT_OF_RANGE; return false;}
+			m_data = (NUMTYPE)(m_data * base - number);
+		}
 	}
 	else {
-		assert(!state.m_negative);
-		tmp_data = (NUMTYPE)(m_data * m_base + number);
+		if (m_data > (NUMTYPE)((std::numeric_limits<NUMTYPE>::max() - number) / base)) {m_result=VALUE_OUT_OF_RANGE; return false;}
+		m_data = (NUMTYPE)(m_data * base + number);
 	}
+	return true;
+}
 
-	// Now, make sure it did not go out of the int64_t range
-	if (state.m_negative) {
-		if (tmp_data > m_data) {m_result=VALUE_OUT_OF_RANGE; return false;}
-	} else {
-		if (tmp_data < m_data) {m_result=VALUE_OUT_OF_RANGE; return false;}
+/// Parse blocks of 8 decimal digits at a time
+template<class NUMTYPE, class CHARTYPE>
+size_t strtointegral_t<NUMTYPE,CHARTYPE>::convert_decimal_blocks(const char* str, size_t str_len, size_t i, const conversion_state& state)
+{
+	constexpr NUMTYPE block_scale = 100000000;
+	for (; i+8<=str_len; i+=8) {
+		uint64_t v;
+		memcpy(&v, str+i, 8);
+
+		// Every byte must be '0'...'9': high nibble 3 and low nibble not above 9
+		if (((v & UINT64_C(0xF0F0F0F0F0F0F0F0)) | (((v + UINT64_C(0x0606060606060606)) & UINT64_C(0xF0F0F0F0F0F0F0F0)) >> 4)) != UINT64_C(0x3333333333333333)) break;
+
+		// Combine the digits in pairs, then in groups of four and finally eight
+		v = ((v & UINT64_C(0x0F0F0F0F0F0F0F0F)) * 2561) >> 8;
+		v = ((v & UINT64_C(0x00FF00FF00FF00FF)) * 6553601) >> 16;
+		NUMTYPE block = (NUMTYPE)(((v & UINT64_C(0x0000FFFF0000FFFF)) * UINT64_C(42949672960001)) >> 32);
+
+		// A single range check for the whole block
+		if (state.m_negative) {
+			if constexpr (std::is_signed<NUMTYPE>::value) {
+				if (m_data < (std::numeric_limits<NUMTYPE>::lowest() + block) / block_scale) break;
+				m_data = m_data * block_scale - block;
+			}
+		}
+		else {
+			if (m_data > (std::numeric_limits<NUMTYPE>::max() - block) / block_scale) break;
+			m_data = m_data * block_scale + block;
+		}
+		m_valid_length += 8;
 	}
-
-	// Everything is ok, go ahead
-	m_data = tmp_data;
-	return true;
+	return i;
 }
 
 /// Execute the one conversion step
@@ -363,6 +411,12 @@ void strtointegral_t<NUMTYPE,CHARTYPE>::convert(const CHARTYPE* str, size_t str_
 	m_base = base;
 	size_t i;
 	for (i=0; i<str_len; i++) {
+		if constexpr (use_decimal_blocks) {
+			if ((state.m_state == 6) && (m_base == 10)) {
+				i = convert_decimal_blocks(str, str_len, i, state);
+				if (i == str_len) break;
+			}
+		}
 		if (!convert_step(str[i], min_value, max_value, state)) return;
 	}
 	convert_step(end_of_string, min_value, max_value, state);
@@ -373,15 +427,7 @@ void strtointegral_t<NUMTYPE,CHARTYPE>::convert(const CHARTYPE* str, size_t str_
 template<class NUMTYPE, class CHARTYPE>
 void strtointegral_t<NUMTYPE,CHARTYPE>::convert(const std::basic_string<CHARTYPE>& str, unsigned base, NUMTYPE min_value, NUMTYPE max_value)
 {
-	clear();
-	conversion_state state;
-
-	m_base = base;
-	for (auto ch: str) {
-		if (!convert_step(ch, min_value, max_value, state)) return;
-	}
-	convert_step(end_of_string, min_value, max_value, state);
-	return;
+	convert(str.data(), str.size(), base, min_value, max_value);
 }
 
 /// @brief Execute the conversion from a constant string
@@ -585,41 +585,48 @@ inline void decomposed_time::print(std::ostream& out, uint32_t time_print_opt) c
 	bool use_underscores = DASTD_ISSET(time_print_opt, TIME_UNDERSCORE);
 	#define SEP(p) (use_underscores ? '_' : p)
 
+	// Date and time are formatted in a buffer and written at once;
+	// room for 7 numbers and 8 separators
+	char buf[8*(std::numeric_limits<uint32_t>::digits10+2)];
+	char* p = buf;
 	switch(time_print_opt & TIME_FMT_MASK) {
 		case TIME_FMT_ISO8601: {
-			out << fmt(m_year, 10, 4) << SEP('-') << fmt(m_month, 10, 2) << SEP('-') << fmt(m_day, 10, 2)
-				<< SEP('T')
-				<< fmt(m_hours, 10, 2) << SEP(':') << fmt(m_mins, 10, 2) << SEP(':') << fmt(m_secs, 10, 2)
-			;
+			p += fmt(m_year, 10, 4).write(p); *p++ = SEP('-'); p += fmt(m_month, 10, 2).write(p); *p++ = SEP('-'); p += fmt(m_day, 10, 2).write(p);
+			*p++ = SEP('T');
+			p += fmt(m_hours, 10, 2).write(p); *p++ = SEP(':'); p += fmt(m_mins, 10, 2).write(p); *p++ = SEP(':'); p += fmt(m_secs, 10, 2).write(p);
 			break;
 		}
 		case TIME_FMT_PACKED: {
-			out << fmt(m_year, 10, 4) << fmt(m_month, 10, 2) << fmt(m_day, 10, 2)
-				<< SEP(' ')
-				<< fmt(m_hours, 10, 2) << fmt(m_mins, 10, 2) << fmt(m_secs, 10, 2)
-			;
+			p += fmt(m_year, 10, 4).write(p); p += fmt(m_month, 10, 2).write(p); p += fmt(m_day, 10, 2).write(p);
+			*p++ = SEP(' ');
+			p += fmt(m_hours, 10, 2).write(p); p += fmt(m_mins, 10, 2).write(p); p += fmt(m_secs, 10, 2).write(p);
 			break;
 		}
 		default: {
-			out << fmt(m_year, 10, 4) << SEP('-') << fmt(m_month, 10, 2) << SEP('-') << fmt(m_day, 10, 2)
-				<< SEP(' ')
-				<< fmt(m_hours, 10, 2) << SEP(':') << fmt(m_mins, 10, 2) << SEP(':') << fmt(m_secs, 10, 2)
-			;
+			p += fmt(m_year, 10, 4).write(p); *p++ = SEP('-'); p += fmt(m_month, 10, 2).write(p); *p++ = SEP('-'); p += fmt(m_day, 10, 2).write(p);
+			*p++ = SEP(' ');
+			p += fmt(m_hours, 10, 2).write(p); *p++ = SEP(':'); p += fmt(m_mins, 10, 2).write(p); *p++ = SEP(':'); p += fmt(m_secs, 10, 2).write(p);
 			break;
 		}
 	}
 
-	if (DASTD_ISSET(time_print_opt, TIME_MICROS)) out << SEP('.') << fmt(m_microsecs, 10, 6);
-	else if (DASTD_ISSET(time_print_opt, TIME_MILLIS)) out << SEP('.') << fmt(m_microsecs/1000, 10, 3);
+	if (DASTD_ISSET(time_print_opt, TIME_MICROS)) {*p++ = SEP('.'); p += fmt(m_microsecs, 10, 6).write(p);}
+	else if (DASTD_ISSET(time_print_opt, TIME_MILLIS)) {*p++ = SEP('.'); p += fmt(m_microsecs/1000, 10, 3).write(p);}
 
 	if (DASTD_ISSET(time_print_opt, TIME_TZ)) {
-		if ((time_print_opt & TIME_FMT_MASK) != TIME_FMT_ISO8601) out << SEP(' ');
+		if ((time_print_opt & TIME_FMT_MASK) != TIME_FMT_ISO8601) *p++ = SEP(' ');
+		out.write(buf, p - buf);
+		p = buf;
 		m_tz.print(out, time_print_opt);
 	}
 
 	if (DASTD_ISSET(time_print_opt, TIME_WEEKDAY)) {
-		out << SEP(' ') << time_week_days[m_day_of_week];
+		*p++ = SEP(' ');
+		out.write(buf, p - buf);
+		p = buf;
+		out << time_week_days[m_day_of_week];
 	}
+	out.write(buf, p - buf);
 	#undef SEP
 }
 
@@ -631,10 +638,16 @@ inline void decomposed_time::print(std::ostream& out, uint32_t time_print_opt) c
 //------------------------------------------------------------------------------
 inline void decomposed_time::write_clean_timestamp(std::ostream& out, bool include_microsec) const
 {
-	out << fmt(m_year, 10, 4) << fmt(m_month, 10, 2) << fmt(m_day, 10, 2) << '_' << fmt(m_hours, 10, 2) << fmt(m_mins, 10, 2) << fmt(m_secs, 10, 2);
+	char buf[8*(std::numeric_limits<uint32_t>::digits10+2)];
+	char* p = buf;
+	p += fmt(m_year, 10, 4).write(p); p += fmt(m_month, 10, 2).write(p); p += fmt(m_day, 10, 2).write(p);
+	*p++ = '_';
+	p += fmt(m_hours, 10, 2).write(p); p += fmt(m_mins, 10, 2).write(p); p += fmt(m_secs, 10, 2).write(p);
 	if (include_microsec) {
-		out << "_" << fmt(m_microsecs, 10, 6);
+		*p++ = '_';
+		p += fmt(m_microsecs, 10, 6).write(p);
 	}
+	out.write(buf, p - buf);
 }
 
 //------------------------------------------------------------------------------
@@ -173,6 +173,40 @@ inline size_t read_utf8_asciiz(const void* p_chars, char32_t& code_point)
 	#endif
 }
 
+/// @brief Convert a UTF-8 sequence into a UNICODE-32, rejecting any invalid form
+///
+/// Unlike `read_utf8_asciiz`, it never reads beyond `length` and it rejects
+/// stray continuation bytes, leads of 5 or more bytes, overlong forms,
+/// surrogates and values above 0x10FFFF. The NUL character is valid.
+///
+/// @param chars Input sequence
+/// @param length Number of bytes available in `chars`; it must be at least 1
+/// @param code_point Receives the code point or `CHAR32_INVALID` in case of errors
+///
+/// @return Returns the number of bytes read or zero if the sequence is not valid UTF-8.
+inline size_t read_utf8_strict(const char* chars, size_t length, char32_t& code_point)
+{
+	const uint8_t* p = (const uint8_t*)chars;
+	uint8_t lead = p[0];
+	size_t count;
+	char32_t min_value;
+	if (lead < 0x80) {code_point = lead; return 1;}
+	if ((lead & 0xE0) == 0xC0) {count = 2; min_value = 0x80; code_point = lead & 0x1F;}
+	else if ((lead & 0xF0) == 0xE0) {count = 3; min_value = 0x800; code_point = lead & 0x0F;}
+	else if ((lead & 0xF8) == 0xF0) {count = 4; min_value = 0x10000; code_point = lead & 0x07;}
+	else {code_point = CHAR32_INVALID; return 0;}
+	if (count > length) {code_point = CHAR32_INVALID; return 0;}
+	for (size_t i=1; i<count; i++) {
+		if ((p[i] & 0xC0) != 0x80) {code_point = CHAR32_INVALID; return 0;}
+		code_point = (code_point << 6) | (p[i] & 0x3F);
+	}
+	if ((code_point < min_value) || (code_point > 0x10FFFF) || ((code_point >= 0xD800) && (code_point <= 0xDFFF))) {
+		code_point = CHAR32_INVALID;
+		return 0;
+	}
+	return count;
+}
+
 /// @brief Write a codepoint into a UTF-8 string.
 ///
 /// @param utf8 The target string must be allocated of UTF8_CHAR_MAX_LEN bytes.